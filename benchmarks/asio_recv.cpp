@@ -0,0 +1,125 @@
+// Copyright (c) 2024-2025 Lars-Christian Schulz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "bench.hpp"
+
+#include "scion/asio/udp_socket.hpp"
+#include "scion/bsd/udp_socket.hpp"
+
+#include <boost/asio.hpp>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <format>
+#include <iostream>
+#include <new>
+#include <vector>
+
+
+// Count heap allocations in the whole program. Only done in this benchmark,
+// as it affects everything linked into the executable.
+static std::atomic<std::size_t> allocCount = 0;
+
+void* operator new(std::size_t size)
+{
+    allocCount.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+using namespace scion;
+using Socket = scion::asio::UDPSocket;
+using Sender = scion::bsd::UDPSocket<scion::bsd::BSDSocket<scion::bsd::IPEndpoint>>;
+
+// Receive packets in a coroutine loop with use_awaitable. Packets are sent in
+// bursts small enough to fit into the socket receive buffer.
+int main(int argc, char* argv[])
+{
+    using namespace boost::asio;
+    constexpr std::size_t WARMUP = 64, PACKETS = 100'000, BURST = 64;
+
+    auto ep = Socket::Endpoint::Parse("[1-ff00:0:1,::1]:0").value();
+    io_context ioCtx(1);
+    Sender sender;
+    Socket socket(ioCtx);
+    if (sender.bind(ep) || socket.bind(ep)) {
+        std::cerr << "cannot bind sockets\n";
+        return 1;
+    }
+
+    HeaderCache headers;
+    std::array<std::byte, 64> payload = {};
+    auto nh = toUnderlay<Sender::UnderlayEp>(socket.getLocalEp().getLocalEp()).value();
+    auto send = [&] (std::size_t n) {
+        for (std::size_t i = 0; i < n; ++i)
+            (void)sender.sendTo(headers, socket.getLocalEp(), RawPath(), nh, payload);
+    };
+
+    std::size_t received = 0, allocs = 0;
+    std::chrono::duration<double, std::nano> elapsed{};
+    std::vector<std::byte> buffer(1024);
+    auto loop = [&] () -> awaitable<void>
+    {
+        Socket::UnderlayEp ulSource;
+        send(WARMUP);
+        for (std::size_t i = 0; i < WARMUP; ++i) {
+            auto recvd = co_await socket.recvAsync(buffer, ulSource, use_awaitable);
+            if (isError(recvd)) co_return;
+        }
+        while (received < PACKETS) {
+            send(BURST);
+            auto before = allocCount.load(std::memory_order_relaxed);
+            auto t0 = std::chrono::steady_clock::now();
+            for (std::size_t i = 0; i < BURST; ++i) {
+                auto recvd = co_await socket.recvAsync(buffer, ulSource, use_awaitable);
+                if (isError(recvd)) co_return;
+                doNotOptimize(get(recvd));
+            }
+            elapsed += std::chrono::steady_clock::now() - t0;
+            allocs += allocCount.load(std::memory_order_relaxed) - before;
+            received += BURST;
+        }
+    };
+    co_spawn(ioCtx, loop(), detached);
+    ioCtx.run();
+
+    if (received < PACKETS) {
+        std::cerr << "receive failed\n";
+        return 1;
+    }
+    report("recvAsync/use_awaitable", elapsed.count() / (double)received);
+    std::cout << std::format("{:<40} {:>10.4f}\n", "allocations per packet",
+        (double)allocs / (double)received);
+    return allocs == 0 ? 0 : 1;
+}
@@ -0,0 +1,126 @@
+// Copyright (c) 2024-2025 Lars-Christian Schulz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "bench.hpp"
+
+#include "scion/bit_stream.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <format>
+#include <string_view>
+
+
+using namespace scion;
+
+// Number of fields serialized per measured call.
+static constexpr std::size_t FIELDS = 64;
+
+static std::array<std::byte, 8 * FIELDS + 16> buffer = {};
+
+// Measure reading and writing FIELDS consecutive fields starting at bit
+// offset `offset`. `field` is called with a stream and the field index.
+template <typename Field>
+static void benchField(std::string_view name, std::size_t offset, Field&& field)
+{
+    auto ns = measure([&] {
+        WriteStream ws(buffer);
+        (void)ws.advanceBits(offset, NullStreamError);
+        for (std::size_t i = 0; i < FIELDS; ++i) {
+            if (!field(ws, i)) break;
+        }
+        doNotOptimize(buffer);
+    });
+    report(std::format("WriteStream/{}/offset {}", name, offset), ns / FIELDS);
+
+    ns = measure([&] {
+        ReadStream rs(buffer);
+        (void)rs.advanceBits(offset, NullStreamError);
+        for (std::size_t i = 0; i < FIELDS; ++i) {
+            if (!field(rs, i)) break;
+        }
+    });
+    report(std::format("ReadStream/{}/offset {}", name, offset), ns / FIELDS);
+}
+
+template <std::size_t Bits>
+static constexpr auto bits = [] (auto& stream, std::size_t i)
+{
+    std::uint64_t value = i;
+    bool ok = stream.serializeBits(value, Bits, NullStreamError);
+    doNotOptimize(value);
+    return ok;
+};
+
+static constexpr auto byte = [] (auto& stream, std::size_t i)
+{
+    std::uint8_t value = (std::uint8_t)i;
+    bool ok = stream.serializeByte(value, NullStreamError);
+    doNotOptimize(value);
+    return ok;
+};
+
+static constexpr auto uint16 = [] (auto& stream, std::size_t i)
+{
+    std::uint16_t value = (std::uint16_t)i;
+    bool ok = stream.serializeUint16(value, NullStreamError);
+    doNotOptimize(value);
+    return ok;
+};
+
+static constexpr auto uint32 = [] (auto& stream, std::size_t i)
+{
+    std::uint32_t value = (std::uint32_t)i;
+    bool ok = stream.serializeUint32(value, NullStreamError);
+    doNotOptimize(value);
+    return ok;
+};
+
+static constexpr auto uint64 = [] (auto& stream, std::size_t i)
+{
+    std::uint64_t value = i;
+    bool ok = stream.serializeUint64(value, NullStreamError);
+    doNotOptimize(value);
+    return ok;
+};
+
+static constexpr auto bytes = [] (auto& stream, std::size_t i)
+{
+    std::array<std::byte, 8> value = {};
+    bool ok = stream.serializeBytes(value, NullStreamError);
+    doNotOptimize(value);
+    return ok;
+};
+
+int main(int argc, char* argv[])
+{
+    for (std::size_t offset : {0, 1, 4}) {
+        benchField("bits 4", offset, bits<4>);
+        benchField("bits 12", offset, bits<12>);
+        benchField("bits 20", offset, bits<20>);
+        benchField("byte", offset, byte);
+        benchField("uint16", offset, uint16);
+        benchField("uint32", offset, uint32);
+        benchField("uint64", offset, uint64);
+    }
+    benchField("bytes 8", 0, bytes);
+    return 0;
+}
@@ -0,0 +1,84 @@
+// Copyright (c) 2024-2025 Lars-Christian Schulz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "bench.hpp"
+
+#include "scion/hdr/details.hpp"
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <format>
+#include <random>
+#include <utility>
+#include <vector>
+
+
+int main(int argc, char* argv[])
+{
+    using namespace scion::hdr::details;
+
+    static const std::array<std::pair<ChecksumImpl, const char*>, 4> impls = {{
+        {ChecksumImpl::Scalar, "scalar"},
+        {ChecksumImpl::SSE2, "sse2"},
+        {ChecksumImpl::AVX2, "avx2"},
+        {ChecksumImpl::NEON, "neon"},
+    }};
+    static const std::array<std::size_t, 8> sizes = {
+        64, 128, 256, 512, 1024, 1500, 4096, 9000
+    };
+
+    std::vector<std::byte> buffer(sizes.back());
+    std::mt19937 rng(0);
+    std::uniform_int_distribution<int> dist(0, 255);
+    for (auto& b : buffer) b = std::byte(dist(rng));
+    std::vector<std::byte> copy(buffer.size());
+
+    auto defaultImpl = getChecksumImpl();
+    for (auto [impl, name] : impls) {
+        if (!setChecksumImpl(impl)) continue;
+        for (auto size : sizes) {
+            auto data = std::span<const std::byte>(buffer).first(size);
+            auto ns = measure([&] {
+                doNotOptimize(data);
+                doNotOptimize(internetChecksum(data));
+            });
+            report(std::format("internetChecksum/{}/{}", name, size), ns, size);
+        }
+        for (auto size : sizes) {
+            auto data = std::span<const std::byte>(buffer).first(size);
+            auto dst = std::span<std::byte>(copy).first(size);
+            // Separate copy followed by a checksum over the copy
+            auto ns = measure([&] {
+                doNotOptimize(data);
+                std::memcpy(dst.data(), data.data(), size);
+                doNotOptimize(internetChecksum(dst));
+            });
+            report(std::format("memcpy+internetChecksum/{}/{}", name, size), ns, size);
+            ns = measure([&] {
+                doNotOptimize(data);
+                doNotOptimize(internetChecksumCopy(dst, data));
+            });
+            report(std::format("internetChecksumCopy/{}/{}", name, size), ns, size);
+        }
+    }
+    setChecksumImpl(defaultImpl);
+    return 0;
+}
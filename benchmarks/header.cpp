@@ -0,0 +1,124 @@
+// Copyright (c) 2024-2025 Lars-Christian Schulz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "bench.hpp"
+
+#include "scion/addr/endpoint.hpp"
+#include "scion/bit_stream.hpp"
+#include "scion/extensions/extension.hpp"
+#include "scion/hdr/emit.hpp"
+#include "scion/hdr/scion.hpp"
+#include "scion/hdr/udp.hpp"
+#include "scion/path/raw.hpp"
+#include "scion/socket/header_cache.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <format>
+#include <span>
+#include <string_view>
+#include <vector>
+
+
+using namespace scion;
+
+// SCION path with two segments of two hops each.
+static std::vector<std::byte> makeScionPath()
+{
+    std::vector<std::byte> path(4 + 2 * 8 + 4 * 12);
+    hdr::PathMeta meta;
+    meta.segLen = {2, 2, 0};
+    WriteStream ws(path);
+    (void)meta.serialize(ws, NullStreamError);
+    return path;
+}
+
+static void benchLayout(std::string_view name,
+    const Endpoint<generic::IPEndpoint>& from,
+    const Endpoint<generic::IPEndpoint>& to,
+    const RawPath& path)
+{
+    std::array<std::byte, 64> payload = {};
+    hdr::SCION sci;
+    sci.nh = hdr::ScionProto::UDP;
+    sci.ptype = path.type();
+    sci.dst = to.getAddress();
+    sci.src = from.getAddress();
+    sci.hlen = (std::uint8_t)((sci.size() + path.size()) / 4);
+    sci.plen = (std::uint16_t)(8 + payload.size());
+    hdr::UDP udp;
+    udp.sport = from.getPort();
+    udp.dport = to.getPort();
+    udp.setPayload(payload);
+
+    std::vector<std::byte> buffer(4 * sci.hlen + udp.size());
+
+    auto ns = measure([&] {
+        WriteStream ws(buffer);
+        (void)sci.serialize(ws, NullStreamError);
+        (void)ws.serializeBytes(path.encoded(), NullStreamError);
+        (void)udp.serialize(ws, NullStreamError);
+        doNotOptimize(buffer.data());
+    });
+    report(std::format("WriteStream/{}", name), ns);
+
+    ns = measure([&] {
+        auto out = std::span<std::byte>(buffer);
+        auto n = hdr::emitSCION(out, sci);
+        std::ranges::copy(path.encoded(), out.begin() + n);
+        hdr::emitUDP(out.subspan(n + path.size()).first<8>(), udp);
+        doNotOptimize(buffer.data());
+    });
+    report(std::format("emit/{}", name), ns);
+
+    HeaderCache headers;
+    ns = measure([&] {
+        doNotOptimize(headers.build(
+            0, to, from, path, ext::NoExtensions, hdr::UDP{}, payload));
+    });
+    report(std::format("HeaderCache::build/{}", name), ns);
+
+    ns = measure([&] {
+        doNotOptimize(headers.updatePayload(udp, payload));
+    });
+    report(std::format("HeaderCache::updatePayload/{}", name), ns);
+}
+
+int main(int argc, char* argv[])
+{
+    using generic::IPEndpoint;
+    auto src = IsdAsn::Parse("1-ff00:0:1").value();
+    auto dst = IsdAsn::Parse("2-ff00:0:2").value();
+    auto scionPath = makeScionPath();
+    RawPath empty(src, src, hdr::PathType::Empty, {});
+    RawPath path(src, dst, hdr::PathType::SCION, scionPath);
+
+    Endpoint<IPEndpoint> from4(src, IPEndpoint::Parse("10.0.0.1:3000").value());
+    Endpoint<IPEndpoint> to4(dst, IPEndpoint::Parse("10.0.0.2:8000").value());
+    Endpoint<IPEndpoint> from6(src, IPEndpoint::Parse("[fd00::1]:3000").value());
+    Endpoint<IPEndpoint> to6(dst, IPEndpoint::Parse("[fd00::2]:8000").value());
+
+    benchLayout("ipv4/empty", from4, Endpoint<IPEndpoint>(src, to4.getLocalEp()), empty);
+    benchLayout("ipv4/scion", from4, to4, path);
+    benchLayout("ipv6/empty", from6, Endpoint<IPEndpoint>(src, to6.getLocalEp()), empty);
+    benchLayout("ipv6/scion", from6, to6, path);
+    return 0;
+}
@@ -0,0 +1,79 @@
+// Copyright (c) 2024-2025 Lars-Christian Schulz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <format>
+#include <iostream>
+#include <string_view>
+
+
+/// \brief Prevent the compiler from optimizing away a computed value.
+template <typename T>
+inline void doNotOptimize(const T& value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile const T* sink;
+    sink = &value;
+#endif
+}
+
+/// \brief Measure the time per call of `f` in nanoseconds. `f` is called in
+/// batches until at least `minTime` has passed. The fastest batch of several
+/// repetitions is reported to reduce noise.
+template <typename F>
+double measure(F&& f, std::chrono::milliseconds minTime = std::chrono::milliseconds(100))
+{
+    using Clock = std::chrono::steady_clock;
+    constexpr int REPETITIONS = 5;
+    std::uint64_t iterations = 1;
+    double best = 0.0;
+    // Find an iteration count that runs for a measurable time
+    while (true) {
+        auto t0 = Clock::now();
+        for (std::uint64_t i = 0; i < iterations; ++i) f();
+        auto elapsed = Clock::now() - t0;
+        if (elapsed >= minTime / REPETITIONS) break;
+        iterations *= 2;
+    }
+    for (int r = 0; r < REPETITIONS; ++r) {
+        auto t0 = Clock::now();
+        for (std::uint64_t i = 0; i < iterations; ++i) f();
+        std::chrono::duration<double, std::nano> elapsed = Clock::now() - t0;
+        auto perCall = elapsed.count() / (double)iterations;
+        best = r == 0 ? perCall : std::min(best, perCall);
+    }
+    return best;
+}
+
+/// \brief Print a result line with time per call and optional throughput.
+inline void report(std::string_view name, double ns, std::size_t bytes = 0)
+{
+    if (bytes)
+        std::cout << std::format("{:<40} {:>10.2f} ns {:>8.2f} GB/s\n", name, ns, bytes / ns);
+    else
+        std::cout << std::format("{:<40} {:>10.2f} ns\n", name, ns);
+}
@@ -162,27 +162,27 @@ int runServer(
 
     auto echo = [&args] (Socket& s) -> awaitable<std::error_code>
     {
-        Socket::Endpoint from;
-        Socket::UnderlayEp ulSource;
-        HeaderCache headers;
-        std::vector<std::byte> buffer(2048);
-        auto path = std::make_unique<RawPath>();
+        constexpr std::size_t BATCH_SIZE = 16;
+        std::vector<std::byte> buffer(BATCH_SIZE * 2048);
+        std::vector<ReceivedPacket<Socket::UnderlayEp>> packets(BATCH_SIZE);
         constexpr auto token = boost::asio::use_awaitable;
 
         while (true) {
-            auto recvd = co_await s.recvFromViaAsync(buffer, from, *path, ulSource, token);
-            if (recvd.has_value()) {
-                std::cout << "Received " << recvd->size() << " bytes from " << from << ":\n";
-                std::cout << printBuffer(*recvd);
-                if (!path->reverseInPlace()) {
-                    if (args.show_path) std::cout << "Path: " << *path << '\n';
-                    auto sent = co_await s.sendToAsync(headers, from, *path, ulSource, *recvd, token);
-                    if (isError(sent)) {
-                        co_return sent.error();
-                    }
+            auto batch = co_await s.recvManyAsync(buffer, packets, token);
+            if (isError(batch)) co_return batch.error();
+            for (auto& pkt : *batch) {
+                std::cout << "Received " << pkt.payload.size() << " bytes from " << pkt.from << ":\n";
+                std::cout << printBuffer(pkt.payload);
+                if (args.show_path) std::cout << "Request path: " << pkt.path << '\n';
+                // Echo the payload by turning the received packet into the reply.
+                // This overwrites the packet buffer pkt.path refers to.
+                auto sent = co_await s.sendReplyAsync(
+                    pkt.packet, pkt.payload.size(), pkt.ulSource, token);
+                if (isError(sent)) {
+                    // Paths that cannot be reversed are not fatal to the server
+                    if (sent.error() != ErrorCode::NotImplemented) co_return sent.error();
+                    std::cerr << "Can't reply to " << pkt.from << " : " << fmtError(sent.error()) << '\n';
                 }
-            } else {
-                co_return recvd.error();
             }
         }
     };
@@ -66,7 +66,7 @@ public:
     IsdAsn getIsdAsn() const { return ia; }
     IsdAsn& getIsdAsn() { return ia; }
 
-    HostAddr getHost() const { return host; };
+    const HostAddr& getHost() const { return host; };
     HostAddr& getHost() { return host; };
 
     std::strong_ordering operator<=>(const Address<T>&) const = default;
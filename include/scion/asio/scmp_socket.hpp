@@ -46,6 +46,7 @@ public:
 protected:
     UnderlaySocket socket;
     ScionPackager packager;
+    bool reusePort = false;
 
 public:
     template <typename Executor>
@@ -72,6 +73,7 @@ public:
         auto underlayEp = generic::toUnderlay<bsd::IPEndpoint>(ep.getLocalEp());
         if (isError(underlayEp)) return getError(underlayEp);
         bsd::BSDSocket<bsd::IPEndpoint> s;
+        s.setReusePort(reusePort);
         auto err = s.bind_range(*underlayEp, firstPort, lastPort);
         if (err) return err;
 
@@ -92,6 +94,9 @@ public:
         return packager.setLocalEp(Endpoint(ep.getIsdAsn(), local->getHost(), local->getPort()));
     }
 
+    /// \copydoc bsd::BSDSocket::setReusePort()
+    void setReusePort(bool reuse) { reusePort = reuse; }
+
     /// \brief Locally store a default remote address. Receive methods will only
     /// return packets from the "connected" address. Can be called multiple
     /// times to change the remote address or with an unspecified address to
@@ -126,6 +131,20 @@ public:
     /// \brief Returns the current traffic class.
     std::uint8_t getTrafficClass() const { return packager.getTrafficClass(); }
 
+    /// \copydoc ScionPackager::setChecksumPolicy()
+    std::error_code setChecksumPolicy(ChecksumPolicy policy, std::uint32_t interval = 1)
+    {
+        return packager.setChecksumPolicy(policy, interval);
+    }
+
+    /// \brief Returns the current checksum verification policy.
+    ChecksumPolicy getChecksumPolicy() const { return packager.getChecksumPolicy(); }
+
+    /// \brief Returns the checksum of the last received packet if the
+    /// checksum policy is ChecksumPolicy::Defer. Call `verify()` on the result
+    /// with the received payload before consuming it.
+    DeferredChecksum getDeferredChecksum() const { return packager.getDeferredChecksum(); }
+
     /// \brief Sets the non-blocking mode of the socket.
     void setNonblocking(bool nonblocking)
     {
@@ -210,11 +229,11 @@ public:
     Maybe<std::span<std::byte>> recvScmpFromVia(
         std::span<std::byte> buf,
         Endpoint& from,
-        RawPath& path,
+        RawPathOutput path,
         UnderlayEp& ulSource,
         hdr::ScmpMessage& message)
     {
-        return recvScmpImpl(buf, &from, &path, ulSource,
+        return recvScmpImpl(buf, &from, path, ulSource,
             ext::NoExtensions, ext::NoExtensions, message);
     }
 
@@ -222,13 +241,13 @@ public:
     Maybe<std::span<std::byte>> recvScmpFromViaExt(
         std::span<std::byte> buf,
         Endpoint& from,
-        RawPath& path,
+        RawPathOutput path,
         UnderlayEp& ulSource,
         HbHExt&& hbhExt,
         E2EExt&& e2eExt,
         hdr::ScmpMessage& message)
     {
-        return recvScmpImpl(buf, &from, &path, ulSource,
+        return recvScmpImpl(buf, &from, path, ulSource,
             std::forward<HbHExt>(hbhExt), std::forward<E2EExt>(e2eExt), message);
     }
 
@@ -241,12 +260,12 @@ public:
     auto recvScmpFromViaAsync(
         std::span<std::byte> buf,
         Endpoint& from,
-        RawPath& path,
+        RawPathOutput path,
         UnderlayEp& ulSource,
         hdr::ScmpMessage& message,
         CompletionToken&& token)
     {
-        return recvScmpAsyncImpl(buf, &from, &path, ulSource,
+        return recvScmpAsyncImpl(buf, &from, path, ulSource,
             ext::NoExtensions, ext::NoExtensions, message, token);
     }
 
@@ -256,14 +275,14 @@ public:
     auto recvScmpFromViaExtAsync(
         std::span<std::byte> buf,
         Endpoint& from,
-        RawPath& path,
+        RawPathOutput path,
         UnderlayEp& ulSource,
         HbHExt& hbhExt,
         E2EExt& e2eExt,
         hdr::ScmpMessage& message,
         CompletionToken&& token)
     {
-        return recvScmpAsyncImpl(buf, &from, &path, ulSource, hbhExt, e2eExt, message, token);
+        return recvScmpAsyncImpl(buf, &from, path, ulSource, hbhExt, e2eExt, message, token);
     }
 
     ///@}
@@ -371,7 +390,7 @@ private:
     auto recvScmpAsyncImpl(
         std::span<std::byte> buf,
         Endpoint* from,
-        RawPath* path,
+        RawPathOutput path,
         UnderlayEp& ulSource,
         HbHExt& hbhExt,
         E2EExt& e2eExt,
@@ -385,7 +404,7 @@ private:
             ScionPackager& packager,
             std::span<std::byte> buf,
             Endpoint* from,
-            RawPath* path,
+            RawPathOutput path,
             UnderlayEp& ulSource,
             HbHExt& hbhExt,
             E2EExt& e2eExt,
@@ -397,24 +416,22 @@ private:
                 ScionPackager& packager_;
                 std::span<std::byte> buf_;
                 Endpoint* from_;
-                RawPath* path_;
+                RawPathOutput path_;
                 UnderlayEp& ulSource_;
                 HbHExt& hbhExt_;
                 E2EExt& e2eExt_;
                 hdr::ScmpMessage& message_;
-                boost::asio::executor_work_guard<UnderlaySocket::executor_type> ioWork_;
                 typename std::decay<decltype(completionHandler)>::type handler_;
 
                 void operator()(const boost::system::error_code& error, std::size_t n)
                 {
                     if (error) {
-                        ioWork_.reset();
                         handler_(Error(error));
                         return;
                     }
 
                     std::span<std::byte> payload;
-                    auto scmp = [&] (const Address& from, const RawPath& path,
+                    auto scmp = [&] (const Address& from, const RawPathView& path,
                         const hdr::ScmpMessage& msg, std::span<const std::byte> data)
                     {
                         message_ = msg;
@@ -431,7 +448,6 @@ private:
                         from_, path_, scmp);
                     if (isError(decoded) && getError(decoded) == ErrorCode::ScmpReceived) {
                         // call the final completion handler
-                        ioWork_.reset();
                         handler_(std::span<std::byte>{
                             const_cast<std::byte*>(payload.data()),
                             payload.size()
@@ -466,7 +482,6 @@ private:
             socket.async_receive_from(boost::asio::buffer(buf), ulSource,
                 intermediate_completion_handler{
                     socket, packager, buf, from, path, ulSource, hbhExt, e2eExt, message,
-                    boost::asio::make_work_guard(socket.get_executor()),
                     std::forward<decltype(completionHandler)>(completionHandler)
                 }
             );
@@ -485,14 +500,14 @@ private:
     Maybe<std::span<std::byte>> recvScmpImpl(
         std::span<std::byte> buf,
         Endpoint* from,
-        RawPath* path,
+        RawPathOutput path,
         UnderlayEp& ulSource,
         HbHExt&& hbhExt,
         E2EExt&& e2eExt,
         hdr::ScmpMessage& message)
     {
         std::span<std::byte> payload;
-        auto scmp = [&] (const Address& from, const RawPath& path,
+        auto scmp = [&] (const Address& from, const RawPathView& path,
             const hdr::ScmpMessage& msg, std::span<const std::byte> data)
         {
             message = msg;
@@ -535,6 +550,23 @@ protected:
         if (n < 0) return Error(ErrorCode::PacketTooBig);
         return payload.subspan(0, n);
     }
+
+    /// \brief Send a packet stored in a single contiguous buffer.
+    /// \param packet Headers immediately followed by the payload.
+    /// \param hdrSize Size of the headers at the beginning of `packet`.
+    /// \return The part of the payload that was sent.
+    Maybe<std::span<const std::byte>> sendUnderlay(
+        std::span<const std::byte> packet,
+        std::size_t hdrSize,
+        const UnderlayEp& nextHop)
+    {
+        boost::system::error_code ec;
+        auto sent = socket.send_to(boost::asio::buffer(packet), nextHop, 0, ec);
+        if (ec) return Error(ec);
+        auto n = (std::int_fast32_t)sent - (std::int_fast32_t)hdrSize;
+        if (n < 0) return Error(ErrorCode::PacketTooBig);
+        return packet.subspan(hdrSize, n);
+    }
 };
 
 } // namespace asio
@@ -0,0 +1,129 @@
+// Copyright (c) 2024-2025 Lars-Christian Schulz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "scion/asio/udp_socket.hpp"
+#include "scion/bsd/sharded_server.hpp"
+
+#include <boost/asio.hpp>
+
+#include <algorithm>
+#include <memory>
+#include <thread>
+#include <vector>
+
+
+#if __linux__
+namespace scion {
+namespace asio {
+
+/// \brief Server that receives on one SCION endpoint from multiple threads.
+///
+/// Asio counterpart of bsd::ShardedUDPServer. Every shard has its own
+/// single-threaded io_context, which runs on a thread pinned to a different
+/// CPU. Asynchronous operations on a shard's socket must be initiated from the
+/// shard's io_context, e.g., by posting or spawning them there.
+class ShardedUDPServer
+{
+public:
+    using Endpoint = UDPSocket::Endpoint;
+
+private:
+    struct Shard
+    {
+        boost::asio::io_context ioCtx{1};
+        UDPSocket socket{ioCtx};
+    };
+    std::vector<std::unique_ptr<Shard>> shards;
+    std::vector<unsigned> cpus;
+
+public:
+    /// \copydoc bsd::ShardedUDPServer::bind()
+    std::error_code bind(const Endpoint& ep, std::size_t count = 0, bool steerByFlow = true)
+    {
+        if (!shards.empty()) return ErrorCode::LogicError;
+        cpus = bsd::details::getAllowedCpus();
+        if (count == 0) count = std::max<std::size_t>(cpus.size(), 1);
+
+        shards.reserve(count);
+        auto ec = bsd::details::bindShards(ep, count,
+            [this] (std::size_t, const Endpoint& ep) -> Maybe<Endpoint> {
+                auto& s = shards.emplace_back(std::make_unique<Shard>());
+                s->socket.setReusePort(true);
+                if (auto ec = s->socket.bind(ep); ec) return Error(ec);
+                return s->socket.getLocalEp();
+            });
+        if (!ec && steerByFlow) {
+            ec = bsd::details::attachFlowSteering(
+                shards.front()->socket.getNativeHandle(), (std::uint32_t)count);
+        }
+        if (ec) close();
+        return ec;
+    }
+
+    /// \brief Close all shards and cancel their pending operations.
+    void close()
+    {
+        for (auto& s : shards) s->socket.close();
+        shards.clear();
+    }
+
+    /// \brief Number of shards.
+    std::size_t size() const { return shards.size(); }
+
+    /// \brief Access the socket of a shard.
+    UDPSocket& operator[](std::size_t i) { return shards[i]->socket; }
+
+    /// \brief Access the io_context of a shard.
+    boost::asio::io_context& context(std::size_t i) { return shards[i]->ioCtx; }
+
+    /// \brief Returns the local endpoint all shards are bound to.
+    Endpoint getLocalEp() const
+    {
+        return shards.empty() ? Endpoint() : shards.front()->socket.getLocalEp();
+    }
+
+    /// \brief Run the io_contexts of all shards, each on its own thread pinned
+    /// to one of the CPUs available when the server was bound. Returns when
+    /// all io_contexts have run out of work or were stopped with stop().
+    void run()
+    {
+        std::vector<std::thread> threads;
+        threads.reserve(shards.size());
+        for (std::size_t i = 0; i < shards.size(); ++i) {
+            threads.emplace_back([this, i] {
+                if (!cpus.empty()) bsd::details::pinThisThread(cpus[i % cpus.size()]);
+                shards[i]->ioCtx.run();
+            });
+        }
+        for (auto& t : threads) t.join();
+    }
+
+    /// \brief Stop the io_contexts of all shards.
+    void stop()
+    {
+        for (auto& s : shards) s->ioCtx.stop();
+    }
+};
+
+} // namespace asio
+} // namespace scion
+#endif // __linux__
@@ -22,6 +22,12 @@
 
 #include "scion/asio/scmp_socket.hpp"
 #include "scion/scmp/handler.hpp"
+#include "scion/socket/gro.hpp"
+#include "scion/socket/header_cache_pool.hpp"
+#include "scion/socket/received_packet.hpp"
+
+#include <algorithm>
+#include <array>
 
 
 namespace scion {
@@ -31,9 +37,17 @@ namespace asio {
 /// via Asio.
 class UDPSocket : public SCMPSocket
 {
+public:
+    /// \brief Maximum number of packets returned by a single batched receive.
+    static constexpr std::size_t MAX_BATCH_SIZE = bsd::BSDSocket<bsd::IPEndpoint>::MAX_BATCH_SIZE;
+
 protected:
     ScmpHandler* scmpHandler;
 
+private:
+    bool groEnabled = false;
+    details::GroSegments<UnderlayEp> groSegments;
+
 public:
     template <typename Executor>
     explicit UDPSocket(Executor& ex)
@@ -43,6 +57,31 @@ public:
     void setNextScmpHandler(ScmpHandler* handler) { scmpHandler = handler; }
     ScmpHandler* nextScmpHandler() const { return scmpHandler; }
 
+    /// \brief Enable or disable UDP generic receive offload (GRO) on the
+    /// underlay socket. Must be called after `bind()`.
+    ///
+    /// With GRO enabled, a single underlay receive operation may return many
+    /// packets from the same source coalesced into one buffer. The receive
+    /// methods return these packets one at a time. Packets that have not been
+    /// returned yet are kept in the buffer passed to the receive call that
+    /// obtained them, so that buffer must stay valid and must not be modified
+    /// outside of the returned payloads until all packets have been consumed.
+    /// Receive buffers should be large enough to hold a full 64 KiB of
+    /// coalesced datagrams.
+    std::error_code setGro(bool enable)
+    {
+    #if __linux__
+        using GroOption = boost::asio::detail::socket_option::integer<SOL_UDP, UDP_GRO>;
+        boost::system::error_code ec;
+        socket.set_option(GroOption(enable), ec);
+        if (ec) return ec;
+        groEnabled = enable;
+        return ErrorCode::Ok;
+    #else
+        return ErrorCode::NotImplemented;
+    #endif
+    }
+
     /// \name Synchronous Send
     ///@{
 
@@ -85,6 +124,22 @@ public:
         return sendUnderlay(headers.get(), payload, nextHop);
     }
 
+    /// \brief Send a packet using headers from a pool of header caches.
+    /// Headers are only built from scratch if the destination and path are
+    /// not in the pool.
+    template <typename Path, typename Alloc>
+    Maybe<std::span<const std::byte>> sendTo(
+        HeaderCachePool<Alloc>& pool,
+        const Endpoint& to,
+        const Path& path,
+        const UnderlayEp& nextHop,
+        std::span<const std::byte> payload)
+    {
+        auto headers = pool.pack(packager, to, path, hdr::UDP{}, payload);
+        if (isError(headers)) return propagateError(headers);
+        return sendUnderlay(get(headers), payload, nextHop);
+    }
+
     template <typename Path, ext::extension_range ExtRange, typename Alloc>
     Maybe<std::span<const std::byte>> sendToExt(
         HeaderCache<Alloc>& headers,
@@ -129,6 +184,57 @@ public:
         return sendUnderlay(headers.get(), payload, nextHop);
     }
 
+    /// \brief Send a packet from a single contiguous buffer. The payload must
+    /// be stored in `buf` at offset `headroom`. The headers are written into
+    /// the headroom in front of it, see ScionPackager::packInPlace().
+    template <typename Path, typename Alloc>
+    Maybe<std::span<const std::byte>> sendToInPlace(
+        HeaderCache<Alloc>& headers,
+        const Endpoint& to,
+        const Path& path,
+        const UnderlayEp& nextHop,
+        std::span<std::byte> buf,
+        std::size_t headroom)
+    {
+        auto packet = packager.packInPlace(
+            headers, &to, path, ext::NoExtensions, hdr::UDP{}, buf, headroom);
+        if (isError(packet)) return propagateError(packet);
+        return sendUnderlay(get(packet), headers.size(), nextHop);
+    }
+
+    /// \brief Send a packet from a single contiguous buffer to the connected
+    /// remote endpoint using the headers from a previous send.
+    template <typename Alloc>
+    Maybe<std::span<const std::byte>> sendCachedInPlace(
+        HeaderCache<Alloc>& headers,
+        const UnderlayEp& nextHop,
+        std::span<std::byte> buf,
+        std::size_t headroom)
+    {
+        hdr::UDP udp;
+        udp.sport = packager.getLocalEp().getPort();
+        udp.dport = packager.getRemoteEp().getPort();
+        auto packet = packager.packInPlace(headers, udp, buf, headroom);
+        if (isError(packet)) return propagateError(packet);
+        return sendUnderlay(get(packet), headers.size(), nextHop);
+    }
+
+    /// \brief Reply to a received packet by turning it into the reply in
+    /// place, see ScionPackager::packReply().
+    /// \param packet Received packet, e.g., ReceivedPacket::packet, with the
+    /// reply payload stored in place of the received payload.
+    /// \param payloadSize Size of the reply payload.
+    /// \param nextHop Usually the underlay source of the received packet.
+    Maybe<std::span<const std::byte>> sendReply(
+        std::span<std::byte> packet,
+        std::size_t payloadSize,
+        const UnderlayEp& nextHop)
+    {
+        auto reply = packager.packReply(packet, payloadSize);
+        if (isError(reply)) return propagateError(reply);
+        return sendUnderlay(get(reply), get(reply).size() - payloadSize, nextHop);
+    }
+
     ///@}
     /// \name Asynchronous Send
     ///@{
@@ -222,6 +328,69 @@ public:
         return sendCachedAsyncImpl(headers, &to, nextHop, payload, token);
     }
 
+    /// \brief Asynchronously send a packet from a single contiguous buffer.
+    /// See sendToInPlace().
+    template <
+        typename Path, typename Alloc,
+        boost::asio::completion_token_for<void(Maybe<std::span<const std::byte>>)>
+            CompletionToken>
+    auto sendToInPlaceAsync(
+        HeaderCache<Alloc>& headers,
+        const Endpoint& to,
+        const Path& path,
+        const UnderlayEp& nextHop,
+        std::span<std::byte> buf,
+        std::size_t headroom,
+        CompletionToken&& token)
+    {
+        auto pack = [&headers, &to, &path, buf, headroom] (ScionPackager& packager) {
+            return packager.packInPlace(
+                headers, &to, path, ext::NoExtensions, hdr::UDP{}, buf, headroom);
+        };
+        return sendInPlaceAsyncImpl(pack, nextHop, buf.size() - headroom,
+            std::forward<CompletionToken>(token));
+    }
+
+    /// \brief Asynchronously send a packet from a single contiguous buffer to
+    /// the connected remote endpoint. See sendCachedInPlace().
+    template <
+        typename Alloc,
+        boost::asio::completion_token_for<void(Maybe<std::span<const std::byte>>)>
+            CompletionToken>
+    auto sendCachedInPlaceAsync(
+        HeaderCache<Alloc>& headers,
+        const UnderlayEp& nextHop,
+        std::span<std::byte> buf,
+        std::size_t headroom,
+        CompletionToken&& token)
+    {
+        auto pack = [&headers, buf, headroom] (ScionPackager& packager) {
+            hdr::UDP udp;
+            udp.sport = packager.getLocalEp().getPort();
+            udp.dport = packager.getRemoteEp().getPort();
+            return packager.packInPlace(headers, udp, buf, headroom);
+        };
+        return sendInPlaceAsyncImpl(pack, nextHop, buf.size() - headroom,
+            std::forward<CompletionToken>(token));
+    }
+
+    /// \brief Asynchronously reply to a received packet. See sendReply().
+    template <
+        boost::asio::completion_token_for<void(Maybe<std::span<const std::byte>>)>
+            CompletionToken>
+    auto sendReplyAsync(
+        std::span<std::byte> packet,
+        std::size_t payloadSize,
+        const UnderlayEp& nextHop,
+        CompletionToken&& token)
+    {
+        auto pack = [packet, payloadSize] (ScionPackager& packager) {
+            return packager.packReply(packet, payloadSize);
+        };
+        return sendInPlaceAsyncImpl(pack, nextHop, payloadSize,
+            std::forward<CompletionToken>(token));
+    }
+
     ///@}
     /// \name Synchronous Receive
     ///@{
@@ -264,22 +433,22 @@ public:
     auto recvFromVia(
         std::span<std::byte> buf,
         Endpoint& from,
-        RawPath& path,
+        RawPathOutput path,
         UnderlayEp& ulSource)
     {
-        return recvImpl(buf, &from, &path, ulSource, ext::NoExtensions, ext::NoExtensions);
+        return recvImpl(buf, &from, path, ulSource, ext::NoExtensions, ext::NoExtensions);
     }
 
     template<ext::extension_range HbHExt, ext::extension_range E2EExt>
     auto recvFromViaExt(
         std::span<std::byte> buf,
         Endpoint& from,
-        RawPath& path,
+        RawPathOutput path,
         UnderlayEp& ulSource,
         HbHExt& hbhExt,
         E2EExt& e2eExt)
     {
-        return recvImpl(buf, &from, &path, ulSource, hbhExt, e2eExt);
+        return recvImpl(buf, &from, path, ulSource, hbhExt, e2eExt);
     }
 
     ///@}
@@ -348,11 +517,11 @@ public:
     auto recvFromViaAsync(
         std::span<std::byte> buf,
         Endpoint& from,
-        RawPath& path,
+        RawPathOutput path,
         UnderlayEp& ulSource,
         CompletionToken&& token)
     {
-        return recvAsyncImpl(buf, &from, &path, ulSource, ext::NoExtensions, ext::NoExtensions,
+        return recvAsyncImpl(buf, &from, path, ulSource, ext::NoExtensions, ext::NoExtensions,
             std::forward<CompletionToken>(token));
     }
 
@@ -363,16 +532,110 @@ public:
     auto recvFromViaExtAsync(
         std::span<std::byte> buf,
         Endpoint& from,
-        RawPath& path,
+        RawPathOutput path,
         UnderlayEp& ulSource,
         HbHExt& hbhExt,
         E2EExt& e2eExt,
         CompletionToken&& token)
     {
-        return recvAsyncImpl(buf, &from, &path, ulSource, hbhExt, e2eExt,
+        return recvAsyncImpl(buf, &from, path, ulSource, hbhExt, e2eExt,
             std::forward<CompletionToken>(token));
     }
 
+    /// \brief Wait until the socket is readable, then receive as many
+    /// packets as are available with as few system calls as possible.
+    /// Completes once per batch with at least one valid packet.
+    /// \param buf Receive buffer. The buffer is divided evenly between up to
+    /// `results.size()` underlay datagrams.
+    /// \param results Storage for the received packets. At most
+    /// MAX_BATCH_SIZE packets are received at once.
+    /// \return Leading subrange of `results` containing the valid packets. The
+    /// payloads and paths point into `buf`. Invalid and SCMP packets are skipped.
+    /// \note If GRO is enabled, `buf` is not divided. Instead, a single
+    /// coalesced buffer is received and split into packets. See setGro().
+    template<
+        boost::asio::completion_token_for<void(Maybe<std::span<ReceivedPacket<UnderlayEp>>>)>
+            CompletionToken>
+    auto recvManyAsync(
+        std::span<std::byte> buf,
+        std::span<ReceivedPacket<UnderlayEp>> results,
+        CompletionToken&& token)
+    {
+        using Result = Maybe<std::span<ReceivedPacket<UnderlayEp>>>;
+        auto initiation = [] (
+            boost::asio::completion_handler_for<void(Result)> auto&& completionHandler,
+            UDPSocket& self,
+            std::span<std::byte> buf,
+            std::span<ReceivedPacket<UnderlayEp>> results)
+        {
+            struct intermediate_completion_handler
+            {
+                UDPSocket& self_;
+                std::span<std::byte> buf_;
+                std::span<ReceivedPacket<UnderlayEp>> results_;
+                typename std::decay<decltype(completionHandler)>::type handler_;
+
+                // Completion of async_wait()
+                void operator()(const boost::system::error_code& error)
+                {
+                    if (error) {
+                        handler_(Error(error));
+                        return;
+                    }
+                    auto recvd = self_.recvManyImpl(buf_, results_);
+                    if (isError(recvd)) {
+                        if (getError(recvd) != std::errc::operation_would_block) {
+                            handler_(propagateError(recvd));
+                            return;
+                        }
+                    } else if (!get(recvd).empty()) {
+                        handler_(get(recvd));
+                        return;
+                    }
+                    self_.socket.async_wait(UnderlaySocket::wait_read, std::move(*this));
+                }
+
+                // Posted to consume remaining GRO segments
+                void operator()()
+                {
+                    (*this)(boost::system::error_code());
+                }
+
+                using executor_type = boost::asio::associated_executor_t<
+                    typename std::decay<decltype(completionHandler)>::type,
+                    UnderlaySocket::executor_type>;
+                executor_type get_executor() const noexcept
+                {
+                    return boost::asio::get_associated_executor(
+                        handler_, self_.socket.get_executor());
+                }
+
+                using allocator_type = boost::asio::associated_allocator_t<
+                    typename std::decay<decltype(completionHandler)>::type,
+                    std::allocator<void>>;
+                allocator_type get_allocator() const noexcept
+                {
+                    return boost::asio::get_associated_allocator(
+                        handler_, std::allocator<void>{});
+                }
+            };
+
+            intermediate_completion_handler handler{
+                self, buf, results,
+                std::forward<decltype(completionHandler)>(completionHandler)
+            };
+            if (self.groSegments.empty()) {
+                self.socket.async_wait(UnderlaySocket::wait_read, std::move(handler));
+            } else {
+                // consume remaining datagrams first
+                boost::asio::post(std::move(handler));
+            }
+        };
+
+        return boost::asio::async_initiate<CompletionToken, void(Result)>(
+            initiation, token, std::ref(*this), buf, results);
+    }
+
     ///@}
 
 private:
@@ -559,6 +822,92 @@ private:
         );
     }
 
+    // Send a packet built in a contiguous buffer by `pack`, which is invoked
+    // with the packager and must return the complete packet ending with a
+    // payload of `payloadSize` bytes.
+    template<
+        typename Pack,
+        boost::asio::completion_token_for<void(Maybe<std::span<const std::byte>>)>
+            CompletionToken>
+    auto sendInPlaceAsyncImpl(
+        Pack pack,
+        const UnderlayEp& nextHop,
+        std::size_t payloadSize,
+        CompletionToken&& token)
+    {
+        auto initiation = [] (
+            boost::asio::completion_handler_for<void(Maybe<std::span<const std::byte>>)>
+                auto&& completionHandler,
+            UnderlaySocket& socket,
+            ScionPackager& packager,
+            Pack pack,
+            const UnderlayEp& nextHop,
+            std::size_t payloadSize)
+        {
+            struct intermediate_completion_handler
+            {
+                UnderlaySocket& socket_;
+                std::span<const std::byte> packet_;
+                std::size_t hdrSize;
+                typename std::decay<decltype(completionHandler)>::type handler_;
+
+                void operator()(const boost::system::error_code& error, std::size_t sent)
+                {
+                    Maybe<std::span<const std::byte>> result;
+                    auto n = (std::int_fast32_t)sent - (std::int_fast32_t)hdrSize;
+                    if (error) result = Error(error);
+                    else if (n < 0) result = Error(ErrorCode::PacketTooBig);
+                    else result = packet_.subspan(hdrSize, n);
+                    handler_(result);
+                }
+
+                using executor_type = boost::asio::associated_executor_t<
+                    typename std::decay<decltype(completionHandler)>::type,
+                    UnderlaySocket::executor_type>;
+                executor_type get_executor() const noexcept
+                {
+                    return boost::asio::get_associated_executor(
+                        handler_, socket_.get_executor());
+                }
+
+                using allocator_type = boost::asio::associated_allocator_t<
+                    typename std::decay<decltype(completionHandler)>::type,
+                    std::allocator<void>>;
+                allocator_type get_allocator() const noexcept
+                {
+                    return boost::asio::get_associated_allocator(
+                        handler_, std::allocator<void>{});
+                }
+            };
+
+            auto packet = pack(packager);
+            if (isError(packet)) {
+                auto executor = boost::asio::get_associated_executor(
+                    completionHandler, socket.get_executor());
+                boost::asio::post(
+                    boost::asio::bind_executor(executor,
+                        std::bind(std::forward<decltype(completionHandler)>(completionHandler),
+                            Error(getError(packet)))));
+            } else {
+                auto data = get(packet);
+                socket.async_send_to(boost::asio::buffer(data), nextHop,
+                    intermediate_completion_handler{
+                        socket, data, data.size() - payloadSize,
+                        std::forward<decltype(completionHandler)>(completionHandler)
+                    }
+                );
+            }
+        };
+
+        return boost::asio::async_initiate<
+            CompletionToken, void(Maybe<std::span<const std::byte>>)>
+        (
+            initiation, token,
+            std::ref(socket), std::ref(packager), std::move(pack),
+            std::ref(nextHop), payloadSize
+        );
+    }
+
     template<
         ext::extension_range HbHExt, ext::extension_range E2EExt,
         boost::asio::completion_token_for<void(Maybe<std::span<std::byte>>)>
@@ -566,7 +915,7 @@ private:
     auto recvAsyncImpl(
         std::span<std::byte> buf,
         Endpoint* from,
-        RawPath* path,
+        RawPathOutput path,
         UnderlayEp& ulSource,
         HbHExt& hbhExt,
         E2EExt& e2eExt,
@@ -579,11 +928,12 @@ private:
             ScionPackager& packager,
             std::span<std::byte> buf,
             Endpoint* from,
-            RawPath* path,
+            RawPathOutput path,
             UnderlayEp& ulSource,
             HbHExt& hbhExt,
             E2EExt& e2eExt,
-            ScmpHandler* scmpHandler)
+            ScmpHandler* scmpHandler,
+            details::GroSegments<UnderlayEp>* gro)
         {
             struct intermediate_completion_handler
             {
@@ -591,31 +941,74 @@ private:
                 ScionPackager& packager_;
                 std::span<std::byte> buf_;
                 Endpoint* from_;
-                RawPath* path_;
+                RawPathOutput path_;
                 UnderlayEp& ulSource_;
                 HbHExt& hbhExt_;
                 E2EExt& e2eExt_;
                 ScmpHandler* scmpHandler_;
-                boost::asio::executor_work_guard<UnderlaySocket::executor_type> ioWork_;
+                details::GroSegments<UnderlayEp>* gro_;
                 typename std::decay<decltype(completionHandler)>::type handler_;
 
+                // Completion of async_receive_from()
                 void operator()(const boost::system::error_code& error, std::size_t n)
                 {
                     if (error) {
-                        ioWork_.reset();
                         handler_(Error(error));
                         return;
                     }
+                    if (!complete(buf_.subspan(0, n))) {
+                        socket_.async_receive_from(
+                            boost::asio::buffer(buf_), ulSource_, std::move(*this));
+                        return; // do it again
+                    }
+                }
+
+                // Posted to consume remaining GRO segments
+                void operator()()
+                {
+                    (*this)(boost::system::error_code());
+                }
+
+                // Completion of async_wait() in GRO mode
+                void operator()(const boost::system::error_code& error)
+                {
+                    if (error) {
+                        handler_(Error(error));
+                        return;
+                    }
+                    if (gro_->empty()) {
+                        std::size_t segmentSize = 0;
+                        auto recvd = recvGro(socket_, buf_, ulSource_, segmentSize);
+                        if (isError(recvd)) {
+                            if (getError(recvd) == std::errc::operation_would_block) {
+                                socket_.async_wait(UnderlaySocket::wait_read, std::move(*this));
+                                return;
+                            }
+                            handler_(Error(getError(recvd)));
+                            return;
+                        }
+                        gro_->assign(get(recvd), segmentSize, ulSource_);
+                    }
+                    while (!gro_->empty()) {
+                        if (complete(gro_->next(ulSource_))) return;
+                    }
+                    socket_.async_wait(UnderlaySocket::wait_read, std::move(*this));
+                }
+
+                // Parse a datagram and call the final completion handler if it
+                // contained a valid packet.
+                bool complete(std::span<std::byte> dgram)
+                {
                     auto scmpCallback = [this] (
                         const scion::Address<generic::IPAddress>& from,
-                        const RawPath& path,
+                        const RawPathView& path,
                         const hdr::ScmpMessage& msg,
                         std::span<const std::byte> payload)
                     {
                         if (scmpHandler_) scmpHandler_->handleScmp(from, path, msg, payload);
                     };
                     auto payload = packager_.template unpack<hdr::UDP>(
-                        buf_.subspan(0, n),
+                        dgram,
                         generic::toGenericAddr(EndpointTraits<UnderlayEp>::getHost(ulSource_)),
                         hbhExt_, e2eExt_, from_, path_, scmpCallback);
                     if (isError(payload)) {
@@ -625,17 +1018,14 @@ private:
                                 ulSource_, fmtError(getError(payload))
                             )));
                         }
-                        socket_.async_receive_from(
-                            boost::asio::buffer(buf_), ulSource_, std::move(*this));
-                        return; // do it again
-                    } else {
-                        // call the final completion handler
-                        ioWork_.reset();
-                        handler_(std::span<std::byte>{
-                            const_cast<std::byte*>(payload->data()),
-                            payload->size()
-                        });
+                        return false;
                     }
+                    // call the final completion handler
+                    handler_(std::span<std::byte>{
+                        const_cast<std::byte*>(payload->data()),
+                        payload->size()
+                    });
+                    return true;
                 }
 
                 using executor_type = boost::asio::associated_executor_t<
@@ -657,36 +1047,168 @@ private:
                 }
             };
 
-            socket.async_receive_from(boost::asio::buffer(buf), ulSource,
-                intermediate_completion_handler{
-                    socket, packager, buf, from, path, ulSource, hbhExt, e2eExt, scmpHandler,
-                    boost::asio::make_work_guard(socket.get_executor()),
-                    std::forward<decltype(completionHandler)>(completionHandler)
-                }
-            );
+            // The pending operation keeps the I/O context running, no work
+            // guard is needed. Operation state is allocated with the allocator
+            // associated with the completion handler, so the memory is recycled
+            // when the receive loop re-arms.
+            intermediate_completion_handler handler{
+                socket, packager, buf, from, path, ulSource, hbhExt, e2eExt, scmpHandler, gro,
+                std::forward<decltype(completionHandler)>(completionHandler)
+            };
+            if (!gro) {
+                socket.async_receive_from(boost::asio::buffer(buf), ulSource, std::move(handler));
+            } else if (gro->empty()) {
+                socket.async_wait(UnderlaySocket::wait_read, std::move(handler));
+            } else {
+                // consume remaining datagrams first
+                boost::asio::post(std::move(handler));
+            }
         };
 
+        auto gro = (groEnabled || !groSegments.empty()) ? &groSegments : nullptr;
         return boost::asio::async_initiate<
             CompletionToken, void(Maybe<std::span<std::byte>>)>
         (
             initiation, token,
             std::ref(socket), std::ref(packager), buf, from, path, std::ref(ulSource),
-            std::ref(hbhExt), std::ref(e2eExt), scmpHandler
+            std::ref(hbhExt), std::ref(e2eExt), scmpHandler, gro
         );
     }
 
+    /// \brief Receive and unpack all immediately available datagrams up to the
+    /// capacity of `results` without blocking.
+    /// \return Valid packets, which may be none if all received datagrams
+    /// were invalid. Returns `operation_would_block` if no datagrams were
+    /// available.
+    Maybe<std::span<ReceivedPacket<UnderlayEp>>> recvManyImpl(
+        std::span<std::byte> buf,
+        std::span<ReceivedPacket<UnderlayEp>> results)
+    {
+        auto count = std::min(results.size(), MAX_BATCH_SIZE);
+        if (count == 0 || buf.size() < count) return Error(ErrorCode::InvalidArgument);
+
+        auto scmpCallback = [this] (
+            const scion::Address<generic::IPAddress>& from,
+            const RawPathView& path,
+            const hdr::ScmpMessage& msg,
+            std::span<const std::byte> payload)
+        {
+            if (scmpHandler) scmpHandler->handleScmp(from, path, msg, payload);
+        };
+        std::size_t valid = 0;
+        auto unpack = [&] (std::span<std::byte> dgram, const UnderlayEp& ulSource) {
+            auto& pkt = results[valid];
+            auto payload = packager.template unpack<hdr::UDP>(dgram,
+                generic::toGenericAddr(ulSource.address()),
+                ext::NoExtensions, ext::NoExtensions, &pkt.from, &pkt.path, scmpCallback);
+            if (payload.has_value()) {
+                pkt.payload = std::span<std::byte>{
+                    const_cast<std::byte*>(payload->data()),
+                    payload->size()
+                };
+                pkt.packet = dgram;
+                pkt.ulSource = ulSource;
+                pkt.localAddr = packager.getLocalEp().getHost();
+                pkt.checksum = packager.getDeferredChecksum();
+                ++valid;
+            } else if (getError(payload) != ErrorCode::ScmpReceived) {
+                SCION_DEBUG_PRINT((std::format("Received invalid packet from {}: {}\n",
+                    ulSource, fmtError(getError(payload)))));
+            }
+        };
+
+        if (groEnabled || !groSegments.empty()) {
+            UnderlayEp ulSource;
+            if (groSegments.empty()) {
+                std::size_t segmentSize = 0;
+                auto recvd = recvGro(socket, buf, ulSource, segmentSize);
+                if (isError(recvd)) return propagateError(recvd);
+                groSegments.assign(get(recvd), segmentSize, ulSource);
+            }
+            while (valid < count && !groSegments.empty()) {
+                auto dgram = groSegments.next(ulSource);
+                unpack(dgram, ulSource);
+            }
+            return results.subspan(0, valid);
+        }
+
+        auto slotSize = buf.size() / count;
+    #if __linux__
+        std::array<iovec, MAX_BATCH_SIZE> vecs;
+        std::array<mmsghdr, MAX_BATCH_SIZE> msgs;
+        std::array<UnderlayEp, MAX_BATCH_SIZE> ulSources;
+        for (std::size_t i = 0; i < count; ++i) {
+            vecs[i] = iovec{
+                .iov_base = buf.data() + i * slotSize,
+                .iov_len = slotSize,
+            };
+            msgs[i].msg_hdr = msghdr{
+                .msg_name = ulSources[i].data(),
+                .msg_namelen = (socklen_t)ulSources[i].capacity(),
+                .msg_iov = &vecs[i],
+                .msg_iovlen = 1,
+                .msg_control = NULL,
+                .msg_controllen = 0,
+                .msg_flags = 0,
+            };
+            msgs[i].msg_len = 0;
+        }
+        int n = 0;
+        do {
+            n = ::recvmmsg(socket.native_handle(), msgs.data(), (unsigned int)count,
+                MSG_DONTWAIT, nullptr);
+        } while (n < 0 && errno == EINTR);
+        if (n < 0) return Error(bsd::details::getLastError());
+        for (int i = 0; i < n; ++i) {
+            if (msgs[i].msg_hdr.msg_flags & MSG_TRUNC) continue;
+            ulSources[i].resize(msgs[i].msg_hdr.msg_namelen);
+            unpack(buf.subspan(i * slotSize, msgs[i].msg_len), ulSources[i]);
+        }
+    #else
+        // Only receive datagrams that are already queued to avoid blocking.
+        std::size_t i = 0;
+        for (; i < count; ++i) {
+            boost::system::error_code ec;
+            if (socket.available(ec) == 0 || ec) break;
+            UnderlayEp ulSource;
+            auto slot = buf.subspan(i * slotSize, slotSize);
+            auto n = socket.receive_from(boost::asio::buffer(slot), ulSource, 0, ec);
+            if (ec) return Error(ec);
+            unpack(slot.subspan(0, n), ulSource);
+        }
+        if (i == 0) return Error(std::make_error_code(std::errc::operation_would_block));
+    #endif
+        return results.subspan(0, valid);
+    }
+
+    /// \brief Try to receive a possibly coalesced datagram without blocking.
+    static Maybe<std::span<std::byte>> recvGro(UnderlaySocket& socket,
+        std::span<std::byte> buf, UnderlayEp& ulSource, std::size_t& segmentSize)
+    {
+    #if __linux__
+        socklen_t addrLen = (socklen_t)ulSource.capacity();
+        auto n = bsd::details::recvmsgGro(socket.native_handle(), buf,
+            ulSource.data(), addrLen, segmentSize, MSG_DONTWAIT);
+        if (isError(n)) return propagateError(n);
+        ulSource.resize(addrLen);
+        return buf.subspan(0, get(n));
+    #else
+        return Error(ErrorCode::NotImplemented);
+    #endif
+    }
+
     template <ext::extension_range HbHExt, ext::extension_range E2EExt>
     Maybe<std::span<std::byte>> recvImpl(
         std::span<std::byte> buf,
         Endpoint* from,
-        RawPath* path,
+        RawPathOutput path,
         UnderlayEp& ulSource,
         HbHExt&& hbhExt,
         E2EExt&& e2eExt)
     {
         auto scmpCallback = [this] (
             const scion::Address<generic::IPAddress>& from,
-            const RawPath& path,
+            const RawPathView& path,
             const hdr::ScmpMessage& msg,
             std::span<const std::byte> payload)
         {
@@ -694,11 +1216,30 @@ private:
         };
         while (true) {
             using namespace boost::asio;
-            boost::system::error_code ec;
-            auto recvd = socket.receive_from(buffer(buf), ulSource, 0, ec);
-            if (ec) return Error(ec);
+            std::span<std::byte> dgram;
+            if (!groSegments.empty()) {
+                dgram = groSegments.next(ulSource);
+            } else if (groEnabled) {
+                std::size_t segmentSize = 0;
+                auto recvd = recvGro(socket, buf, ulSource, segmentSize);
+                if (isError(recvd)) {
+                    if (getError(recvd) != std::errc::operation_would_block || socket.non_blocking())
+                        return propagateError(recvd);
+                    boost::system::error_code ec;
+                    socket.wait(UnderlaySocket::wait_read, ec);
+                    if (ec) return Error(ec);
+                    continue;
+                }
+                groSegments.assign(get(recvd), segmentSize, ulSource);
+                dgram = groSegments.next(ulSource);
+            } else {
+                boost::system::error_code ec;
+                auto recvd = socket.receive_from(buffer(buf), ulSource, 0, ec);
+                if (ec) return Error(ec);
+                dgram = buf.subspan(0, recvd);
+            }
             auto payload = packager.template unpack<hdr::UDP>(
-                std::span<const std::byte>(buf.data(), recvd),
+                dgram,
                 generic::toGenericAddr(ulSource.address()),
                 std::forward<HbHExt>(hbhExt), std::forward<E2EExt>(e2eExt),
                 from, path, scmpCallback);
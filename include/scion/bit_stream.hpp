@@ -28,8 +28,10 @@
 #include <cassert>
 #include <concepts>
 #include <cstdint>
+#include <cstring>
 #include <format>
 #include <iostream>
+#include <memory>
 #include <ostream>
 #include <ranges>
 #include <source_location>
@@ -252,7 +254,12 @@ public:
 
         // read bytes as big endian
         std::uint64_t word = 0;
-        std::copy_n(byteIter, nBytes, reinterpret_cast<std::byte*>(&word));
+        if ((std::size_t)(data.end() - byteIter) >= sizeof(word)) [[likely]] {
+            // load a full word, excess bytes are shifted out below
+            std::memcpy(&word, std::to_address(byteIter), sizeof(word));
+        } else {
+            std::copy_n(byteIter, nBytes, reinterpret_cast<std::byte*>(&word));
+        }
         word = details::byteswapBE(word);
 
         word <<= bitPos; // shift out already read bits from first byte
@@ -289,17 +296,8 @@ public:
     template <std::unsigned_integral T, typename Error>
     bool serializeByte(T& value, Error& err)
     {
-        bool res = false;
-        std::uint32_t temp = 0;
-        if (bitPos != 0) {
-            res = serializeBits(temp, 8, err);
-        } else {
-            if (static_cast<std::size_t>(data.end() - byteIter) < 1)
-                return err.error("out of data to read");
-            std::copy_n(byteIter, 1, reinterpret_cast<std::byte*>(&temp));
-            byteIter += 1;
-            res = true;
-        }
+        std::uint8_t temp = 0;
+        bool res = bitPos == 0 ? loadAligned(temp, err) : serializeBits(temp, 8, err);
         value = static_cast<T>(temp);
         return res;
     }
@@ -307,36 +305,18 @@ public:
     template <std::integral T, typename Error>
     bool serializeUint16(T& value, Error& err)
     {
-        bool res = false;
-        std::uint32_t temp = 0;
-        if (bitPos != 0) {
-            res = serializeBits(temp, 16, err);
-        } else {
-            if (static_cast<std::size_t>(data.end() - byteIter) < 2)
-                return err.error("out of data to read");
-            std::copy_n(byteIter, 2, reinterpret_cast<std::byte*>(&temp));
-            byteIter += 2;
-            res = true;
-        }
-        value = details::byteswapBE(static_cast<T>(temp));
+        std::uint16_t temp = 0;
+        bool res = bitPos == 0 ? loadAligned(temp, err) : serializeBits(temp, 16, err);
+        value = static_cast<T>(temp);
         return res;
     }
 
     template <std::integral T, typename Error>
     bool serializeUint32(T& value, Error& err)
     {
-        bool res = false;
         std::uint32_t temp = 0;
-        if (bitPos != 0) {
-            res = serializeBits(temp, 32, err);
-        } else {
-            if (static_cast<std::size_t>(data.end() - byteIter) < 4)
-                return err.error("out of data to read");
-            std::copy_n(byteIter, 4, reinterpret_cast<std::byte*>(&temp));
-            byteIter += 4;
-            res = true;
-        }
-        value = details::byteswapBE(static_cast<T>(temp));
+        bool res = bitPos == 0 ? loadAligned(temp, err) : serializeBits(temp, 32, err);
+        value = static_cast<T>(temp);
         return res;
     }
 
@@ -344,12 +324,18 @@ public:
     bool serializeUint64(T& value, Error& err)
     {
         std::uint64_t temp = 0;
-        if (bitPos != 0) return err.error("not implemented");
-        if (static_cast<std::size_t>(data.end() - byteIter) < 8)
-            return err.error("out of data to read");
-        std::copy_n(byteIter, 8, reinterpret_cast<std::byte*>(&temp));
-        byteIter += 8;
-        value = details::byteswapBE(static_cast<T>(temp));
+        if (bitPos == 0) [[likely]] {
+            if (!loadAligned(temp, err)) return false;
+        } else {
+            // serializeBits() is limited to 57 bits
+            if (static_cast<std::size_t>(data.end() - byteIter) <= sizeof(temp))
+                return err.error("out of data to read");
+            std::uint32_t hi = 0, lo = 0;
+            (void)serializeBits(hi, 32, err);
+            (void)serializeBits(lo, 32, err);
+            temp = (static_cast<std::uint64_t>(hi) << 32) | lo;
+        }
+        value = static_cast<T>(temp);
         return true;
     }
 
@@ -363,6 +349,19 @@ public:
         byteIter += bytes.size();
         return true;
     }
+
+private:
+    // Read a big-endian integer from a byte boundary.
+    template <std::unsigned_integral T, typename Error>
+    bool loadAligned(T& value, Error& err)
+    {
+        if (static_cast<std::size_t>(data.end() - byteIter) < sizeof(T))
+            return err.error("out of data to read");
+        std::memcpy(&value, std::to_address(byteIter), sizeof(T));
+        value = details::byteswapBE(value);
+        byteIter += sizeof(T);
+        return true;
+    }
 };
 
 } // namespace scion
@@ -489,7 +488,7 @@ public:
         }
 
         word = details::byteswapBE(word);
-        std::copy_n(reinterpret_cast<std::byte*>(&word), nBytes, byteIter);
+        storeBytes(std::to_address(byteIter), word, nBytes);
 
         byteIter += (bitPos + bits) / 8;
         bitPos = (bitPos + bits) % 8;
@@ -521,55 +520,33 @@ public:
     template <typename Error>
     bool serializeByte(std::uint8_t value, Error& err)
     {
-        if (bitPos != 0) {
-            return serializeBits(value, 8, err);
-        } else {
-            if (static_cast<std::size_t>(data.end() - byteIter) < sizeof(value))
-                return err.error("out of space");
-            byteIter = std::copy_n(reinterpret_cast<std::byte*>(&value), sizeof(value), byteIter);
-            return true;
-        }
+        if (bitPos == 0) [[likely]] return storeAligned(value, err);
+        return serializeBits(value, 8, err);
     }
 
     template <typename Error>
     bool serializeUint16(std::uint16_t value, Error& err)
     {
-        value = details::byteswapBE(value);
-        if (bitPos != 0) {
-            return serializeBits(value, 16, err);
-        } else {
-            if (static_cast<std::size_t>(data.end() - byteIter) < sizeof(value))
-                return err.error("out of space");
-            byteIter = std::copy_n(reinterpret_cast<std::byte*>(&value), sizeof(value), byteIter);
-        }
-        return true;
+        if (bitPos == 0) [[likely]] return storeAligned(value, err);
+        return serializeBits(value, 16, err);
     }
 
     template <typename Error>
     bool serializeUint32(std::uint32_t value, Error& err)
     {
-        value = details::byteswapBE(value);
-        if (bitPos != 0) {
-            return serializeBits(value, 32, err);
-        } else {
-            if (static_cast<std::size_t>(data.end() - byteIter) < sizeof(value))
-                return err.error("out of space");
-            byteIter = std::copy_n(reinterpret_cast<std::byte*>(&value), sizeof(value), byteIter);
-        }
-        return true;
+        if (bitPos == 0) [[likely]] return storeAligned(value, err);
+        return serializeBits(value, 32, err);
     }
 
     template <typename Error>
     bool serializeUint64(std::uint64_t value, Error& err)
     {
-        value = details::byteswapBE(value);
-        if (bitPos != 0) {
-            return serializeBits(value, 32, err);
-        } else {
-            if (static_cast<std::size_t>(data.end() - byteIter) < sizeof(value))
-                return err.error("out of space");
-            byteIter = std::copy_n(reinterpret_cast<std::byte*>(&value), sizeof(value), byteIter);
-        }
+        if (bitPos == 0) [[likely]] return storeAligned(value, err);
+        // serializeBits() is limited to 57 bits
+        if (static_cast<std::size_t>(data.end() - byteIter) <= sizeof(value))
+            return err.error("out of space");
+        (void)serializeBits(static_cast<std::uint32_t>(value >> 32), 32, err);
+        (void)serializeBits(static_cast<std::uint32_t>(value), 32, err);
         return true;
     }
 
@@ -582,6 +559,36 @@ public:
         byteIter = std::copy(bytes.begin(), bytes.end(), byteIter);
         return true;
     }
+
+private:
+    // Copy the first n bytes of word to dst. Unlike std::copy_n, which becomes
+    // a call to memcpy for variable lengths, all cases are fixed-size stores.
+    static void storeBytes(std::byte* dst, std::uint64_t word, std::size_t n)
+    {
+        auto src = reinterpret_cast<const std::byte*>(&word);
+        switch (n) {
+        case 1: std::memcpy(dst, src, 1); break;
+        case 2: std::memcpy(dst, src, 2); break;
+        case 3: std::memcpy(dst, src, 3); break;
+        case 4: std::memcpy(dst, src, 4); break;
+        case 5: std::memcpy(dst, src, 5); break;
+        case 6: std::memcpy(dst, src, 6); break;
+        case 7: std::memcpy(dst, src, 7); break;
+        case 8: std::memcpy(dst, src, 8); break;
+        }
+    }
+
+    // Write a big-endian integer at a byte boundary.
+    template <std::unsigned_integral T, typename Error>
+    bool storeAligned(T value, Error& err)
+    {
+        if (static_cast<std::size_t>(data.end() - byteIter) < sizeof(T))
+            return err.error("out of space");
+        value = details::byteswapBE(value);
+        std::memcpy(std::to_address(byteIter), &value, sizeof(T));
+        byteIter += sizeof(T);
+        return true;
+    }
 };
 
 } // namespace scion
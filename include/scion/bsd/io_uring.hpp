@@ -0,0 +1,375 @@
+// Copyright (c) 2024-2025 Lars-Christian Schulz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "scion/bsd/socket.hpp"
+
+#if __linux__
+#include <sys/socket.h>
+#include <sys/time.h>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <optional>
+#include <span>
+
+
+#if __linux__
+namespace scion {
+namespace bsd {
+namespace details {
+
+/// \brief Minimal io_uring instance for receiving datagrams from a single
+/// socket with a multishot recvmsg operation into a ring of provided buffers.
+class IoUring
+{
+public:
+    /// \brief A datagram received into one of the provided buffers. The spans
+    /// remain valid until the buffer is returned with release().
+    struct Completion
+    {
+        unsigned bufferId;
+        std::span<const std::byte> name;
+        std::span<const std::byte> control;
+        std::span<const std::byte> payload;
+        bool truncated;
+    };
+
+private:
+    int ringFd = -1;
+    NativeHandle sockFd = INVALID_SOCKET_VALUE;
+    bool armed = false;
+    unsigned toSubmit = 0;
+
+    // Submission and completion queues
+    void* ringMem = nullptr;
+    std::size_t ringMemSize = 0;
+    void* sqeMem = nullptr;
+    std::size_t sqeMemSize = 0;
+    unsigned* sqTail = nullptr;
+    unsigned* sqMask = nullptr;
+    unsigned* sqArray = nullptr;
+    unsigned* cqHead = nullptr;
+    unsigned* cqTail = nullptr;
+    unsigned* cqMask = nullptr;
+    void* cqes = nullptr;
+
+    // Provided buffers
+    void* bufRing = nullptr;
+    std::size_t bufRingSize = 0;
+    std::byte* buffers = nullptr;
+    std::size_t buffersSize = 0;
+    std::size_t bufCount = 0;
+    std::size_t bufSize = 0;
+    std::uint16_t bufTail = 0;
+
+    msghdr recvHdr = {};
+
+public:
+    IoUring() = default;
+    IoUring(const IoUring&) = delete;
+    IoUring& operator=(const IoUring&) = delete;
+    ~IoUring();
+
+    /// \brief Create the ring and register the provided buffers.
+    /// \param fd Socket to receive from.
+    /// \param nameLen Maximum length of the source address.
+    /// \param controlLen Space reserved for ancillary data.
+    /// \param entries Number of submission queue entries.
+    /// \param count Number of provided buffers. Must be a power of two.
+    /// \param size Size of each provided buffer.
+    std::error_code init(NativeHandle fd, socklen_t nameLen, std::size_t controlLen,
+        unsigned entries, std::size_t count, std::size_t size);
+
+    /// \brief Submit the multishot receive operation, so that datagrams are
+    /// received before the first call to receive().
+    /// \return An error if the kernel rejects the operation immediately, e.g.,
+    /// because it does not support multishot recvmsg.
+    std::error_code arm();
+
+    /// \brief Get the ring's file descriptor. It becomes readable when
+    /// completions are available and can be polled by an event loop.
+    int getNativeHandle() const { return ringFd; }
+
+    /// \brief Get the next received datagram. Rearms the multishot receive
+    /// operation as needed.
+    /// \param block Whether to wait for a datagram if none is available.
+    /// \param timeout Optional timeout for blocking waits.
+    Maybe<Completion> receive(bool block, std::optional<std::chrono::microseconds> timeout);
+
+    /// \brief Return a buffer obtained from receive() to the kernel.
+    void release(unsigned bufferId);
+
+private:
+    void armRecv();
+    std::error_code enter(unsigned minComplete,
+        std::optional<std::chrono::microseconds> timeout);
+};
+
+} // namespace details
+
+/// \brief Datagram socket underlay that receives through io_uring. Can be used
+/// in place of BSDSocket as underlay of the SCION sockets in the bsd namespace.
+///
+/// Received datagrams are written by a single multishot recvmsg operation into
+/// a ring of `BufferCount` kernel-provided buffers of `BufferSize` bytes each
+/// and copied into the receive buffers of the caller. Hence, a system call is
+/// only required when the completion queue has run empty. Sending is
+/// synchronous and uses the regular socket calls, as the caller expects to
+/// reuse its buffers immediately.
+/// \tparam T A sockaddr, like sockaddr_in or sockaddr_in6.
+/// \tparam BufferSize Size of each receive buffer. Must be large enough for
+/// the largest expected datagram plus about 100 bytes of metadata.
+/// \tparam BufferCount Number of receive buffers. Must be a power of two.
+template <
+    typename T = IPEndpoint,
+    std::size_t BufferSize = 2048,
+    std::size_t BufferCount = 256>
+class IoUringSocket
+{
+public:
+    static_assert((BufferCount & (BufferCount - 1)) == 0 && BufferCount <= 32768);
+    using SockAddr = T;
+    static constexpr std::size_t MAX_BATCH_SIZE = BSDSocket<T>::MAX_BATCH_SIZE;
+    static constexpr std::size_t MAX_GSO_SEGMENTS = BSDSocket<T>::MAX_GSO_SEGMENTS;
+    static constexpr std::size_t MAX_GSO_SIZE = BSDSocket<T>::MAX_GSO_SIZE;
+
+    /// \brief Number of submission queue entries.
+    static constexpr unsigned RING_ENTRIES = 8;
+
+private:
+    static constexpr std::size_t CONTROL_LEN = CMSG_SPACE(sizeof(int));
+
+    BSDSocket<T> socket;
+    std::unique_ptr<details::IoUring> ring;
+    bool nonblocking = false;
+    std::optional<std::chrono::microseconds> recvTimeout;
+
+public:
+    bool isOpen() const { return socket.isOpen(); }
+
+    NativeHandle getNativeHandle() { return socket.getNativeHandle(); }
+
+    /// \brief Get the file descriptor of the io_uring instance. Valid once
+    /// the socket is bound. Becomes readable when datagrams are available, so
+    /// that it can be polled by an event loop before calling one of the
+    /// receive methods.
+    int getRingHandle() const { return ring ? ring->getNativeHandle() : -1; }
+
+    /// \copydoc BSDSocket::setReusePort()
+    void setReusePort(bool reuse) { socket.setReusePort(reuse); }
+
+    /// \brief Bind the socket and set up the io_uring instance. Fails if
+    /// io_uring or the required features are not available.
+    std::error_code bind(const SockAddr& addr)
+    {
+        auto ec = socket.bind(addr);
+        if (ec) return ec;
+        return setupRing();
+    }
+
+    /// \copydoc bind()
+    std::error_code bind_range(
+        const SockAddr& addr, std::uint16_t firstPort, std::uint16_t lastPort)
+    {
+        auto ec = socket.bind_range(addr, firstPort, lastPort);
+        if (ec) return ec;
+        return setupRing();
+    }
+
+    std::error_code connect(const SockAddr& addr)
+    {
+        return socket.connect(addr);
+    }
+
+    void close()
+    {
+        ring.reset();
+        socket.close();
+    }
+
+    std::error_code setNonblocking(bool nonblocking)
+    {
+        auto ec = socket.setNonblocking(nonblocking);
+        if (!ec) this->nonblocking = nonblocking;
+        return ec;
+    }
+
+    Maybe<SockAddr> getsockname() const
+    {
+        return socket.getsockname();
+    }
+
+    std::error_code getsockopt(int level, int optname, void* optval, socklen_t* optlen)
+    {
+        return socket.getsockopt(level, optname, optval, optlen);
+    }
+
+    /// \brief Set a socket option. Receive timeouts (SO_RCVTIMEO) are applied
+    /// to waits on the completion queue as well.
+    std::error_code setsockopt(int level, int optname, const void* optval, socklen_t optlen)
+    {
+        auto ec = socket.setsockopt(level, optname, optval, optlen);
+        if (ec) return ec;
+        if (level == SOL_SOCKET && optname == SO_RCVTIMEO && optlen >= sizeof(timeval)) {
+            timeval t;
+            std::memcpy(&t, optval, sizeof(t));
+            auto timeout = std::chrono::seconds(t.tv_sec) + std::chrono::microseconds(t.tv_usec);
+            if (timeout.count() > 0) recvTimeout = timeout;
+            else recvTimeout.reset();
+        }
+        return ec;
+    }
+
+    Maybe<std::span<const std::byte>> send(std::span<const std::byte> buf, int flags = 0)
+    {
+        return socket.send(buf, flags);
+    }
+
+    Maybe<std::span<const std::byte>> sendto(
+        std::span<const std::byte> buf, const SockAddr& to, int flags = 0)
+    {
+        return socket.sendto(buf, to, flags);
+    }
+
+    template <std::convertible_to<std::span<const std::byte>>... Buffers>
+    Maybe<ssize_t> sendmsg(const SockAddr& to, int flags, Buffers&&... bufs)
+    {
+        return socket.sendmsg(to, flags, std::forward<Buffers>(bufs)...);
+    }
+
+    template <std::size_t N>
+    Maybe<std::size_t> sendmmsg(
+        std::span<const std::array<std::span<const std::byte>, N>> bufs,
+        std::span<const SockAddr> to, int flags = 0)
+    {
+        return socket.sendmmsg(bufs, to, flags);
+    }
+
+    Maybe<std::size_t> sendGso(std::span<const std::byte> buf,
+        const SockAddr& to, std::uint16_t segmentSize, int flags = 0)
+    {
+        return socket.sendGso(buf, to, segmentSize, flags);
+    }
+
+    /// \brief Receive a datagram. The only supported flag is MSG_DONTWAIT.
+    Maybe<std::span<std::byte>> recv(std::span<std::byte> buf, int flags = 0)
+    {
+        SockAddr from;
+        return recvfrom(buf, from, flags);
+    }
+
+    /// \copydoc recv()
+    Maybe<std::span<std::byte>> recvfrom(std::span<std::byte> buf, SockAddr& from, int flags = 0)
+    {
+        auto c = receive(flags);
+        if (isError(c)) return propagateError(c);
+        return complete(*c, buf, from);
+    }
+
+    /// \copydoc BSDSocket::recvfromGro()
+    Maybe<std::span<std::byte>> recvfromGro(std::span<std::byte> buf, SockAddr& from,
+        std::size_t& segmentSize, int flags = 0)
+    {
+        auto c = receive(flags);
+        if (isError(c)) return propagateError(c);
+        segmentSize = 0;
+        msghdr hdr = {};
+        hdr.msg_control = const_cast<std::byte*>(c->control.data());
+        hdr.msg_controllen = c->control.size();
+        for (auto cmsg = CMSG_FIRSTHDR(&hdr); cmsg; cmsg = CMSG_NXTHDR(&hdr, cmsg)) {
+            if (cmsg->cmsg_level == SOL_UDP && cmsg->cmsg_type == UDP_GRO) {
+                int gsoSize = 0;
+                std::memcpy(&gsoSize, CMSG_DATA(cmsg), sizeof(gsoSize));
+                segmentSize = (std::size_t)gsoSize;
+            }
+        }
+        return complete(*c, buf, from);
+    }
+
+    /// \copydoc BSDSocket::recvmmsg()
+    Maybe<std::size_t> recvmmsg(
+        std::span<std::span<std::byte>> bufs, std::span<SockAddr> from, int flags = 0)
+    {
+        auto count = std::min({bufs.size(), from.size(), MAX_BATCH_SIZE});
+        if (count == 0) return Error(ErrorCode::InvalidArgument);
+        std::size_t n = 0;
+        for (; n < count; ++n) {
+            auto c = receive(n == 0 ? flags : (flags | MSG_DONTWAIT));
+            if (isError(c)) {
+                if (n > 0) break;
+                return propagateError(c);
+            }
+            auto recvd = complete(*c, bufs[n], from[n]);
+            if (isError(recvd)) {
+                if (getError(recvd) != ErrorCode::BufferTooSmall) return propagateError(recvd);
+                bufs[n] = std::span<std::byte>();
+            } else {
+                bufs[n] = get(recvd);
+            }
+        }
+        return n;
+    }
+
+private:
+    Maybe<details::IoUring::Completion> receive(int flags)
+    {
+        if ((flags & ~MSG_DONTWAIT) != 0) return Error(ErrorCode::NotImplemented);
+        if (!ring) {
+            if (auto ec = setupRing(); ec) return Error(ec);
+        }
+        bool block = !nonblocking && !(flags & MSG_DONTWAIT);
+        return ring->receive(block, recvTimeout);
+    }
+
+    std::error_code setupRing()
+    {
+        auto r = std::make_unique<details::IoUring>();
+        auto ec = r->init(socket.getNativeHandle(), sizeof(SockAddr), CONTROL_LEN,
+            RING_ENTRIES, BufferCount, BufferSize);
+        if (ec) return ec;
+        ec = r->arm();
+        if (ec) return ec;
+        ring = std::move(r);
+        return ErrorCode::Ok;
+    }
+
+    Maybe<std::span<std::byte>> complete(
+        const details::IoUring::Completion& c, std::span<std::byte> buf, SockAddr& from)
+    {
+        std::memcpy(&from, c.name.data(), std::min(c.name.size(), sizeof(from)));
+        if (c.truncated || c.payload.size() > buf.size()) {
+            ring->release(c.bufferId);
+            return Error(ErrorCode::BufferTooSmall);
+        }
+        std::ranges::copy(c.payload, buf.begin());
+        ring->release(c.bufferId);
+        return buf.first(c.payload.size());
+    }
+};
+
+} // namespace bsd
+} // namespace scion
+#endif // __linux__
@@ -48,13 +48,31 @@ public:
     using Address = scion::Address<generic::IPAddress>;
 
 protected:
+    /// \brief Whether the underlay can report the destination address of
+    /// received datagrams and select the source address of sent datagrams.
+    static constexpr bool HAS_PKTINFO = requires(Underlay& s, std::span<std::byte> buf,
+        UnderlayEp& ep, generic::IPAddress& addr, std::size_t& segmentSize)
+    {
+        s.recvfromTo(buf, ep, addr, segmentSize);
+        s.sendmsgFrom(ep, addr, 0, buf);
+    };
+
     Underlay socket;
     ScionPackager packager;
+    // Underlay socket is bound to a wildcard address and receives the
+    // destination address of each datagram.
+    bool wildcard = false;
 
 public:
     /// \brief Bind to a local endpoint.
-    /// \warning Wildcard IP addresses are not well supported and should be
-    /// avoided. Unspecified ISD-ASN and port are supported.
+    ///
+    /// If the IP address is unspecified, the socket accepts packets sent to
+    /// any local address on Linux. The address of the default interface
+    /// becomes the source address of sent packets, unless a different one is
+    /// given explicitly, e.g., to reply from the address a request was
+    /// received on. On other platforms, wildcard IP addresses are not well
+    /// supported and should be avoided. Unspecified ISD-ASN and port are
+    /// supported.
     std::error_code bind(const Endpoint& ep)
     {
         return bind(ep, 0, 65535);
@@ -62,8 +80,7 @@ public:
 
     /// \brief Bind to a local endpoint. If no port is specified, try to pick
     /// one from the range [`firstPort`, `lastPort`].
-    /// \warning Wildcard IP addresses are not well supported and should be
-    /// avoided. Unspecified ISD-ASN and port are supported.
+    /// \copydetails bind(const Endpoint&)
     std::error_code bind(
         const Endpoint& ep, std::uint16_t firstPort, std::uint16_t lastPort)
     {
@@ -73,6 +90,22 @@ public:
         auto err = socket.bind_range(*underlayEp, firstPort, lastPort);
         if (err) return err;
 
+        // Receive destination addresses on wildcard sockets
+        wildcard = false;
+        if constexpr (HAS_PKTINFO) {
+        #if __linux__
+            if (ep.getHost().isUnspecified()) {
+                int value = 1;
+                if (ep.getHost().is4())
+                    err = socket.setsockopt(IPPROTO_IP, IP_PKTINFO, &value, sizeof(value));
+                else
+                    err = socket.setsockopt(IPPROTO_IPV6, IPV6_RECVPKTINFO, &value, sizeof(value));
+                wildcard = !err;
+            }
+        #endif
+        }
+        packager.setWildcardLocal(wildcard);
+
         // Find local address for SCION layer
         auto local = details::findLocalAddress(socket);
         if (isError(local)) return getError(local);
@@ -102,6 +135,9 @@ public:
     /// \brief Get the native handle of the underlay socket.
     NativeHandle getNativeHandle() { return socket.getNativeHandle(); }
 
+    /// \brief Get the underlay socket, e.g., to configure it before binding.
+    Underlay& getUnderlay() { return socket; }
+
     /// \brief Returns the full address of the socket.
     Endpoint getLocalEp() const { return packager.getLocalEp(); }
 
@@ -112,6 +148,20 @@ public:
     /// \brief Returns the current traffic class.
     std::uint8_t getTrafficClass() const { return packager.getTrafficClass(); }
 
+    /// \copydoc ScionPackager::setChecksumPolicy()
+    std::error_code setChecksumPolicy(ChecksumPolicy policy, std::uint32_t interval = 1)
+    {
+        return packager.setChecksumPolicy(policy, interval);
+    }
+
+    /// \brief Returns the current checksum verification policy.
+    ChecksumPolicy getChecksumPolicy() const { return packager.getChecksumPolicy(); }
+
+    /// \brief Returns the checksum of the last received packet if the
+    /// checksum policy is ChecksumPolicy::Defer. Call `verify()` on the result
+    /// with the received payload before consuming it.
+    DeferredChecksum getDeferredChecksum() const { return packager.getDeferredChecksum(); }
+
     /// \copydoc BSDSocket::setNonblocking()
     std::error_code setNonblocking(bool nonblocking)
     {
@@ -169,11 +219,11 @@ public:
     Maybe<std::span<std::byte>> recvScmpFromVia(
         std::span<std::byte> buf,
         Endpoint& from,
-        RawPath& path,
+        RawPathOutput path,
         UnderlayEp& ulSource,
         hdr::ScmpMessage& message)
     {
-        return recvScmpImpl(buf, &from, &path, ulSource,
+        return recvScmpImpl(buf, &from, path, ulSource,
             ext::NoExtensions, ext::NoExtensions, message);
     }
 
@@ -181,13 +231,13 @@ public:
     Maybe<std::span<std::byte>> recvScmpFromViaExt(
         std::span<std::byte> buf,
         Endpoint& from,
-        RawPath& path,
+        RawPathOutput path,
         UnderlayEp& ulSource,
         HbHExt&& hbhExt,
         E2EExt&& e2eExt,
         hdr::ScmpMessage& message)
     {
-        return recvScmpImpl(buf, &from, &path, ulSource,
+        return recvScmpImpl(buf, &from, path, ulSource,
             std::forward<HbHExt>(hbhExt), std::forward<E2EExt>(e2eExt), message);
     }
 
@@ -196,14 +246,14 @@ private:
     Maybe<std::span<std::byte>> recvScmpImpl(
         std::span<std::byte> buf,
         Endpoint* from,
-        RawPath* path,
+        RawPathOutput path,
         UnderlayEp& ulSource,
         HbHExt&& hbhExt,
         E2EExt&& e2eExt,
         hdr::ScmpMessage& message)
     {
         std::span<std::byte> payload;
-        auto scmp = [&] (const Address& from, const RawPath& path,
+        auto scmp = [&] (const Address& from, const RawPathView& path,
             const hdr::ScmpMessage& msg, std::span<const std::byte> data)
         {
             message = msg;
@@ -214,10 +264,12 @@ private:
         };
 
         while (true) {
-            auto recvd = socket.recvfrom(buf, ulSource);
+            generic::IPAddress ulDest;
+            auto recvd = recvUnderlay(buf, ulSource, ulDest);
             if (isError(recvd)) return propagateError(recvd);
             auto decoded = packager.unpack<hdr::UDP>(get(recvd),
                 generic::toGenericAddr(EndpointTraits<UnderlayEp>::getHost(ulSource)),
+                wildcard ? &ulDest : nullptr,
                 std::forward<HbHExt>(hbhExt), std::forward<E2EExt>(e2eExt), from, path, scmp);
             if (isError(decoded) && getError(decoded) == ErrorCode::ScmpReceived) {
                 return payload;
@@ -226,17 +278,68 @@ private:
     }
 
 protected:
+    /// \brief Receive a single underlay datagram. On wildcard sockets,
+    /// `ulDest` receives the datagram's destination address.
+    Maybe<std::span<std::byte>> recvUnderlay(
+        std::span<std::byte> buf, UnderlayEp& ulSource, generic::IPAddress& ulDest)
+    {
+        if constexpr (HAS_PKTINFO) {
+            if (wildcard) {
+                std::size_t segmentSize = 0;
+                return socket.recvfromTo(buf, ulSource, ulDest, segmentSize);
+            }
+        }
+        return socket.recvfrom(buf, ulSource);
+    }
+
+    /// \brief Send a packet on the underlay. On wildcard sockets, the
+    /// underlay source address is `src` if given or the default local host
+    /// address otherwise, so that it matches the SCION source address.
     Maybe<std::span<const std::byte>> sendUnderlay(
         std::span<const std::byte> headers,
         std::span<const std::byte> payload,
-        const UnderlayEp& nextHop)
+        const UnderlayEp& nextHop,
+        const generic::IPAddress* src = nullptr)
     {
-        auto sent = socket.sendmsg(nextHop, 0, headers, payload);
+        auto sent = [&] {
+            if constexpr (HAS_PKTINFO) {
+                if (wildcard) {
+                    auto host = src ? *src : packager.getLocalEp().getHost();
+                    return socket.sendmsgFrom(nextHop, host, 0, headers, payload);
+                }
+            }
+            return socket.sendmsg(nextHop, 0, headers, payload);
+        }();
         if (isError(sent)) return propagateError(sent);
         auto n = get(sent) - (std::uint64_t)headers.size();
         if (n < 0) return Error(ErrorCode::PacketTooBig);
         return payload.subspan(0, n);
     }
+
+    /// \brief Send a packet stored in a single contiguous buffer.
+    /// \param packet Headers immediately followed by the payload.
+    /// \param hdrSize Size of the headers at the beginning of `packet`.
+    /// \return The part of the payload that was sent.
+    Maybe<std::span<const std::byte>> sendUnderlay(
+        std::span<const std::byte> packet,
+        std::size_t hdrSize,
+        const UnderlayEp& nextHop,
+        const generic::IPAddress* src = nullptr)
+    {
+        auto sent = [&] {
+            if constexpr (HAS_PKTINFO) {
+                if (wildcard) {
+                    auto host = src ? *src : packager.getLocalEp().getHost();
+                    return socket.sendmsgFrom(nextHop, host, 0, packet);
+                }
+            }
+            return socket.sendmsg(nextHop, 0, packet);
+        }();
+        if (isError(sent)) return propagateError(sent);
+        auto n = get(sent) - (std::int64_t)hdrSize;
+        if (n < 0) return Error(ErrorCode::PacketTooBig);
+        return packet.subspan(hdrSize, n);
+    }
 };
 
 } // namespace bsd
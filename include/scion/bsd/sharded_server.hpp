@@ -0,0 +1,167 @@
+// Copyright (c) 2024-2025 Lars-Christian Schulz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "scion/bsd/socket.hpp"
+#include "scion/bsd/udp_socket.hpp"
+
+#include <algorithm>
+#include <concepts>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+
+#if __linux__
+namespace scion {
+namespace bsd {
+namespace details {
+
+/// \brief Get the CPUs the calling thread is allowed to run on.
+std::vector<unsigned> getAllowedCpus();
+
+/// \brief Pin the calling thread to a single CPU.
+std::error_code pinThisThread(unsigned cpu);
+
+/// \brief Attach a reuseport program to the group of sockets bound to the same
+/// address as `handle` that selects the socket by the flow ID in the SCION
+/// common header. The sockets are indexed in the order they were bound.
+/// \param groupSize Number of sockets in the group.
+std::error_code attachFlowSteering(NativeHandle handle, std::uint32_t groupSize);
+
+/// \brief Bind one socket per shard to the same endpoint with SO_REUSEPORT.
+/// If the endpoint has no port, the port chosen for the first shard is used
+/// for all others.
+/// \param bindShard Called with the shard index and the endpoint to bind.
+/// Must return the bound endpoint or an error.
+template <typename Endpoint, typename BindShard>
+std::error_code bindShards(const Endpoint& ep, std::size_t count, BindShard&& bindShard)
+{
+    auto bindEp = ep;
+    for (std::size_t i = 0; i < count; ++i) {
+        auto bound = bindShard(i, bindEp);
+        if (isError(bound)) return getError(bound);
+        if (i == 0) {
+            bindEp = Endpoint(ep.getIsdAsn(), ep.getHost(), bound->getPort());
+        }
+    }
+    return ErrorCode::Ok;
+}
+
+} // namespace details
+
+/// \brief Server that receives on one SCION endpoint from multiple threads.
+///
+/// Opens one socket per shard, all bound to the same endpoint with
+/// SO_REUSEPORT, so that the kernel distributes incoming datagrams between
+/// them. Each shard's receive loop runs on its own thread pinned to a
+/// different CPU.
+///
+/// By default, the kernel selects the socket by a hash of the underlay
+/// addresses and ports. Since most datagrams arrive from the same border
+/// router, the server can instead steer datagrams by the flow ID of the SCION
+/// header. The flow ID is derived from the SCION addresses and L4 ports of a
+/// flow, so all datagrams of one flow are received by the same shard.
+///
+/// \tparam Socket A SCION socket from the bsd namespace, like UDPSocket. Its
+/// underlay must support SO_REUSEPORT.
+template <typename Socket = UDPSocket<>>
+class ShardedUDPServer
+{
+public:
+    using Endpoint = typename Socket::Endpoint;
+
+private:
+    std::vector<std::unique_ptr<Socket>> shards;
+    std::vector<unsigned> cpus;
+
+public:
+    /// \brief Open and bind the shards.
+    /// \param ep Local endpoint to bind to. If no port is given, a free port
+    /// is chosen.
+    /// \param count Number of shards. Defaults to one shard per CPU the
+    /// calling thread is allowed to run on.
+    /// \param steerByFlow Distribute datagrams by their SCION flow ID instead
+    /// of the underlay addresses.
+    std::error_code bind(const Endpoint& ep, std::size_t count = 0, bool steerByFlow = true)
+    {
+        if (!shards.empty()) return ErrorCode::LogicError;
+        cpus = details::getAllowedCpus();
+        if (count == 0) count = std::max<std::size_t>(cpus.size(), 1);
+
+        shards.reserve(count);
+        auto ec = details::bindShards(ep, count,
+            [this] (std::size_t, const Endpoint& ep) -> Maybe<Endpoint> {
+                auto& s = shards.emplace_back(std::make_unique<Socket>());
+                s->getUnderlay().setReusePort(true);
+                if (auto ec = s->bind(ep); ec) return Error(ec);
+                return s->getLocalEp();
+            });
+        if (!ec && steerByFlow)
+            ec = details::attachFlowSteering(shards.front()->getNativeHandle(), (std::uint32_t)count);
+        if (ec) close();
+        return ec;
+    }
+
+    /// \brief Close all shards. Receive loops blocked on a shard may not
+    /// return until their socket's receive timeout expires.
+    void close()
+    {
+        for (auto& s : shards) s->close();
+        shards.clear();
+    }
+
+    /// \brief Number of shards.
+    std::size_t size() const { return shards.size(); }
+
+    /// \brief Access the socket of a shard.
+    Socket& operator[](std::size_t i) { return *shards[i]; }
+
+    /// \brief Returns the local endpoint all shards are bound to.
+    Endpoint getLocalEp() const
+    {
+        return shards.empty() ? Endpoint() : shards.front()->getLocalEp();
+    }
+
+    /// \brief Run a receive loop on every shard. Each loop runs on its own
+    /// thread, pinned to one of the CPUs available when the server was bound.
+    /// Pinning is best effort, failure to pin a thread is ignored.
+    /// \param handler Called with the shard index and socket. Returns when
+    /// the handlers of all shards have returned.
+    template <std::invocable<std::size_t, Socket&> Handler>
+    void run(Handler&& handler)
+    {
+        std::vector<std::thread> threads;
+        threads.reserve(shards.size());
+        for (std::size_t i = 0; i < shards.size(); ++i) {
+            threads.emplace_back([this, i, &handler] {
+                if (!cpus.empty()) details::pinThisThread(cpus[i % cpus.size()]);
+                handler(i, *shards[i]);
+            });
+        }
+        for (auto& t : threads) t.join();
+    }
+};
+
+} // namespace bsd
+} // namespace scion
+#endif // __linux__
@@ -27,14 +27,17 @@
 #include <unistd.h>
 #include <sys/socket.h>
 #include <netinet/in.h>
+#include <netinet/udp.h>
 #include <netdb.h>
 #include <fcntl.h>
 #elif _WIN32
 #include <Winsock2.h>
 #endif
 
+#include <algorithm>
 #include <array>
 #include <cstdint>
+#include <cstring>
 #include <optional>
 #include <span>
 
@@ -59,6 +62,109 @@ inline std::error_code getLastError()
     return std::error_code(errno, std::system_category());
 #endif
 }
+
+#if __linux__
+/// \brief Space for the ancillary data returned by recvmsgGro().
+constexpr std::size_t RECV_CONTROL_LEN = CMSG_SPACE(sizeof(int)) + CMSG_SPACE(sizeof(in6_pktinfo));
+
+/// \brief Get the destination address of a received datagram from an
+/// IP_PKTINFO or IPV6_PKTINFO control message.
+/// \return Whether a destination address was found.
+inline bool parsePktInfo(msghdr& hdr, generic::IPAddress& dst)
+{
+    for (auto cmsg = CMSG_FIRSTHDR(&hdr); cmsg; cmsg = CMSG_NXTHDR(&hdr, cmsg)) {
+        if (cmsg->cmsg_level == IPPROTO_IP && cmsg->cmsg_type == IP_PKTINFO) {
+            in_pktinfo info;
+            std::memcpy(&info, CMSG_DATA(cmsg), sizeof(info));
+            dst = generic::toGenericAddr(info.ipi_addr);
+            return true;
+        } else if (cmsg->cmsg_level == IPPROTO_IPV6 && cmsg->cmsg_type == IPV6_PKTINFO) {
+            in6_pktinfo info;
+            std::memcpy(&info, CMSG_DATA(cmsg), sizeof(info));
+            dst = generic::toGenericAddr(info.ipi6_addr).unmap4in6();
+            return true;
+        }
+    }
+    return false;
+}
+
+/// \brief Write a control message selecting the source address of a datagram
+/// sent on a socket of the given address family.
+/// \return Length of the control message.
+inline std::size_t makePktInfo(std::span<std::byte> control, int family,
+    const generic::IPAddress& src)
+{
+    msghdr hdr = {};
+    hdr.msg_control = control.data();
+    hdr.msg_controllen = control.size();
+    auto cmsg = CMSG_FIRSTHDR(&hdr);
+    if (family == AF_INET) {
+        in_pktinfo info = {};
+        std::array<std::byte, 4> bytes;
+        src.unmap4in6().toBytes4(bytes);
+        std::memcpy(&info.ipi_spec_dst, bytes.data(), bytes.size());
+        cmsg->cmsg_level = IPPROTO_IP;
+        cmsg->cmsg_type = IP_PKTINFO;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(info));
+        std::memcpy(CMSG_DATA(cmsg), &info, sizeof(info));
+        return CMSG_SPACE(sizeof(info));
+    } else {
+        in6_pktinfo info = {};
+        std::array<std::byte, 16> bytes;
+        src.map4in6().toBytes16(bytes);
+        std::memcpy(&info.ipi6_addr, bytes.data(), bytes.size());
+        cmsg->cmsg_level = IPPROTO_IPV6;
+        cmsg->cmsg_type = IPV6_PKTINFO;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(info));
+        std::memcpy(CMSG_DATA(cmsg), &info, sizeof(info));
+        return CMSG_SPACE(sizeof(info));
+    }
+}
+
+/// \brief Receive a datagram that may have been coalesced by UDP generic
+/// receive offload.
+/// \param segmentSize Receives the size of the coalesced datagrams or zero if
+/// the received data is a single datagram.
+/// \param dst Optional pointer that receives the destination address of the
+/// datagram. Requires the IP_PKTINFO or IPV6_RECVPKTINFO socket option.
+/// \return Number of bytes received.
+inline Maybe<std::size_t> recvmsgGro(NativeHandle handle, std::span<std::byte> buf,
+    sockaddr* from, socklen_t& fromLen, std::size_t& segmentSize, int flags,
+    generic::IPAddress* dst = nullptr)
+{
+    iovec vec{
+        .iov_base = buf.data(),
+        .iov_len = buf.size(),
+    };
+    alignas(cmsghdr) std::array<char, RECV_CONTROL_LEN> control;
+    msghdr hdr{
+        .msg_name = from,
+        .msg_namelen = fromLen,
+        .msg_iov = &vec,
+        .msg_iovlen = 1,
+        .msg_control = control.data(),
+        .msg_controllen = control.size(),
+        .msg_flags = 0,
+    };
+    ssize_t n = 0;
+    do {
+        n = ::recvmsg(handle, &hdr, flags);
+    } while (n < 0 && errno == EINTR);
+    if (n < 0) return Error(getLastError());
+    if (hdr.msg_flags & MSG_TRUNC) return Error(ErrorCode::BufferTooSmall);
+    fromLen = hdr.msg_namelen;
+    segmentSize = 0;
+    for (auto cmsg = CMSG_FIRSTHDR(&hdr); cmsg; cmsg = CMSG_NXTHDR(&hdr, cmsg)) {
+        if (cmsg->cmsg_level == SOL_UDP && cmsg->cmsg_type == UDP_GRO) {
+            int gsoSize = 0;
+            std::memcpy(&gsoSize, CMSG_DATA(cmsg), sizeof(gsoSize));
+            segmentSize = (std::size_t)gsoSize;
+        }
+    }
+    if (dst && !parsePktInfo(hdr, *dst)) return Error(ErrorCode::LogicError);
+    return (std::size_t)n;
+}
+#endif
 } // namespace details
 
 /// \brief Thin wrapper around a BSD datagram socket.
@@ -70,14 +176,26 @@ public:
     static_assert(std::is_standard_layout_v<T>);
     using SockAddr = T;
 
+    /// \brief Maximum number of datagrams received by a single call to
+    /// recvmmsg() or sent by a single call to sendmmsg().
+    static constexpr std::size_t MAX_BATCH_SIZE = 64;
+
+    /// \brief Maximum number of segments in a single sendGso() call.
+    static constexpr std::size_t MAX_GSO_SEGMENTS = 64;
+
+    /// \brief Maximum size of the buffer passed to sendGso(). This is the
+    /// largest UDP payload that fits in an IPv4 packet.
+    static constexpr std::size_t MAX_GSO_SIZE = 65507;
+
 private:
     NativeHandle handle = INVALID_SOCKET_VALUE;
+    bool reusePort = false;
 
 public:
     BSDSocket() noexcept = default;
     BSDSocket(const BSDSocket&) noexcept = delete;
     BSDSocket(BSDSocket&& other) noexcept
-        : handle(other.handle)
+        : handle(other.handle), reusePort(other.reusePort)
     {
         other.handle = INVALID_SOCKET_VALUE;
     }
@@ -92,6 +210,7 @@ public:
     friend void swap(BSDSocket& a, BSDSocket& b)
     {
         std::swap(a.handle, b.handle);
+        std::swap(a.reusePort, b.reusePort);
     }
 
     ~BSDSocket()
@@ -105,6 +224,12 @@ public:
     /// \brief Get the native socket handle.
     NativeHandle getNativeHandle() { return handle; }
 
+    /// \brief Allow multiple sockets to bind to the same address and port
+    /// (SO_REUSEPORT). Must be called before the socket is created by `bind()`
+    /// or `connect()`. On Linux, incoming datagrams are distributed between all
+    /// sockets bound to the same address.
+    void setReusePort(bool reuse) { reusePort = reuse; }
+
     NativeHandle release()
     {
         auto h = handle;
@@ -295,6 +420,36 @@ public:
         if (n < 0) return Error(details::getLastError());
         return n;
     }
+
+    /// \brief Send a datagram like sendmsg() from the local address `from`.
+    /// Used by sockets bound to a wildcard address to select the source
+    /// address of each datagram.
+    template <std::convertible_to<std::span<const std::byte>>... Buffers>
+    Maybe<ssize_t> sendmsgFrom(
+        const SockAddr& to, const generic::IPAddress& from, int flags, Buffers&&... bufs)
+    {
+        auto make_iovec = [](const auto& buf) {
+            return iovec {
+                .iov_base = const_cast<void*>(reinterpret_cast<const void*>(buf.data())),
+                .iov_len = buf.size(),
+            };
+        };
+        std::array<iovec, sizeof...(Buffers)> vec = {make_iovec(bufs)...};
+        alignas(cmsghdr) std::array<std::byte, CMSG_SPACE(sizeof(in6_pktinfo))> control;
+        auto family = reinterpret_cast<const sockaddr*>(&to)->sa_family;
+        msghdr hdr{
+            .msg_name = const_cast<sockaddr*>(reinterpret_cast<const sockaddr*>(&to)),
+            .msg_namelen = sizeof(to),
+            .msg_iov = vec.data(),
+            .msg_iovlen = vec.size(),
+            .msg_control = control.data(),
+            .msg_controllen = details::makePktInfo(control, family, from),
+            .msg_flags = 0,
+        };
+        auto n = ::sendmsg(handle, &hdr, flags);
+        if (n < 0) return Error(details::getLastError());
+        return n;
+    }
 #endif
 #if _WIN32
     template <std::convertible_to<std::span<const std::byte>>... Buffers>
@@ -321,6 +476,13 @@ public:
         }
         return n;
     }
+
+    template <std::convertible_to<std::span<const std::byte>>... Buffers>
+    Maybe<DWORD> sendmsgFrom(
+        const SockAddr& to, const generic::IPAddress& from, int flags, Buffers&&... bufs)
+    {
+        return Error(ErrorCode::NotImplemented);
+    }
 #endif
 
     Maybe<std::span<std::byte>> recv(std::span<std::byte> buf, int flags = 0)
@@ -371,12 +533,254 @@ public:
     #endif
     }
 
+    /// \brief Receive a datagram that may have been coalesced from multiple
+    /// datagrams by UDP generic receive offload. GRO must be enabled on the
+    /// socket with the UDP_GRO socket option.
+    /// \param segmentSize Receives the size of the coalesced datagrams. All
+    /// datagrams except for the last one have this size. Set to zero if the
+    /// received buffer holds a single datagram.
+    /// \note On Windows, always receives a single datagram.
+    Maybe<std::span<std::byte>> recvfromGro(std::span<std::byte> buf, SockAddr& from,
+        std::size_t& segmentSize, int flags = 0)
+    {
+    #if _WIN32
+        segmentSize = 0;
+        return recvfrom(buf, from, flags);
+    #else
+        socklen_t addrLen = sizeof(from);
+        auto n = details::recvmsgGro(handle, buf,
+            reinterpret_cast<sockaddr*>(&from), addrLen, segmentSize, flags);
+        if (isError(n)) return propagateError(n);
+        return buf.subspan(0, get(n));
+    #endif
+    }
+
+    /// \brief Receive a datagram like recvfromGro() and its destination
+    /// address. Requires the IP_PKTINFO or IPV6_RECVPKTINFO socket option.
+    /// Used by sockets bound to a wildcard address.
+    /// \param to Receives the local address the datagram was sent to.
+    /// \note Not implemented on Windows.
+    Maybe<std::span<std::byte>> recvfromTo(std::span<std::byte> buf, SockAddr& from,
+        generic::IPAddress& to, std::size_t& segmentSize, int flags = 0)
+    {
+    #if _WIN32
+        return Error(ErrorCode::NotImplemented);
+    #else
+        socklen_t addrLen = sizeof(from);
+        auto n = details::recvmsgGro(handle, buf,
+            reinterpret_cast<sockaddr*>(&from), addrLen, segmentSize, flags, &to);
+        if (isError(n)) return propagateError(n);
+        return buf.subspan(0, get(n));
+    #endif
+    }
+
+    /// \brief Receive multiple datagrams. Blocks until at least one datagram is
+    /// available, then returns as many datagrams as can be received without
+    /// blocking again.
+    /// \param bufs One receive buffer per datagram. On return, the buffers of
+    /// the received datagrams are shrunk to the datagram size. Buffers of
+    /// datagrams that did not fit are set to an empty span.
+    /// \param from Receives the source address of each datagram. Must have at
+    /// least as many elements as `bufs`.
+    /// \return The number of received datagrams. At most `MAX_BATCH_SIZE`
+    /// datagrams are received at once.
+    /// \note On Windows, receives at most one datagram per call.
+    Maybe<std::size_t> recvmmsg(
+        std::span<std::span<std::byte>> bufs, std::span<SockAddr> from, int flags = 0)
+    {
+        return recvmmsg(bufs, from, std::span<generic::IPAddress>(), flags);
+    }
+
+    /// \brief Receive multiple datagrams and their destination addresses.
+    /// \param to If not empty, receives the local address each datagram was
+    /// sent to. Must have at least as many elements as `bufs`. Requires the
+    /// IP_PKTINFO or IPV6_RECVPKTINFO socket option.
+    /// \copydetails recvmmsg()
+    Maybe<std::size_t> recvmmsg(std::span<std::span<std::byte>> bufs,
+        std::span<SockAddr> from, std::span<generic::IPAddress> to, int flags = 0)
+    {
+        auto count = std::min({bufs.size(), from.size(), MAX_BATCH_SIZE});
+        if (!to.empty()) count = std::min(count, to.size());
+        if (count == 0) return Error(ErrorCode::InvalidArgument);
+    #if _WIN32
+        if (!to.empty()) return Error(ErrorCode::NotImplemented);
+        auto recvd = recvfrom(bufs[0], from[0], flags);
+        if (isError(recvd)) {
+            if (getError(recvd) != ErrorCode::BufferTooSmall) return propagateError(recvd);
+            bufs[0] = std::span<std::byte>();
+        } else {
+            bufs[0] = get(recvd);
+        }
+        return 1;
+    #else
+        constexpr auto CONTROL_LEN = CMSG_SPACE(sizeof(in6_pktinfo));
+        std::array<iovec, MAX_BATCH_SIZE> vecs;
+        std::array<mmsghdr, MAX_BATCH_SIZE> msgs;
+        alignas(cmsghdr) std::array<std::byte, MAX_BATCH_SIZE * CONTROL_LEN> control;
+        for (std::size_t i = 0; i < count; ++i) {
+            vecs[i] = iovec{
+                .iov_base = bufs[i].data(),
+                .iov_len = bufs[i].size(),
+            };
+            msgs[i].msg_hdr = msghdr{
+                .msg_name = reinterpret_cast<sockaddr*>(&from[i]),
+                .msg_namelen = sizeof(SockAddr),
+                .msg_iov = &vecs[i],
+                .msg_iovlen = 1,
+                .msg_control = to.empty() ? NULL : &control[i * CONTROL_LEN],
+                .msg_controllen = to.empty() ? 0 : CONTROL_LEN,
+                .msg_flags = 0,
+            };
+            msgs[i].msg_len = 0;
+        }
+        int n = 0;
+        do {
+            n = ::recvmmsg(handle, msgs.data(), (unsigned int)count,
+                flags | MSG_WAITFORONE, nullptr);
+        } while (n < 0 && errno == EINTR);
+        if (n < 0) return Error(details::getLastError());
+        for (int i = 0; i < n; ++i) {
+            if (msgs[i].msg_hdr.msg_flags & MSG_TRUNC)
+                bufs[i] = std::span<std::byte>();
+            else
+                bufs[i] = bufs[i].subspan(0, msgs[i].msg_len);
+            if (!to.empty() && !details::parsePktInfo(msgs[i].msg_hdr, to[i]))
+                bufs[i] = std::span<std::byte>();
+        }
+        return (std::size_t)n;
+    #endif
+    }
+
+    /// \brief Send multiple datagrams. Each datagram is assembled from N
+    /// buffers in the same way as sendmsg() does.
+    /// \param bufs Buffers making up each datagram.
+    /// \param to Destination address of each datagram. Must have at least as
+    /// many elements as `bufs`.
+    /// \return The number of datagrams sent. At most `MAX_BATCH_SIZE`
+    /// datagrams are sent at once.
+    /// \note On Windows, datagrams are sent one by one.
+    template <std::size_t N>
+    Maybe<std::size_t> sendmmsg(
+        std::span<const std::array<std::span<const std::byte>, N>> bufs,
+        std::span<const SockAddr> to, int flags = 0)
+    {
+        auto count = std::min({bufs.size(), to.size(), MAX_BATCH_SIZE});
+        if (count == 0) return Error(ErrorCode::InvalidArgument);
+    #if _WIN32
+        for (std::size_t i = 0; i < count; ++i) {
+            auto sent = [&]<std::size_t... I>(std::index_sequence<I...>) {
+                return sendmsg(to[i], flags, bufs[i][I]...);
+            }(std::make_index_sequence<N>());
+            if (isError(sent)) {
+                if (i > 0) return i;
+                return propagateError(sent);
+            }
+        }
+        return count;
+    #else
+        std::array<iovec, N * MAX_BATCH_SIZE> vecs;
+        std::array<mmsghdr, MAX_BATCH_SIZE> msgs;
+        for (std::size_t i = 0; i < count; ++i) {
+            for (std::size_t j = 0; j < N; ++j) {
+                vecs[N * i + j] = iovec{
+                    .iov_base = const_cast<void*>(
+                        reinterpret_cast<const void*>(bufs[i][j].data())),
+                    .iov_len = bufs[i][j].size(),
+                };
+            }
+            msgs[i].msg_hdr = msghdr{
+                .msg_name = const_cast<sockaddr*>(reinterpret_cast<const sockaddr*>(&to[i])),
+                .msg_namelen = sizeof(SockAddr),
+                .msg_iov = &vecs[N * i],
+                .msg_iovlen = N,
+                .msg_control = NULL,
+                .msg_controllen = 0,
+                .msg_flags = 0,
+            };
+            msgs[i].msg_len = 0;
+        }
+        int n = 0;
+        do {
+            n = ::sendmmsg(handle, msgs.data(), (unsigned int)count, flags);
+        } while (n < 0 && errno == EINTR);
+        if (n < 0) return Error(details::getLastError());
+        return (std::size_t)n;
+    #endif
+    }
+
+    /// \brief Send a buffer as a sequence of datagrams of `segmentSize` bytes
+    /// each, except for the last one which may be shorter. On Linux, the
+    /// buffer is passed to the kernel in a single call and segmented using UDP
+    /// generic segmentation offload (UDP_SEGMENT).
+    /// \param buf Buffer containing at most `MAX_GSO_SEGMENTS` segments and at
+    /// most `MAX_GSO_SIZE` bytes.
+    /// \return The number of bytes sent.
+    Maybe<std::size_t> sendGso(std::span<const std::byte> buf,
+        const SockAddr& to, std::uint16_t segmentSize, int flags = 0)
+    {
+        if (segmentSize == 0 || buf.size() > MAX_GSO_SIZE
+            || (buf.size() + segmentSize - 1) / segmentSize > MAX_GSO_SEGMENTS) {
+            return Error(ErrorCode::InvalidArgument);
+        }
+    #if _WIN32
+        std::size_t offset = 0;
+        while (offset < buf.size()) {
+            auto sent = sendto(buf.subspan(offset, std::min<std::size_t>(
+                segmentSize, buf.size() - offset)), to, flags);
+            if (isError(sent)) return propagateError(sent);
+            offset += segmentSize;
+        }
+        return buf.size();
+    #else
+        iovec vec{
+            .iov_base = const_cast<void*>(reinterpret_cast<const void*>(buf.data())),
+            .iov_len = buf.size(),
+        };
+        alignas(cmsghdr) std::array<char, CMSG_SPACE(sizeof(std::uint16_t))> control = {};
+        msghdr hdr{
+            .msg_name = const_cast<sockaddr*>(reinterpret_cast<const sockaddr*>(&to)),
+            .msg_namelen = sizeof(to),
+            .msg_iov = &vec,
+            .msg_iovlen = 1,
+            .msg_control = control.data(),
+            .msg_controllen = control.size(),
+            .msg_flags = 0,
+        };
+        auto cmsg = CMSG_FIRSTHDR(&hdr);
+        cmsg->cmsg_level = SOL_UDP;
+        cmsg->cmsg_type = UDP_SEGMENT;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(std::uint16_t));
+        std::memcpy(CMSG_DATA(cmsg), &segmentSize, sizeof(segmentSize));
+        ssize_t n = 0;
+        do {
+            n = ::sendmsg(handle, &hdr, flags);
+        } while (n < 0 && errno == EINTR);
+        if (n < 0) return Error(details::getLastError());
+        return (std::size_t)n;
+    #endif
+    }
+
 private:
     std::error_code create(const SockAddr& addr)
     {
         auto family = reinterpret_cast<const sockaddr*>(&addr)->sa_family;
         handle = ::socket(family, SOCK_DGRAM, 0);
         if (handle < 0) return details::getLastError();
+    #ifdef SO_REUSEPORT
+        if (reusePort) {
+            int optval = 1;
+            auto ec = setsockopt(SOL_SOCKET, SO_REUSEPORT, &optval, sizeof(optval));
+            if (ec) {
+                close();
+                return ec;
+            }
+        }
+    #else
+        if (reusePort) {
+            close();
+            return ErrorCode::NotImplemented;
+        }
+    #endif
         return ErrorCode::Ok;
     }
 };
@@ -386,11 +790,21 @@ namespace details
 std::optional<generic::IPAddress> getDefaultInterfaceAddr4();
 std::optional<generic::IPAddress> getDefaultInterfaceAddr6();
 
+/// \brief Forget the cached default interface addresses, e.g., after the
+/// host's addresses or routes have changed.
+void invalidateDefaultInterfaceAddr();
+
+/// \brief Get the local address the host uses as source address for packets
+/// to `dst`, e.g., the SCION next hop. Not cached.
+std::optional<generic::IPAddress> getSourceAddress(const generic::IPAddress& dst);
+
 /// \brief Get the address the socket is bound to or in case it is bound to a
 /// wildcard address, an arbitrary local address.
-template <typename Sockaddr>
-Maybe<generic::IPEndpoint> findLocalAddress(const bsd::BSDSocket<Sockaddr>& s)
+/// \tparam Socket BSDSocket or another underlay socket providing getsockname().
+template <typename Socket>
+Maybe<generic::IPEndpoint> findLocalAddress(const Socket& s)
 {
+    using Sockaddr = typename Socket::SockAddr;
     using IPAddress = typename EndpointTraits<Sockaddr>::HostAddr;
     auto bound = s.getsockname();
     if (isError(bound)) return propagateError(bound);
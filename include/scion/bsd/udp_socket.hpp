@@ -22,7 +22,12 @@
 
 #include "scion/bsd/scmp_socket.hpp"
 #include "scion/scmp/handler.hpp"
+#include "scion/socket/gro.hpp"
+#include "scion/socket/header_cache_pool.hpp"
+#include "scion/socket/received_packet.hpp"
 
+#include <algorithm>
+#include <array>
 #include <cstdint>
 #include <format>
 #include <ranges>
@@ -48,11 +53,40 @@ protected:
 private:
     using SCMPSocket<Underlay>::socket;
     using SCMPSocket<Underlay>::packager;
+    using SCMPSocket<Underlay>::wildcard;
+    using SCMPSocket<Underlay>::HAS_PKTINFO;
+    bool groEnabled = false;
+    scion::details::GroSegments<UnderlayEp> groSegments;
+    generic::IPAddress groDest;
 
 public:
     void setNextScmpHandler(ScmpHandler* handler) { scmpHandler = handler; }
     ScmpHandler* nextScmpHandler() const { return scmpHandler; }
 
+    /// \brief Enable or disable UDP generic receive offload (GRO) on the
+    /// underlay socket. Must be called after `bind()`.
+    ///
+    /// With GRO enabled, a single underlay receive operation may return many
+    /// packets from the same source coalesced into one buffer. The receive
+    /// methods return these packets one at a time. Packets that have not been
+    /// returned yet are kept in the buffer passed to the receive call that
+    /// obtained them, so that buffer must stay valid and must not be modified
+    /// outside of the returned payloads until all packets have been consumed.
+    /// Receive buffers should be large enough to hold a full 64 KiB of
+    /// coalesced datagrams.
+    std::error_code setGro(bool enable)
+    {
+    #if __linux__
+        int value = enable;
+        auto ec = socket.setsockopt(SOL_UDP, UDP_GRO, &value, sizeof(value));
+        if (ec) return ec;
+        groEnabled = enable;
+        return ErrorCode::Ok;
+    #else
+        return ErrorCode::NotImplemented;
+    #endif
+    }
+
     template <typename Path, typename Alloc>
     Maybe<std::span<const std::byte>> send(
         HeaderCache<Alloc>& headers,
@@ -94,6 +128,42 @@ public:
         return SCMPSocket<Underlay>::sendUnderlay(headers.get(), payload, nextHop);
     }
 
+    /// \brief Send a packet from a specific local address. Intended for
+    /// replying from the address a request was received on when the socket is
+    /// bound to a wildcard address.
+    /// \param localAddr Source host address. Must be one of the addresses the
+    /// socket is bound to.
+    template <typename Path, typename Alloc>
+    Maybe<std::span<const std::byte>> sendToFrom(
+        HeaderCache<Alloc>& headers,
+        const Endpoint& to,
+        const generic::IPAddress& localAddr,
+        const Path& path,
+        const UnderlayEp& nextHop,
+        std::span<const std::byte> payload)
+    {
+        auto ec = packager.pack(
+            headers, &to, path, ext::NoExtensions, hdr::UDP{}, payload, &localAddr);
+        if (ec) return Error(ec);
+        return SCMPSocket<Underlay>::sendUnderlay(headers.get(), payload, nextHop, &localAddr);
+    }
+
+    /// \brief Send a packet using headers from a pool of header caches.
+    /// Headers are only built from scratch if the destination and path are
+    /// not in the pool.
+    template <typename Path, typename Alloc>
+    Maybe<std::span<const std::byte>> sendTo(
+        HeaderCachePool<Alloc>& pool,
+        const Endpoint& to,
+        const Path& path,
+        const UnderlayEp& nextHop,
+        std::span<const std::byte> payload)
+    {
+        auto headers = pool.pack(packager, to, path, hdr::UDP{}, payload);
+        if (isError(headers)) return propagateError(headers);
+        return SCMPSocket<Underlay>::sendUnderlay(get(headers), payload, nextHop);
+    }
+
     template <typename Path, ext::extension_range ExtRange, typename Alloc>
     Maybe<std::span<const std::byte>> sendToExt(
         HeaderCache<Alloc>& headers,
@@ -138,10 +208,180 @@ public:
         return SCMPSocket<Underlay>::sendUnderlay(headers.get(), payload, nextHop);
     }
 
+    /// \brief Send a packet from a single contiguous buffer. The payload must
+    /// be stored in `buf` at offset `headroom`. The headers are written into
+    /// the headroom in front of it, see ScionPackager::packInPlace().
+    template <typename Path, typename Alloc>
+    Maybe<std::span<const std::byte>> sendToInPlace(
+        HeaderCache<Alloc>& headers,
+        const Endpoint& to,
+        const Path& path,
+        const UnderlayEp& nextHop,
+        std::span<std::byte> buf,
+        std::size_t headroom)
+    {
+        auto packet = packager.packInPlace(
+            headers, &to, path, ext::NoExtensions, hdr::UDP{}, buf, headroom);
+        if (isError(packet)) return propagateError(packet);
+        return SCMPSocket<Underlay>::sendUnderlay(
+            get(packet), headers.size(), nextHop);
+    }
+
+    /// \brief Send a packet from a single contiguous buffer to the connected
+    /// remote endpoint using the headers from a previous send.
+    template <typename Alloc>
+    Maybe<std::span<const std::byte>> sendCachedInPlace(
+        HeaderCache<Alloc>& headers,
+        const UnderlayEp& nextHop,
+        std::span<std::byte> buf,
+        std::size_t headroom)
+    {
+        hdr::UDP udp;
+        udp.sport = packager.getLocalEp().getPort();
+        udp.dport = packager.getRemoteEp().getPort();
+        auto packet = packager.packInPlace(headers, udp, buf, headroom);
+        if (isError(packet)) return propagateError(packet);
+        return SCMPSocket<Underlay>::sendUnderlay(
+            get(packet), headers.size(), nextHop);
+    }
+
+    /// \brief Reply to a received packet by turning it into the reply in
+    /// place, see ScionPackager::packReply().
+    /// \param packet Received packet, e.g., ReceivedPacket::packet, with the
+    /// reply payload stored in place of the received payload.
+    /// \param payloadSize Size of the reply payload.
+    /// \param nextHop Usually the underlay source of the received packet.
+    /// \param localAddr On sockets bound to a wildcard address, the local
+    /// address the packet was received on.
+    Maybe<std::span<const std::byte>> sendReply(
+        std::span<std::byte> packet,
+        std::size_t payloadSize,
+        const UnderlayEp& nextHop,
+        const generic::IPAddress* localAddr = nullptr)
+    {
+        auto reply = packager.packReply(packet, payloadSize);
+        if (isError(reply)) return propagateError(reply);
+        return SCMPSocket<Underlay>::sendUnderlay(
+            get(reply), get(reply).size() - payloadSize, nextHop, localAddr);
+    }
+
+    /// \brief Send a burst of packets to the connected remote endpoint using
+    /// the same headers as sendCached(). The packets are copied into `buf`
+    /// back to back and passed to the underlay for segmentation offload.
+    /// \param payloads Payloads of the packets. All payloads except for the
+    /// last one must have the same size. The last one may be shorter.
+    /// \param buf Scratch buffer. Must fit at least one packet including
+    /// headers. Larger buffers allow more packets per system call.
+    /// \return Number of packets sent. If sending fails after some packets
+    /// have been sent already, the number of packets sent so far is returned
+    /// instead of the error.
+    template <typename Alloc>
+    Maybe<std::size_t> sendCachedBurst(
+        HeaderCache<Alloc>& headers,
+        const UnderlayEp& nextHop,
+        std::span<const std::span<const std::byte>> payloads,
+        std::span<std::byte> buf)
+    {
+        if (payloads.empty()) return 0;
+        if (headers.size() == 0) return Error(ErrorCode::InvalidArgument);
+        const auto payloadSize = payloads.front().size();
+        for (std::size_t i = 1; i < payloads.size(); ++i) {
+            if (payloads[i].size() > payloadSize) return Error(ErrorCode::InvalidArgument);
+            if (payloads[i].size() < payloadSize && i != payloads.size() - 1)
+                return Error(ErrorCode::InvalidArgument);
+        }
+
+        hdr::UDP udp;
+        udp.sport = packager.getLocalEp().getPort();
+        udp.dport = packager.getRemoteEp().getPort();
+        // Updating the payload does not change the size of the cached headers.
+        const auto hdrSize = headers.size();
+        const auto segmentSize = hdrSize + payloadSize;
+        std::size_t sent = 0;
+        auto partial = [&sent] (std::error_code ec) -> Maybe<std::size_t> {
+            if (sent > 0) return sent;
+            return Error(ec);
+        };
+        while (sent < payloads.size()) {
+            std::size_t offset = 0, batch = 0;
+            while (sent + batch < payloads.size()) {
+                auto payload = payloads[sent + batch];
+                if (offset + segmentSize > std::min(buf.size(), Underlay::MAX_GSO_SIZE)
+                    || offset / segmentSize == Underlay::MAX_GSO_SEGMENTS) {
+                    break;
+                }
+                // Copy the payload and compute its checksum in a single pass
+                auto ec = packager.pack(headers, udp, payload,
+                    buf.subspan(offset + hdrSize, payload.size()));
+                if (ec) return partial(ec);
+                std::ranges::copy(headers.get(), buf.begin() + offset);
+                offset += hdrSize + payload.size();
+                ++batch;
+            }
+            if (offset == 0) return partial(ErrorCode::BufferTooSmall);
+            auto n = socket.sendGso(buf.subspan(0, offset), nextHop, (std::uint16_t)segmentSize);
+            if (isError(n)) return partial(getError(n));
+            sent += batch;
+        }
+        return sent;
+    }
+
+    /// \brief Send multiple packets with as few system calls as possible.
+    /// \param packets Range of packets to send. Each element must decompose
+    /// into a HeaderCache reference, a payload and a next hop underlay address
+    /// via structured binding, e.g., a std::tuple or an aggregate. The header
+    /// caches must have been initialized by sending a UDP packet to the
+    /// intended destination before. They are updated for the new payload
+    /// keeping the cached UDP ports as in sendToCached(). The same header cache
+    /// must not appear more than once in `packets`.
+    /// \return Number of packets sent. If an error is returned, some of the
+    /// packets may have been sent already.
+    template <std::ranges::input_range Range>
+    Maybe<std::size_t> sendBatch(Range&& packets)
+    {
+        constexpr auto MAX_BATCH_SIZE = Underlay::MAX_BATCH_SIZE;
+        std::array<std::array<std::span<const std::byte>, 2>, MAX_BATCH_SIZE> bufs;
+        std::array<UnderlayEp, MAX_BATCH_SIZE> nextHops;
+        std::size_t count = 0, total = 0;
+
+        auto flush = [&] () -> std::error_code {
+            std::size_t offset = 0;
+            while (offset < count) {
+                auto sent = socket.sendmmsg(
+                    std::span<const std::array<std::span<const std::byte>, 2>>(
+                        bufs.data() + offset, count - offset),
+                    std::span<const UnderlayEp>(nextHops.data() + offset, count - offset));
+                if (isError(sent)) return getError(sent);
+                offset += get(sent);
+            }
+            total += count;
+            count = 0;
+            return ErrorCode::Ok;
+        };
+
+        for (auto&& [headers, payload, nextHop] : packets) {
+            hdr::UDP udp;
+            ReadStream rs(headers.getL4());
+            if (!udp.serialize(rs, NullStreamError)) return Error(ErrorCode::InvalidArgument);
+            auto ec = packager.pack(headers, udp, payload);
+            if (ec) return Error(ec);
+            bufs[count] = {headers.get(), std::span<const std::byte>(payload)};
+            nextHops[count] = nextHop;
+            if (++count == MAX_BATCH_SIZE) {
+                if ((ec = flush())) return Error(ec);
+            }
+        }
+        if (count > 0) {
+            if (auto ec = flush(); ec) return Error(ec);
+        }
+        return total;
+    }
+
     Maybe<std::span<std::byte>> recv(std::span<std::byte> buf)
     {
         UnderlayEp ulSource;
-        return recvImpl(buf, nullptr, nullptr, ulSource, ext::NoExtensions, ext::NoExtensions);
+        return recvImpl(buf, nullptr, nullptr, ulSource, nullptr,
+            ext::NoExtensions, ext::NoExtensions);
     }
 
     template <ext::extension_range HbHExt, ext::extension_range E2EExt>
@@ -151,7 +391,7 @@ public:
         E2EExt&& e2eExt)
     {
         UnderlayEp ulSource;
-        return recvImpl(buf, nullptr, nullptr, ulSource,
+        return recvImpl(buf, nullptr, nullptr, ulSource, nullptr,
             std::forward<HbHExt>(hbhExt), std::forward<E2EExt>(e2eExt));
     }
 
@@ -160,7 +400,8 @@ public:
         Endpoint& from)
     {
         UnderlayEp ulSource;
-        return recvImpl(buf, &from, nullptr, ulSource, ext::NoExtensions, ext::NoExtensions);
+        return recvImpl(buf, &from, nullptr, ulSource, nullptr,
+            ext::NoExtensions, ext::NoExtensions);
     }
 
     template <ext::extension_range HbHExt, ext::extension_range E2EExt>
@@ -171,57 +412,208 @@ public:
         E2EExt&& e2eExt)
     {
         UnderlayEp ulSource;
-        return recvImpl(buf, &from, nullptr, ulSource,
+        return recvImpl(buf, &from, nullptr, ulSource, nullptr,
             std::forward<HbHExt>(hbhExt), std::forward<E2EExt>(e2eExt));
     }
 
     Maybe<std::span<std::byte>> recvFromVia(
         std::span<std::byte> buf,
         Endpoint& from,
-        RawPath& path,
+        RawPathOutput path,
         UnderlayEp& ulSource)
     {
-        return recvImpl(buf, &from, &path, ulSource, ext::NoExtensions, ext::NoExtensions);
+        return recvImpl(buf, &from, path, ulSource, nullptr,
+            ext::NoExtensions, ext::NoExtensions);
+    }
+
+    /// \brief Receive a packet and the local address it was sent to. Use
+    /// sendToFrom() to reply from the same address.
+    Maybe<std::span<std::byte>> recvFromVia(
+        std::span<std::byte> buf,
+        Endpoint& from,
+        RawPathOutput path,
+        UnderlayEp& ulSource,
+        generic::IPAddress& localAddr)
+    {
+        return recvImpl(buf, &from, path, ulSource, &localAddr,
+            ext::NoExtensions, ext::NoExtensions);
     }
 
     template <ext::extension_range HbHExt, ext::extension_range E2EExt>
     Maybe<std::span<std::byte>> recvFromViaExt(
         std::span<std::byte> buf,
         Endpoint& from,
-        RawPath& path,
+        RawPathOutput path,
         UnderlayEp& ulSource,
         HbHExt&& hbhExt,
         E2EExt&& e2eExt)
     {
-        return recvImpl(buf, &from, &path, ulSource, hbhExt, e2eExt);
+        return recvImpl(buf, &from, path, ulSource, nullptr, hbhExt, e2eExt);
+    }
+
+    /// \brief Receive multiple packets with as few system calls as possible.
+    /// Blocks until at least one valid packet was received.
+    /// \param buf Receive buffer. The buffer is divided evenly between up to
+    /// `results.size()` underlay datagrams.
+    /// \param results Storage for the received packets.
+    /// \return Leading subrange of `results` containing the valid packets. The
+    /// payloads and paths point into `buf`. Invalid and SCMP packets are skipped.
+    /// \note If GRO is enabled, `buf` is not divided. Instead, a single
+    /// coalesced buffer is received and split into packets. See setGro().
+    Maybe<std::span<ReceivedPacket<UnderlayEp>>> recvBatch(
+        std::span<std::byte> buf,
+        std::span<ReceivedPacket<UnderlayEp>> results)
+    {
+        constexpr auto MAX_BATCH_SIZE = Underlay::MAX_BATCH_SIZE;
+        auto count = std::min(results.size(), MAX_BATCH_SIZE);
+        if (count == 0 || buf.size() < count) return Error(ErrorCode::InvalidArgument);
+        auto slotSize = buf.size() / count;
+
+        auto scmpCallback = [this] (
+            const scion::Address<generic::IPAddress>& from,
+            const RawPathView& path,
+            const hdr::ScmpMessage& msg,
+            std::span<const std::byte> payload)
+        {
+            if (scmpHandler) scmpHandler->handleScmp(from, path, msg, payload);
+        };
+        if (groEnabled) {
+            while (true) {
+                if (groSegments.empty()) {
+                    auto ec = recvGro(buf);
+                    if (ec) return Error(ec);
+                }
+                std::size_t valid = 0;
+                while (valid < results.size() && !groSegments.empty()) {
+                    auto& pkt = results[valid];
+                    auto dgram = groSegments.next(pkt.ulSource);
+                    pkt.localAddr = groDest;
+                    auto payload = packager.template unpack<hdr::UDP>(dgram,
+                        generic::toGenericAddr(EndpointTraits<UnderlayEp>::getHost(pkt.ulSource)),
+                        wildcard ? &groDest : nullptr,
+                        ext::NoExtensions, ext::NoExtensions, &pkt.from, &pkt.path, scmpCallback);
+                    if (payload.has_value()) {
+                        pkt.payload = std::span<std::byte>{
+                            const_cast<std::byte*>(payload->data()),
+                            payload->size()
+                        };
+                        pkt.packet = dgram;
+                        pkt.checksum = packager.getDeferredChecksum();
+                        ++valid;
+                    } else if (getError(payload) != ErrorCode::ScmpReceived) {
+                        SCION_DEBUG_PRINT((std::format("Received invalid packet from {}: {}\n",
+                            pkt.ulSource, fmtError(getError(payload)))));
+                    }
+                }
+                if (valid > 0) return results.subspan(0, valid);
+            }
+        }
+
+        std::array<std::span<std::byte>, MAX_BATCH_SIZE> bufs;
+        std::array<UnderlayEp, MAX_BATCH_SIZE> ulSources;
+        std::array<generic::IPAddress, MAX_BATCH_SIZE> ulDests;
+        while (true) {
+            for (std::size_t i = 0; i < count; ++i) {
+                bufs[i] = buf.subspan(i * slotSize, slotSize);
+            }
+            auto recvd = [&] {
+                if constexpr (HAS_PKTINFO) {
+                    if (wildcard) {
+                        return socket.recvmmsg(std::span(bufs.data(), count),
+                            std::span(ulSources.data(), count), std::span(ulDests.data(), count));
+                    }
+                }
+                return socket.recvmmsg(
+                    std::span(bufs.data(), count), std::span(ulSources.data(), count));
+            }();
+            if (isError(recvd)) return propagateError(recvd);
+
+            std::size_t valid = 0;
+            for (std::size_t i = 0; i < get(recvd); ++i) {
+                auto& pkt = results[valid];
+                auto payload = packager.template unpack<hdr::UDP>(bufs[i],
+                    generic::toGenericAddr(EndpointTraits<UnderlayEp>::getHost(ulSources[i])),
+                    wildcard ? &ulDests[i] : nullptr,
+                    ext::NoExtensions, ext::NoExtensions, &pkt.from, &pkt.path, scmpCallback);
+                if (payload.has_value()) {
+                    pkt.payload = std::span<std::byte>{
+                        const_cast<std::byte*>(payload->data()),
+                        payload->size()
+                    };
+                    pkt.packet = bufs[i];
+                    pkt.ulSource = ulSources[i];
+                    pkt.localAddr = wildcard ? ulDests[i] : packager.getLocalEp().getHost();
+                    pkt.checksum = packager.getDeferredChecksum();
+                    ++valid;
+                } else if (getError(payload) != ErrorCode::ScmpReceived) {
+                    SCION_DEBUG_PRINT((std::format("Received invalid packet from {}: {}\n",
+                        ulSources[i], fmtError(getError(payload)))));
+                }
+            }
+            if (valid > 0) return results.subspan(0, valid);
+        }
     }
 
 private:
+    /// \brief Receive coalesced datagrams into `groSegments`.
+    std::error_code recvGro(std::span<std::byte> buf)
+    {
+        UnderlayEp ulSource;
+        std::size_t segmentSize = 0;
+        auto recvd = [&] {
+            if constexpr (HAS_PKTINFO) {
+                if (wildcard) return socket.recvfromTo(buf, ulSource, groDest, segmentSize);
+            }
+            groDest = packager.getLocalEp().getHost();
+            return socket.recvfromGro(buf, ulSource, segmentSize);
+        }();
+        if (isError(recvd)) return getError(recvd);
+        groSegments.assign(get(recvd), segmentSize, ulSource);
+        return ErrorCode::Ok;
+    }
+
     template <ext::extension_range HbHExt, ext::extension_range E2EExt>
     Maybe<std::span<std::byte>> recvImpl(
         std::span<std::byte> buf,
         Endpoint* from,
-        RawPath* path,
+        RawPathOutput path,
         UnderlayEp& ulSource,
+        generic::IPAddress* localAddr,
         HbHExt&& hbhExt,
         E2EExt&& e2eExt)
     {
         auto scmpCallback = [this] (
             const scion::Address<generic::IPAddress>& from,
-            const RawPath& path,
+            const RawPathView& path,
             const hdr::ScmpMessage& msg,
             std::span<const std::byte> payload)
         {
             if (scmpHandler) scmpHandler->handleScmp(from, path, msg, payload);
         };
         while (true) {
-            auto recvd = socket.recvfrom(buf, ulSource);
-            if (isError(recvd)) return propagateError(recvd);
-            auto payload = packager.template unpack<hdr::UDP>(get(recvd),
+            std::span<std::byte> dgram;
+            generic::IPAddress ulDest;
+            if (!groSegments.empty()) {
+                dgram = groSegments.next(ulSource);
+                ulDest = groDest;
+            } else if (groEnabled) {
+                auto ec = recvGro(buf);
+                if (ec) return Error(ec);
+                dgram = groSegments.next(ulSource);
+                ulDest = groDest;
+            } else {
+                auto recvd = SCMPSocket<Underlay>::recvUnderlay(buf, ulSource, ulDest);
+                if (isError(recvd)) return propagateError(recvd);
+                dgram = get(recvd);
+                if (!wildcard) ulDest = packager.getLocalEp().getHost();
+            }
+            auto payload = packager.template unpack<hdr::UDP>(dgram,
                 generic::toGenericAddr(EndpointTraits<UnderlayEp>::getHost(ulSource)),
+                wildcard ? &ulDest : nullptr,
                 std::forward<HbHExt>(hbhExt), std::forward<E2EExt>(e2eExt),
                 from, path, scmpCallback);
             if (payload.has_value()) {
+                if (localAddr) *localAddr = ulDest;
                 return std::span<std::byte>{
                     const_cast<std::byte*>(payload->data()),
                     payload->size()
@@ -0,0 +1,559 @@
+// Copyright (c) 2024-2025 Lars-Christian Schulz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "scion/addr/generic_ip.hpp"
+#include "scion/bsd/socket.hpp"
+
+#if __linux__
+#include <sys/socket.h>
+#include <sys/time.h>
+#endif
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <optional>
+#include <span>
+#include <tuple>
+#include <unordered_map>
+
+
+#if __linux__
+namespace scion {
+namespace bsd {
+namespace details {
+
+using MacAddress = std::array<std::byte, 6>;
+
+/// \brief Index and hardware address of a network interface.
+struct InterfaceInfo
+{
+    unsigned index = 0;
+    MacAddress mac = {};
+};
+
+/// \brief Find the interface an IP address is assigned to.
+Maybe<InterfaceInfo> findInterface(const generic::IPAddress& addr);
+
+/// \brief Query the kernel's neighbor table for the link-layer address of
+/// `addr` on interface `ifindex`. Returns nothing if the neighbor is unknown
+/// or has not been resolved yet.
+std::optional<MacAddress> lookupNeighbor(unsigned ifindex, const generic::IPAddress& addr);
+
+/// \brief Size of the Ethernet, IP, and UDP headers in front of the payload
+/// of an underlay datagram.
+inline std::size_t underlayHeaderSize(const generic::IPAddress& addr)
+{
+    return addr.is4() ? (14 + 20 + 8) : (14 + 40 + 8);
+}
+
+/// \brief Write Ethernet, IP, and UDP headers into the first
+/// underlayHeaderSize() bytes of `frame`. The rest of `frame` is the payload,
+/// which must already be in place for computing the UDP checksum.
+std::error_code writeUnderlayHeaders(std::span<std::byte> frame,
+    const MacAddress& srcMac, const MacAddress& dstMac,
+    const generic::IPEndpoint& src, const generic::IPEndpoint& dst);
+
+/// \brief Parse the Ethernet, IP, and UDP headers of a received frame.
+/// \param src Source address and port of the datagram.
+/// \param dst Destination address and port of the datagram.
+/// \return UDP payload.
+Maybe<std::span<std::byte>> parseUnderlayHeaders(std::span<std::byte> frame,
+    generic::IPEndpoint& src, generic::IPEndpoint& dst);
+
+/// \brief AF_XDP socket bound to a single queue of a network interface
+/// together with its UMEM and an XDP program that redirects UDP datagrams to
+/// one port to the socket. All other traffic is passed on to the kernel.
+class Xsk
+{
+public:
+    /// \brief A received frame. The data remains valid until the frame is
+    /// returned with release().
+    struct Frame
+    {
+        std::uint64_t addr;
+        std::span<std::byte> data;
+    };
+
+    /// \brief Producer/consumer ring shared with the kernel.
+    struct Ring
+    {
+        std::uint32_t* producer = nullptr;
+        std::uint32_t* consumer = nullptr;
+        std::uint32_t* flags = nullptr;
+        void* desc = nullptr;
+        std::uint32_t mask = 0;
+        void* map = nullptr;
+        std::size_t mapSize = 0;
+    };
+
+private:
+    int fd = -1;
+    int mapFd = -1;
+    int progFd = -1;
+    int linkFd = -1;
+
+    std::byte* umem = nullptr;
+    std::size_t umemSize = 0;
+    std::size_t frameSize = 0;
+
+    Ring rx, tx, fill, comp;
+    std::unique_ptr<std::uint64_t[]> txFree;
+    std::size_t txFreeCount = 0;
+
+public:
+    Xsk() = default;
+    Xsk(const Xsk&) = delete;
+    Xsk& operator=(const Xsk&) = delete;
+    ~Xsk();
+
+    /// \brief Create the socket and attach the XDP program to the interface.
+    /// \param ifindex Interface index.
+    /// \param queue Receive queue of the interface to bind to.
+    /// \param local Local address and UDP port to redirect to the socket.
+    /// Frames for other addresses or of the other IP family are passed to the
+    /// kernel.
+    /// \param frameCount Number of UMEM frames. Must be a power of two. Half
+    /// of the frames are used for receiving, the other half for sending.
+    /// \param size Size of each frame. Must be a power of two between 2048
+    /// and the page size.
+    std::error_code open(unsigned ifindex, unsigned queue,
+        const generic::IPEndpoint& local, std::size_t frameCount, std::size_t size);
+
+    /// \brief Get the file descriptor of the AF_XDP socket.
+    int getNativeHandle() const { return fd; }
+
+    /// \brief Receive up to `frames.size()` frames.
+    /// \param block Whether to wait for a frame if none is available.
+    /// \param timeout Optional timeout for blocking waits.
+    /// \return Number of frames received.
+    Maybe<std::size_t> receive(std::span<Frame> frames,
+        bool block, std::optional<std::chrono::microseconds> timeout);
+
+    /// \brief Return received frames to the kernel.
+    void release(std::span<const std::uint64_t> addrs);
+
+    /// \brief Get a free transmit frame.
+    Maybe<Frame> allocate();
+
+    /// \brief Queue `len` bytes of a frame obtained from allocate() for
+    /// transmission. The frame is sent by the next call to flush().
+    void submit(std::uint64_t addr, std::size_t len);
+
+    /// \brief Return a frame obtained from allocate() without sending it.
+    void discard(std::uint64_t addr) { txFree[txFreeCount++] = addr; }
+
+    /// \brief Wake up the kernel to transmit submitted frames.
+    std::error_code flush();
+
+private:
+    std::error_code loadProgram(
+        unsigned ifindex, unsigned queue, const generic::IPEndpoint& local);
+    void reclaim();
+};
+
+} // namespace details
+
+/// \brief Datagram socket underlay that sends and receives UDP/IP through an
+/// AF_XDP socket, bypassing the kernel's network stack. Can be used in place of
+/// BSDSocket as underlay of the SCION sockets in the bsd namespace.
+///
+/// The socket binds to the interface the local IP address is assigned to and
+/// attaches an XDP program to it that redirects UDP datagrams for the bound
+/// port to the socket. The Ethernet, IP, and UDP headers are built and parsed
+/// in user space. Received datagrams are not copied: Receive calls return
+/// spans pointing directly into the UMEM frames, so that the SCION headers are
+/// parsed in place. These spans remain valid until the next receive call.
+///
+/// A regular UDP socket is bound to the same address to reserve the port.
+/// Datagrams to next hops whose link-layer address is not in the kernel's
+/// neighbor table are sent through this socket, which also causes the kernel
+/// to resolve the address for subsequent datagrams. The same applies to next
+/// hops that are not on-link.
+///
+/// \warning The interface must steer the datagrams to the queue the socket is
+/// bound to (see setQueue()). Only one XDPSocket can be bound per interface.
+/// Binding requires the capabilities CAP_NET_ADMIN, CAP_NET_RAW and CAP_BPF
+/// (or CAP_SYS_ADMIN) and Linux 5.9 or later.
+/// \tparam T A sockaddr, like sockaddr_in or sockaddr_in6.
+/// \tparam FrameCount Number of UMEM frames. Must be a power of two.
+template <typename T = IPEndpoint, std::size_t FrameCount = 4096>
+class XDPSocket
+{
+public:
+    static_assert((FrameCount & (FrameCount - 1)) == 0 && FrameCount >= 4);
+    using SockAddr = T;
+    static constexpr std::size_t MAX_BATCH_SIZE = BSDSocket<T>::MAX_BATCH_SIZE;
+    static constexpr std::size_t MAX_GSO_SEGMENTS = BSDSocket<T>::MAX_GSO_SEGMENTS;
+    static constexpr std::size_t MAX_GSO_SIZE = BSDSocket<T>::MAX_GSO_SIZE;
+
+    /// \brief Size of a UMEM frame.
+    static constexpr std::size_t FRAME_SIZE = 2048;
+
+    /// \brief Time after which resolved link-layer addresses are looked up
+    /// again.
+    static constexpr std::chrono::seconds NEIGHBOR_TTL = std::chrono::seconds(30);
+
+    /// \brief Maximum number of cached link-layer addresses.
+    static constexpr std::size_t MAX_NEIGHBORS = 1024;
+
+private:
+    struct Neighbor
+    {
+        std::optional<details::MacAddress> mac;
+        std::chrono::steady_clock::time_point expiry;
+    };
+
+    BSDSocket<T> socket;
+    std::unique_ptr<details::Xsk> xsk;
+    unsigned queue = 0;
+    details::InterfaceInfo iface;
+    generic::IPEndpoint local;
+    std::optional<SockAddr> remote;
+    std::unordered_map<generic::IPAddress, Neighbor> neighbors;
+    std::array<std::uint64_t, MAX_BATCH_SIZE> held = {};
+    std::size_t heldCount = 0;
+    bool nonblocking = false;
+    std::optional<std::chrono::microseconds> recvTimeout;
+
+public:
+    bool isOpen() const { return socket.isOpen(); }
+
+    /// \brief Get the file descriptor of the AF_XDP socket after binding. It
+    /// becomes readable when datagrams are available.
+    NativeHandle getNativeHandle()
+    {
+        return xsk ? xsk->getNativeHandle() : socket.getNativeHandle();
+    }
+
+    /// \brief Set the receive queue of the interface to bind to. Must be called
+    /// before binding. The default is queue 0. Accessible from the SCION
+    /// sockets through `getUnderlay()`.
+    void setQueue(unsigned queue) { this->queue = queue; }
+
+    /// \brief Forget all cached link-layer addresses.
+    void flushNeighbors() { neighbors.clear(); }
+
+    /// \brief Bind to a local address. The address must not be a wildcard
+    /// address.
+    std::error_code bind(const SockAddr& addr)
+    {
+        auto ec = socket.bind(addr);
+        if (ec) return ec;
+        return open();
+    }
+
+    /// \copydoc bind()
+    std::error_code bind_range(
+        const SockAddr& addr, std::uint16_t firstPort, std::uint16_t lastPort)
+    {
+        auto ec = socket.bind_range(addr, firstPort, lastPort);
+        if (ec) return ec;
+        return open();
+    }
+
+    std::error_code connect(const SockAddr& addr)
+    {
+        auto ec = socket.connect(addr);
+        if (!ec) remote = addr;
+        return ec;
+    }
+
+    void close()
+    {
+        heldCount = 0;
+        xsk.reset();
+        socket.close();
+        neighbors.clear();
+    }
+
+    std::error_code setNonblocking(bool nonblocking)
+    {
+        auto ec = socket.setNonblocking(nonblocking);
+        if (!ec) this->nonblocking = nonblocking;
+        return ec;
+    }
+
+    Maybe<SockAddr> getsockname() const
+    {
+        return socket.getsockname();
+    }
+
+    std::error_code getsockopt(int level, int optname, void* optval, socklen_t* optlen)
+    {
+        return socket.getsockopt(level, optname, optval, optlen);
+    }
+
+    /// \brief Set a socket option on the regular UDP socket. Receive timeouts
+    /// (SO_RCVTIMEO) are applied to the AF_XDP socket as well.
+    std::error_code setsockopt(int level, int optname, const void* optval, socklen_t optlen)
+    {
+        auto ec = socket.setsockopt(level, optname, optval, optlen);
+        if (ec) return ec;
+        if (level == SOL_SOCKET && optname == SO_RCVTIMEO && optlen >= sizeof(timeval)) {
+            timeval t;
+            std::memcpy(&t, optval, sizeof(t));
+            auto timeout = std::chrono::seconds(t.tv_sec) + std::chrono::microseconds(t.tv_usec);
+            if (timeout.count() > 0) recvTimeout = timeout;
+            else recvTimeout.reset();
+        }
+        return ec;
+    }
+
+    Maybe<std::span<const std::byte>> send(std::span<const std::byte> buf, int flags = 0)
+    {
+        if (!remote) return Error(ErrorCode::LogicError);
+        return sendto(buf, *remote, flags);
+    }
+
+    Maybe<std::span<const std::byte>> sendto(
+        std::span<const std::byte> buf, const SockAddr& to, int flags = 0)
+    {
+        auto sent = sendmsg(to, flags, buf);
+        if (isError(sent)) return propagateError(sent);
+        return buf.first(get(sent));
+    }
+
+    template <std::convertible_to<std::span<const std::byte>>... Buffers>
+    Maybe<ssize_t> sendmsg(const SockAddr& to, int flags, Buffers&&... bufs)
+    {
+        auto dst = generic::toGenericEp(to);
+        auto mac = resolve(dst.getHost());
+        if (!mac) return socket.sendmsg(to, flags, std::forward<Buffers>(bufs)...);
+        auto n = enqueue(*mac, dst, std::span<const std::byte>(bufs)...);
+        if (isError(n)) return propagateError(n);
+        if (auto ec = xsk->flush(); ec) return Error(ec);
+        return (ssize_t)get(n);
+    }
+
+    /// \copydoc BSDSocket::sendmmsg()
+    template <std::size_t N>
+    Maybe<std::size_t> sendmmsg(
+        std::span<const std::array<std::span<const std::byte>, N>> bufs,
+        std::span<const SockAddr> to, int flags = 0)
+    {
+        auto count = std::min({bufs.size(), to.size(), MAX_BATCH_SIZE});
+        std::size_t n = 0;
+        for (; n < count; ++n) {
+            auto dst = generic::toGenericEp(to[n]);
+            auto mac = resolve(dst.getHost());
+            Maybe<std::size_t> sent;
+            if (mac) {
+                sent = std::apply([&] (const auto&... b) {
+                    return enqueue(*mac, dst, b...);
+                }, bufs[n]);
+            } else {
+                auto r = std::apply([&] (const auto&... b) {
+                    return socket.sendmsg(to[n], flags, b...);
+                }, bufs[n]);
+                if (isError(r)) sent = propagateError(r);
+            }
+            if (isError(sent)) {
+                if (n == 0) return propagateError(sent);
+                break;
+            }
+        }
+        if (xsk) {
+            if (auto ec = xsk->flush(); ec && n == 0) return Error(ec);
+        }
+        return n;
+    }
+
+    /// \copydoc BSDSocket::sendGso()
+    /// The segments are sent as individual frames.
+    Maybe<std::size_t> sendGso(std::span<const std::byte> buf,
+        const SockAddr& to, std::uint16_t segmentSize, int flags = 0)
+    {
+        if (segmentSize == 0) return Error(ErrorCode::InvalidArgument);
+        auto dst = generic::toGenericEp(to);
+        auto mac = resolve(dst.getHost());
+        if (!mac) return socket.sendGso(buf, to, segmentSize, flags);
+        std::size_t offset = 0;
+        while (offset < buf.size()) {
+            auto seg = buf.subspan(offset, std::min<std::size_t>(segmentSize, buf.size() - offset));
+            auto n = enqueue(*mac, dst, seg);
+            if (isError(n)) {
+                if (offset == 0) return propagateError(n);
+                break;
+            }
+            offset += seg.size();
+        }
+        if (auto ec = xsk->flush(); ec && offset == 0) return Error(ec);
+        return offset;
+    }
+
+    /// \brief Receive a datagram. The only supported flag is MSG_DONTWAIT.
+    /// \return UDP payload of the datagram. Points into the UMEM instead of
+    /// `buf` and remains valid until the next receive call.
+    Maybe<std::span<std::byte>> recv(std::span<std::byte> buf, int flags = 0)
+    {
+        SockAddr from;
+        return recvfrom(buf, from, flags);
+    }
+
+    /// \copydoc recv()
+    Maybe<std::span<std::byte>> recvfrom(std::span<std::byte> buf, SockAddr& from, int flags = 0)
+    {
+        std::array<std::span<std::byte>, 1> bufs = {buf};
+        auto n = recvmmsg(bufs, std::span<SockAddr>(&from, 1), flags);
+        if (isError(n)) return propagateError(n);
+        return bufs[0];
+    }
+
+    /// \copydoc recv()
+    /// Datagrams are never coalesced, so `segmentSize` is always set to zero.
+    Maybe<std::span<std::byte>> recvfromGro(std::span<std::byte> buf, SockAddr& from,
+        std::size_t& segmentSize, int flags = 0)
+    {
+        segmentSize = 0;
+        return recvfrom(buf, from, flags);
+    }
+
+    /// \brief Receive multiple datagrams. Blocks until at least one datagram
+    /// is available unless the socket is nonblocking or MSG_DONTWAIT is given.
+    /// \param bufs Replaced by spans of the received UDP payloads. They point
+    /// into the UMEM and remain valid until the next receive call.
+    /// \param from Source addresses of the received datagrams.
+    /// \return Number of datagrams received.
+    Maybe<std::size_t> recvmmsg(
+        std::span<std::span<std::byte>> bufs, std::span<SockAddr> from, int flags = 0)
+    {
+        if ((flags & ~MSG_DONTWAIT) != 0) return Error(ErrorCode::NotImplemented);
+        if (!xsk) return Error(ErrorCode::LogicError);
+        auto count = std::min({bufs.size(), from.size(), MAX_BATCH_SIZE});
+        if (count == 0) return Error(ErrorCode::InvalidArgument);
+        xsk->release(std::span(held.data(), heldCount));
+        heldCount = 0;
+
+        std::array<details::Xsk::Frame, MAX_BATCH_SIZE> frames;
+        bool block = !nonblocking && !(flags & MSG_DONTWAIT);
+        while (true) {
+            auto recvd = xsk->receive(std::span(frames.data(), count), block, recvTimeout);
+            if (isError(recvd)) return propagateError(recvd);
+            std::size_t n = 0;
+            for (std::size_t i = 0; i < get(recvd); ++i) {
+                generic::IPEndpoint src, dst;
+                auto payload = details::parseUnderlayHeaders(frames[i].data, src, dst);
+                // The XDP program only redirects frames for `local`, this is
+                // merely a sanity check
+                if (isError(payload) || dst != local) {
+                    xsk->release(std::span(&frames[i].addr, 1));
+                    continue;
+                }
+                auto ep = generic::toUnderlay<SockAddr>(src);
+                if (isError(ep)) {
+                    xsk->release(std::span(&frames[i].addr, 1));
+                    continue;
+                }
+                bufs[n] = get(payload);
+                from[n] = get(ep);
+                held[heldCount++] = frames[i].addr;
+                ++n;
+            }
+            if (n > 0) return n;
+        }
+    }
+
+private:
+    std::error_code open()
+    {
+        auto bound = socket.getsockname();
+        if (isError(bound)) return getError(bound);
+        local = generic::toGenericEp(get(bound));
+        if (local.getHost().isUnspecified()) {
+            socket.close();
+            return ErrorCode::InvalidArgument;
+        }
+        auto info = details::findInterface(local.getHost());
+        if (isError(info)) {
+            socket.close();
+            return getError(info);
+        }
+        iface = get(info);
+        auto x = std::make_unique<details::Xsk>();
+        auto ec = x->open(iface.index, queue, local, FrameCount, FRAME_SIZE);
+        if (ec) {
+            socket.close();
+            return ec;
+        }
+        xsk = std::move(x);
+        return ErrorCode::Ok;
+    }
+
+    std::optional<details::MacAddress> resolve(const generic::IPAddress& addr)
+    {
+        if (!xsk || addr.is4() != local.getHost().is4()) return std::nullopt;
+        auto now = std::chrono::steady_clock::now();
+        auto i = neighbors.find(addr);
+        if (i == neighbors.end()) {
+            if (neighbors.size() >= MAX_NEIGHBORS) pruneNeighbors(now);
+            i = neighbors.emplace(addr, Neighbor{}).first;
+        }
+        auto& entry = i->second;
+        if (now >= entry.expiry) {
+            entry.mac = details::lookupNeighbor(iface.index, addr);
+            // Retry unresolved neighbors soon, as the kernel resolves them
+            // when the datagram is sent through the regular socket.
+            entry.expiry = now + (entry.mac ? NEIGHBOR_TTL : std::chrono::seconds(1));
+        }
+        return entry.mac;
+    }
+
+    // Remove expired neighbors. Forget all of them if that does not free up
+    // any space.
+    void pruneNeighbors(std::chrono::steady_clock::time_point now)
+    {
+        std::erase_if(neighbors, [now] (const auto& entry) {
+            return now >= entry.second.expiry;
+        });
+        if (neighbors.size() >= MAX_NEIGHBORS) neighbors.clear();
+    }
+
+    template <typename... Buffers>
+    Maybe<std::size_t> enqueue(const details::MacAddress& mac,
+        const generic::IPEndpoint& to, const Buffers&... bufs)
+    {
+        auto hdrSize = details::underlayHeaderSize(to.getHost());
+        auto size = (bufs.size() + ...);
+        if (hdrSize + size > FRAME_SIZE) return Error(ErrorCode::PacketTooBig);
+        auto frame = xsk->allocate();
+        if (isError(frame)) return propagateError(frame);
+        auto offset = hdrSize;
+        ((std::memcpy(frame->data.data() + offset, bufs.data(), bufs.size()),
+            offset += bufs.size()), ...);
+        auto ec = details::writeUnderlayHeaders(
+            frame->data.first(offset), iface.mac, mac, local, to);
+        if (ec) {
+            xsk->discard(frame->addr);
+            return Error(ec);
+        }
+        xsk->submit(frame->addr, offset);
+        return size;
+    }
+};
+
+} // namespace bsd
+} // namespace scion
+#endif // __linux__
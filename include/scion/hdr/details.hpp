@@ -22,9 +22,11 @@
 
 #include "scion/details/bit.hpp"
 
+#include <cassert>
 #include <concepts>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <format>
 #include <span>
 
@@ -51,6 +53,61 @@ auto formatBytes(auto out, std::span<const std::byte> bytes)
     return out;
 }
 
+/// \brief Store an integer in big-endian byte order at an unaligned address.
+template <std::integral T>
+inline void storeBE(std::byte* out, T value)
+{
+    value = scion::details::byteswapBE(value);
+    std::memcpy(out, &value, sizeof(T));
+}
+
+/// \brief Load a big-endian integer from an unaligned address.
+template <std::integral T>
+inline T loadBE(const std::byte* in)
+{
+    T value;
+    std::memcpy(&value, in, sizeof(T));
+    return scion::details::byteswapBE(value);
+}
+
+/// \brief Implementations of the one's complement sum.
+enum class ChecksumImpl
+{
+    Scalar,
+    SSE2,
+    AVX2,
+    NEON,
+};
+
+/// \brief Buffers shorter than this are summed inline, longer buffers are
+/// passed to the vectorized implementation selected at runtime.
+constexpr std::size_t SIMD_CHECKSUM_THRESHOLD = 64;
+
+/// \brief Calculate the one's complement sum of 16-bit words in native byte
+/// order using the fastest implementation supported by the CPU.
+/// \param data Input data. Must be of even length.
+/// \return Sum folded to 16 bits in native byte order.
+std::uint16_t onesComplementSumNative(std::span<const std::byte> data);
+
+/// \brief Copy `src` to `dst` and calculate the one's complement sum of the
+/// copied data like onesComplementSumNative() in the same pass.
+/// \param dst Destination buffer. Must be at least as large as `src`.
+/// \param src Input data. Must be of even length.
+/// \return Sum folded to 16 bits in native byte order.
+std::uint16_t onesComplementSumNativeCopy(
+    std::span<std::byte> dst, std::span<const std::byte> src);
+
+/// \brief Get the implementation used by onesComplementSumNative().
+ChecksumImpl getChecksumImpl();
+
+/// \brief Check whether an implementation is available on this CPU.
+bool isChecksumImplSupported(ChecksumImpl impl);
+
+/// \brief Override the implementation used by onesComplementSumNative(),
+/// e.g., for testing and benchmarking.
+/// \return False if the implementation is not supported.
+bool setChecksumImpl(ChecksumImpl impl);
+
 /// \brief Calculate the one's complemet sum of 16-bit words.
 /// \param buffer Input data the sum is computed over.
 /// \param initial Extra value added into the sum in host byte order.
@@ -62,9 +119,16 @@ inline std::uint16_t onesComplementChecksum(
     using std::uint32_t;
     uint32_t sum = inital;
     auto sizeWords = buffer.size() / 2;
-    std::span<const uint16_t> words(reinterpret_cast<const uint16_t*>(buffer.data()), sizeWords);
-    for (auto word : words) {
-        sum += std::uint32_t(scion::details::byteswapBE(word));
+    if (2*sizeWords >= SIMD_CHECKSUM_THRESHOLD) {
+        // The one's complement sum is independent of byte order up to a
+        // final byte swap (RFC 1071).
+        sum += scion::details::byteswapBE(onesComplementSumNative(buffer.first(2*sizeWords)));
+    } else {
+        std::span<const uint16_t> words(
+            reinterpret_cast<const uint16_t*>(buffer.data()), sizeWords);
+        for (auto word : words) {
+            sum += std::uint32_t(scion::details::byteswapBE(word));
+        }
     }
     if (buffer.size() > 2*sizeWords) {
         sum += std::uint32_t(buffer[buffer.size()-1]) << 8;
@@ -75,6 +139,33 @@ inline std::uint16_t onesComplementChecksum(
     return std::uint16_t(sum);
 }
 
+/// \brief Copy `src` to `dst` while calculating the one's complement sum of
+/// the copied data.
+/// \param dst Destination buffer. Must be at least as large as `src`.
+/// \param src Input data the sum is computed over.
+/// \param initial Extra value added into the sum in host byte order.
+/// \return Sum in host byte order.
+inline std::uint16_t onesComplementChecksumCopy(
+    std::span<std::byte> dst, std::span<const std::byte> src, std::uint32_t initial = 0)
+{
+    assert(dst.size() >= src.size());
+    if (src.size() < SIMD_CHECKSUM_THRESHOLD) {
+        if (!src.empty()) std::memcpy(dst.data(), src.data(), src.size());
+        return onesComplementChecksum(dst.first(src.size()), initial);
+    }
+    auto even = src.size() & ~std::size_t(1);
+    std::uint32_t sum = initial;
+    sum += scion::details::byteswapBE(onesComplementSumNativeCopy(dst, src.first(even)));
+    if (even < src.size()) {
+        dst[even] = src[even];
+        sum += std::uint32_t(src[even]) << 8;
+    }
+    while ((sum & ~0xffffu) != 0) {
+        sum = (sum >> 16) + (sum & 0xffffu);
+    }
+    return std::uint16_t(sum);
+}
+
 /// \brief Calculate the 16-bit one's complement of the one's complement sum of
 /// the given buffer. The result is returned in host byte order. A sum of zero
 /// is replaced by 0xffff.
@@ -88,6 +179,17 @@ inline std::uint16_t internetChecksum(std::span<const std::byte> buffer, std::ui
     return sum;
 }
 
+/// \brief Copy `src` to `dst` and calculate the internet checksum of the
+/// copied data like internetChecksum() touching every byte only once.
+/// \param dst Destination buffer. Must be at least as large as `src`.
+inline std::uint16_t internetChecksumCopy(
+    std::span<std::byte> dst, std::span<const std::byte> src, std::uint32_t initial = 0)
+{
+    std::uint16_t sum = ~onesComplementChecksumCopy(dst, src, initial);
+    if (sum == 0) sum = 0xffff;
+    return sum;
+}
+
 } // namespace details
 } // namespace hdr
 } // namespace scion
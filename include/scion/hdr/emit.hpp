@@ -0,0 +1,117 @@
+// Copyright (c) 2024-2025 Lars-Christian Schulz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "scion/addr/address.hpp"
+#include "scion/addr/generic_ip.hpp"
+#include "scion/hdr/details.hpp"
+#include "scion/hdr/scion.hpp"
+#include "scion/hdr/udp.hpp"
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+
+namespace scion {
+namespace hdr {
+
+// Fast serialization of headers with a layout known at compile time. Fields
+// are written at fixed offsets with word-sized stores instead of going through
+// the bit-level WriteStream. The output is identical to serialize().
+
+namespace details {
+
+template <bool IPv4>
+inline void storeHost(std::byte* out, const generic::IPAddress& host)
+{
+    if constexpr (IPv4) {
+        storeBE(out, host.getIPv4());
+    } else {
+        auto [hi, lo] = host.getIPv6();
+        storeBE(out, hi);
+        storeBE(out + 8, lo);
+    }
+}
+
+} // namespace details
+
+/// \brief Size of the SCION common and address header with the given host
+/// address types.
+template <bool DstIPv4, bool SrcIPv4>
+inline constexpr std::size_t SCION_HDR_SIZE = 12 + 16 + (DstIPv4 ? 4 : 16) + (SrcIPv4 ? 4 : 16);
+
+/// \brief Write the SCION common and address header with IPv4 or IPv6 host
+/// addresses known at compile time.
+/// \pre The host address types of `hdr` match the template arguments.
+template <bool DstIPv4, bool SrcIPv4>
+inline void emitSCION(std::span<std::byte, SCION_HDR_SIZE<DstIPv4, SrcIPv4>> out, const SCION& hdr)
+{
+    using details::storeBE;
+    constexpr auto dstType = (std::uint8_t)(DstIPv4 ? HostAddrType::IPv4 : HostAddrType::IPv6);
+    constexpr auto srcType = (std::uint8_t)(SrcIPv4 ? HostAddrType::IPv4 : HostAddrType::IPv6);
+    constexpr std::size_t srcHostOffset = 28 + (DstIPv4 ? 4 : 16);
+    assert(hdr.dst.getHost().is4() == DstIPv4);
+    assert(hdr.src.getHost().is4() == SrcIPv4);
+
+    auto p = out.data();
+    storeBE(p, (std::uint32_t(SCION::version) << 28)
+        | (std::uint32_t(hdr.qos) << 20) | (hdr.fl & 0xfffffu));
+    storeBE(p + 4, (std::uint32_t(hdr.nh) << 24)
+        | (std::uint32_t(hdr.hlen) << 16) | hdr.plen);
+    storeBE(p + 8, (std::uint32_t(hdr.ptype) << 24)
+        | (std::uint32_t((dstType << 4) | srcType) << 16));
+    storeBE(p + 12, (std::uint64_t)hdr.dst.getIsdAsn());
+    storeBE(p + 20, (std::uint64_t)hdr.src.getIsdAsn());
+    details::storeHost<DstIPv4>(p + 28, hdr.dst.getHost());
+    details::storeHost<SrcIPv4>(p + srcHostOffset, hdr.src.getHost());
+}
+
+/// \brief Write the SCION common and address header selecting the
+/// appropriate specialization of emitSCION() for the address types at
+/// runtime.
+/// \return Number of bytes written. Equal to `hdr.size()`.
+inline std::size_t emitSCION(std::span<std::byte> out, const SCION& hdr)
+{
+    const bool dst4 = hdr.dst.getHost().is4(), src4 = hdr.src.getHost().is4();
+    assert(out.size() >= hdr.size());
+    if (dst4 && src4) {
+        emitSCION<true, true>(out.first<SCION_HDR_SIZE<true, true>>(), hdr);
+    } else if (!dst4 && !src4) {
+        emitSCION<false, false>(out.first<SCION_HDR_SIZE<false, false>>(), hdr);
+    } else if (dst4) {
+        emitSCION<true, false>(out.first<SCION_HDR_SIZE<true, false>>(), hdr);
+    } else {
+        emitSCION<false, true>(out.first<SCION_HDR_SIZE<false, true>>(), hdr);
+    }
+    return hdr.size();
+}
+
+/// \brief Write a UDP header.
+inline void emitUDP(std::span<std::byte, 8> out, const UDP& udp)
+{
+    details::storeBE(out.data(), (std::uint32_t(udp.sport) << 16) | udp.dport);
+    details::storeBE(out.data() + 4, (std::uint32_t(udp.len) << 16) | udp.chksum);
+}
+
+} // namespace hdr
+} // namespace scion
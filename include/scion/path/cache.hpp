@@ -267,7 +267,7 @@ public:
 
     bool handleScmpCallback(
         const Address<generic::IPAddress>& from,
-        const RawPath& path,
+        const RawPathView& path,
         const hdr::ScmpMessage& msg,
         std::span<const std::byte> payload) override
     {
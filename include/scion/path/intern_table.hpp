@@ -0,0 +1,166 @@
+// Copyright (c) 2024-2025 Lars-Christian Schulz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "scion/path/digest.hpp"
+#include "scion/path/raw.hpp"
+
+#include <boost/smart_ptr/intrusive_ptr.hpp>
+#include <boost/smart_ptr/intrusive_ref_counter.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+
+
+namespace scion {
+
+/// \brief Immutable, reference counted raw path owned by a PathInternTable.
+class InternedPath : public RawPath, public boost::intrusive_ref_counter<InternedPath>
+{
+public:
+    explicit InternedPath(const RawPathView& path)
+        : RawPath(path)
+    {
+        // Compute the digest before the path is shared, so that concurrent
+        // calls to digest() only read the cached value.
+        digest();
+    }
+};
+
+using InternedPathPtr = boost::intrusive_ptr<const InternedPath>;
+
+/// \brief Thread-safe table mapping encoded paths to shared path objects.
+///
+/// Servers typically receive packets from many clients over comparatively few
+/// distinct paths. Interning the received paths stores each distinct path only
+/// once and makes comparing interned paths as cheap as comparing pointers.
+/// Paths are looked up by their PathDigest and confirmed by comparing the
+/// encoded bytes, so that paths with the same interfaces but different hop
+/// fields are kept apart.
+///
+/// The table keeps a reference to every interned path. Call collect()
+/// periodically to drop paths that are not referenced anywhere else.
+class PathInternTable
+{
+private:
+    struct Shard
+    {
+        mutable std::shared_mutex mutex;
+        std::unordered_multimap<PathDigest, InternedPathPtr> paths;
+    };
+
+    std::size_t shardCount;
+    std::unique_ptr<Shard[]> shards;
+
+public:
+    /// \param concurrency Number of independently locked partitions of the
+    /// table. Should be around the number of threads using the table.
+    explicit PathInternTable(std::size_t concurrency = 16)
+        : shardCount(std::max<std::size_t>(concurrency, 1))
+        , shards(std::make_unique<Shard[]>(shardCount))
+    {}
+
+    /// \brief Returns the interned copy of `path`. The path is added to the
+    /// table if it is not present yet.
+    InternedPathPtr intern(const RawPathView& path)
+    {
+        auto digest = path.digest();
+        auto& shard = getShard(digest);
+        {
+            std::shared_lock<std::shared_mutex> lock(shard.mutex);
+            if (auto p = findIn(shard, digest, path); p) return p;
+        }
+        // Allocate outside of the lock
+        InternedPathPtr interned(new InternedPath(path));
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        if (auto p = findIn(shard, digest, path); p) return p;
+        shard.paths.emplace(digest, interned);
+        return interned;
+    }
+
+    /// \brief Returns the interned copy of `path` or nullptr if the path is
+    /// not in the table.
+    InternedPathPtr find(const RawPathView& path) const
+    {
+        auto digest = path.digest();
+        auto& shard = getShard(digest);
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        return findIn(shard, digest, path);
+    }
+
+    /// \brief Returns the number of interned paths.
+    std::size_t size() const
+    {
+        std::size_t n = 0;
+        for (std::size_t i = 0; i < shardCount; ++i) {
+            std::shared_lock<std::shared_mutex> lock(shards[i].mutex);
+            n += shards[i].paths.size();
+        }
+        return n;
+    }
+
+    /// \brief Remove paths that are only referenced by the table.
+    /// \return Number of removed paths.
+    std::size_t collect()
+    {
+        std::size_t n = 0;
+        for (std::size_t i = 0; i < shardCount; ++i) {
+            std::unique_lock<std::shared_mutex> lock(shards[i].mutex);
+            n += std::erase_if(shards[i].paths, [] (const auto& entry) {
+                return entry.second->use_count() == 1;
+            });
+        }
+        return n;
+    }
+
+    /// \brief Remove all paths from the table. Paths that are still referenced
+    /// elsewhere stay valid, but are no longer returned by the table.
+    void clear()
+    {
+        for (std::size_t i = 0; i < shardCount; ++i) {
+            std::unique_lock<std::shared_mutex> lock(shards[i].mutex);
+            shards[i].paths.clear();
+        }
+    }
+
+private:
+    Shard& getShard(const PathDigest& digest) const
+    {
+        return shards[std::hash<PathDigest>{}(digest) % shardCount];
+    }
+
+    static InternedPathPtr findIn(
+        const Shard& shard, const PathDigest& digest, const RawPathView& path)
+    {
+        auto [begin, end] = shard.paths.equal_range(digest);
+        for (auto i = begin; i != end; ++i) {
+            if (path == *i->second) return i->second;
+        }
+        return nullptr;
+    }
+};
+
+} // namespace scion
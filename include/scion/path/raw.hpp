@@ -31,7 +31,7 @@
 #include <format>
 #include <iterator>
 #include <ranges>
-#include <span>
+#include <optional>
 #include <span>
 
 
@@ -41,6 +41,8 @@ PathDigest computeDigest(IsdAsn src, std::span<std::pair<std::uint16_t, std::uin
 std::error_code reversePathInPlace(hdr::PathType type, std::span<std::byte> path);
 } // namespace details
 
+class RawPathView;
+
 /// \brief Buffer holding a raw path in its data plane format. The path is
 /// stored in an internal array, no memory is allocated on the heap.
 class RawPath
@@ -68,6 +70,9 @@ public:
         assign(source, target, type, data);
     }
 
+    /// \brief Copy a borrowed path.
+    RawPath(const RawPathView& view);
+
     void assign(IsdAsn source, IsdAsn target, hdr::PathType type, std::span<const std::byte> data)
     {
         if (data.size() > MAX_SIZE) {
@@ -154,17 +159,116 @@ public:
     friend std::ostream& operator<<(std::ostream& stream, const RawPath& rp);
 };
 
+/// \brief Non-owning view of a raw path in its data plane format. Typically
+/// refers to the path header of a packet in a receive buffer and is only
+/// valid as long as the buffer is.
+class RawPathView
+{
+private:
+    IsdAsn m_source, m_target;
+    hdr::PathType m_type = hdr::PathType::Empty;
+    std::span<const std::byte> m_path;
+    mutable std::optional<PathDigest> m_digest;
+
+public:
+    /// \brief Construct an empty path.
+    RawPathView() = default;
+
+    /// \brief Construct from raw header bytes. The bytes are not copied.
+    RawPathView(IsdAsn source, IsdAsn target, hdr::PathType type, std::span<const std::byte> data)
+        : m_source(source), m_target(target), m_type(type), m_path(data)
+    {}
+
+    /// \brief View the path stored in a RawPath.
+    RawPathView(const RawPath& path)
+        : m_source(path.firstAS()), m_target(path.lastAS()), m_type(path.type())
+        , m_path(path.encoded())
+    {}
+
+    void assign(IsdAsn source, IsdAsn target, hdr::PathType type, std::span<const std::byte> data)
+    {
+        m_source = source;
+        m_target = target;
+        m_type = type;
+        m_path = data;
+        m_digest = std::nullopt;
+    }
+
+    bool operator==(const RawPathView& other) const
+    {
+        return m_source == other.m_source && m_target == other.m_target
+            && m_type == other.m_type
+            && std::ranges::equal(encoded(), other.encoded());
+    }
+
+    friend bool operator==(const RawPathView& a, const RawPath& b)
+    {
+        return a == RawPathView(b);
+    }
+
+    /// \copydoc RawPath::type()
+    hdr::PathType type() const { return m_type; }
+
+    /// \copydoc RawPath::empty()
+    bool empty() const { return m_type == hdr::PathType::Empty; }
+
+    /// \copydoc RawPath::size()
+    std::size_t size() const { return m_path.size(); }
+
+    /// \copydoc RawPath::firstAS()
+    IsdAsn firstAS() const { return m_source; }
+
+    /// \copydoc RawPath::lastAS()
+    IsdAsn lastAS() const { return m_target; }
+
+    /// \copydoc RawPath::hops()
+    auto hops() const
+    {
+        return RawHopRange<RawPathView>(*this);
+    }
+
+    /// \copydoc RawPath::digest()
+    PathDigest digest() const;
+
+    /// \copydoc RawPath::encoded()
+    std::span<const std::byte> encoded() const { return m_path; }
+
+    /// \brief Copy the path to `buf` and reverse it there. On success the
+    /// view refers to the reversed path in `buf`, otherwise it is unchanged.
+    /// Supported path types are Empty and SCION paths.
+    /// \return BufferTooSmall if `buf` is smaller than the path.
+    std::error_code reverseInto(std::span<std::byte> buf)
+    {
+        if (buf.size() < m_path.size()) return ErrorCode::BufferTooSmall;
+        auto reversed = buf.first(m_path.size());
+        std::ranges::copy(m_path, reversed.begin());
+        auto err = details::reversePathInPlace(m_type, reversed);
+        if (err) return err;
+        std::swap(m_source, m_target);
+        m_path = reversed;
+        m_digest = std::nullopt;
+        return ErrorCode::Ok;
+    }
+
+    friend std::ostream& operator<<(std::ostream& stream, const RawPathView& rp);
+};
+
+inline RawPath::RawPath(const RawPathView& view)
+{
+    assign(view.firstAS(), view.lastAS(), view.type(), view.encoded());
+}
+
 } // namespace scion
 
 template <>
-struct std::formatter<scion::RawPath>
+struct std::formatter<scion::RawPathView>
 {
     constexpr auto parse(auto& ctx)
     {
         return ctx.begin();
     }
 
-    auto format(const scion::RawPath& rp, auto& ctx) const
+    auto format(const scion::RawPathView& rp, auto& ctx) const
     {
         if (rp.empty()) return std::format_to(ctx.out(), "empty");
         auto out = std::format_to(ctx.out(), "{} ", rp.firstAS());
@@ -175,6 +279,15 @@ struct std::formatter<scion::RawPath>
     }
 };
 
+template <>
+struct std::formatter<scion::RawPath> : std::formatter<scion::RawPathView>
+{
+    auto format(const scion::RawPath& rp, auto& ctx) const
+    {
+        return std::formatter<scion::RawPathView>::format(rp, ctx);
+    }
+};
+
 template <>
 struct std::hash<scion::RawPath>
 {
@@ -183,3 +296,12 @@ struct std::hash<scion::RawPath>
         return std::hash<scion::PathDigest>{}(rp.digest());
     }
 };
+
+template <>
+struct std::hash<scion::RawPathView>
+{
+    std::size_t operator()(const scion::RawPathView& rp) const noexcept
+    {
+        return std::hash<scion::PathDigest>{}(rp.digest());
+    }
+};
@@ -36,7 +36,7 @@ class ScmpHandler
 public:
     void handleScmp(
         const Address<generic::IPAddress>& from,
-        const RawPath& path,
+        const RawPathView& path,
         const hdr::ScmpMessage& msg,
         std::span<const std::byte> payload)
     {
@@ -53,7 +53,7 @@ public:
 private:
     virtual bool handleScmpCallback(
         const Address<generic::IPAddress>& from,
-        const RawPath& path,
+        const RawPathView& path,
         const hdr::ScmpMessage& msg,
         std::span<const std::byte> payload) = 0;
 };
@@ -0,0 +1,78 @@
+// Copyright (c) 2024-2025 Lars-Christian Schulz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "scion/hdr/details.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+
+namespace scion {
+
+/// \brief Controls verification of the L4 checksum of received packets.
+enum class ChecksumPolicy
+{
+    /// Verify the checksum of every packet.
+    Verify,
+    /// Do not verify checksums. Suitable for trusted networks with link
+    /// layer integrity protection.
+    Skip,
+    /// Verify the checksum of one in every N packets, see
+    /// ScionPackager::setChecksumPolicy().
+    Sample,
+    /// Do not verify checksums on receive. Instead the partial checksum of
+    /// the headers is returned as DeferredChecksum, so that the application
+    /// can verify the payload when it actually consumes it.
+    /// SCMP messages are still verified immediately.
+    Defer,
+};
+
+/// \brief Checksum of a received packet whose verification was deferred.
+///
+/// Holds the sum of the SCION pseudo header and the L4 header. A default
+/// constructed instance represents a packet that does not need verification.
+class DeferredChecksum
+{
+public:
+    DeferredChecksum() = default;
+    explicit DeferredChecksum(std::uint32_t partial)
+        : partial(partial), pending(true)
+    {}
+
+    /// \brief Returns true if the checksum was not verified on receive.
+    bool isPending() const { return pending; }
+
+    /// \brief Verify the checksum of the given payload. Returns true if the
+    /// checksum is correct or verification was not deferred.
+    bool verify(std::span<const std::byte> payload) const
+    {
+        if (!pending) return true;
+        return hdr::details::internetChecksum(payload, partial) == 0xffffu;
+    }
+
+private:
+    std::uint32_t partial = 0;
+    bool pending = false;
+};
+
+} // namespace scion
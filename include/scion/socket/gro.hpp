@@ -0,0 +1,75 @@
+// Copyright (c) 2024-2025 Lars-Christian Schulz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <span>
+
+
+namespace scion {
+namespace details {
+
+/// \brief Splits a datagram coalesced by UDP generic receive offload (GRO)
+/// into the original underlay datagrams. Keeps track of the datagrams that have
+/// not been consumed yet between receive calls.
+/// \tparam UnderlayEp Type of underlay endpoints.
+template <typename UnderlayEp>
+class GroSegments
+{
+private:
+    std::span<std::byte> remaining;
+    std::size_t segmentSize = 0;
+    UnderlayEp source = {};
+
+public:
+    /// \brief Set a newly received buffer.
+    /// \param buf Received data.
+    /// \param segSize Size of the coalesced datagrams. All datagrams except
+    /// for the last one have this size. Zero if `buf` is a single datagram.
+    /// \param ulSource Underlay source address of all datagrams.
+    void assign(std::span<std::byte> buf, std::size_t segSize, const UnderlayEp& ulSource)
+    {
+        remaining = buf;
+        segmentSize = segSize > 0 ? segSize : buf.size();
+        source = ulSource;
+    }
+
+    /// \brief Discard all remaining datagrams.
+    void clear() { remaining = std::span<std::byte>(); }
+
+    /// \brief Determine whether all datagrams have been consumed.
+    bool empty() const { return remaining.empty(); }
+
+    /// \brief Pop the next datagram.
+    /// \param ulSource Receives the datagram's underlay source address.
+    std::span<std::byte> next(UnderlayEp& ulSource)
+    {
+        auto n = std::min(segmentSize, remaining.size());
+        auto seg = remaining.first(n);
+        remaining = remaining.subspan(n);
+        ulSource = source;
+        return seg;
+    }
+};
+
+} // namespace details
+} // namespace scion
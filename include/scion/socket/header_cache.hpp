@@ -26,13 +26,16 @@
 #include "scion/details/debug.hpp"
 #include "scion/error_codes.hpp"
 #include "scion/extensions/extension.hpp"
+#include "scion/hdr/emit.hpp"
 #include "scion/hdr/scion.hpp"
 #include "scion/hdr/scmp.hpp"
 #include "scion/hdr/udp.hpp"
 
+#include <algorithm>
 #include <cstdint>
 #include <memory>
 #include <span>
+#include <type_traits>
 #include <vector>
 
 
@@ -47,6 +50,8 @@ private:
 #endif
     std::uint16_t payloadSize = 0;
     std::uint16_t nhOffset = 0;
+    std::uint16_t pathOffset = 0;
+    std::uint16_t pathSize = 0;
     std::uint16_t l4Offset = 0;
     std::vector<std::byte, Alloc> buffer;
 
@@ -59,6 +64,15 @@ public:
 
     auto get() const { return std::span<const std::byte>(buffer); }
 
+    /// \brief Returns the encoded path contained in the cached headers.
+    auto getPath() const
+    {
+        return std::span<const std::byte>(buffer).subspan(pathOffset, pathSize);
+    }
+
+    /// \brief Returns the cached L4 header.
+    auto getL4() const { return std::span<const std::byte>(buffer).subspan(l4Offset); }
+
     /// \brief Build headers from scratch.
     template <
         typename Path,
@@ -72,6 +86,68 @@ public:
         ExtRange&& extensions,
         L4&& l4,
         std::span<const std::byte> payload)
+    {
+        return buildImpl(tc, to, from, path, std::forward<ExtRange>(extensions),
+            std::forward<L4>(l4), payload, nullptr);
+    }
+
+    /// \brief Build headers from scratch and copy the payload to `dst`. The
+    /// checksum is computed during the copy, so that the payload is only read
+    /// once.
+    /// \param dst Destination of the payload, e.g., located right after the
+    /// headers in a send buffer. Must be at least as large as the payload.
+    template <
+        typename Path,
+        ext::extension_range ExtRange,
+        typename L4>
+    std::error_code build(
+        std::uint8_t tc,
+        const Endpoint<generic::IPEndpoint>& to,
+        const Endpoint<generic::IPEndpoint>& from,
+        const Path& path,
+        ExtRange&& extensions,
+        L4&& l4,
+        std::span<const std::byte> payload,
+        std::span<std::byte> dst)
+    {
+        if (dst.size() < payload.size()) return ErrorCode::BufferTooSmall;
+        return buildImpl(tc, to, from, path, std::forward<ExtRange>(extensions),
+            std::forward<L4>(l4), payload, dst.data());
+    }
+
+    /// \brief Update headers in-place with a new payload. (won't update the flow label)
+    template <typename L4>
+    std::error_code updatePayload(L4&& l4, std::span<const std::byte> payload)
+    {
+        return updatePayloadImpl(std::forward<L4>(l4), payload, nullptr);
+    }
+
+    /// \brief Update headers in-place with a new payload and copy the payload
+    /// to `dst` computing the checksum in the same pass.
+    /// \param dst Destination of the payload. Must be at least as large as the
+    /// payload.
+    template <typename L4>
+    std::error_code updatePayload(
+        L4&& l4, std::span<const std::byte> payload, std::span<std::byte> dst)
+    {
+        if (dst.size() < payload.size()) return ErrorCode::BufferTooSmall;
+        return updatePayloadImpl(std::forward<L4>(l4), payload, dst.data());
+    }
+
+private:
+    template <
+        typename Path,
+        ext::extension_range ExtRange,
+        typename L4>
+    std::error_code buildImpl(
+        std::uint8_t tc,
+        const Endpoint<generic::IPEndpoint>& to,
+        const Endpoint<generic::IPEndpoint>& from,
+        const Path& path,
+        ExtRange&& extensions,
+        L4&& l4,
+        std::span<const std::byte> payload,
+        std::byte* copyTo)
     {
         // Initialize SCION header
         hdr::SCION scHdr;
@@ -97,25 +173,34 @@ public:
         scHdr.plen = (std::uint16_t)(hbhExtSize + e2eExtSize + l4.size() + payload.size());
         scHdr.fl = computeFlowLabel(scHdr, l4);
     #ifndef SCION_DISABLE_CHECKSUM
-        l4.chksum = checksum(scHdr, l4, payload);
+        l4.chksum = checksum(scHdr, l4, payload, copyTo);
+    #else
+        if (copyTo) std::ranges::copy(payload, copyTo);
     #endif
 
         // Serialize headers
         buffer.resize(4*scHdr.hlen + hbhExtSize + e2eExtSize + l4.size());
+        pathOffset = (std::uint16_t)scHdr.size();
+        pathSize = (std::uint16_t)path.size();
+        payloadSize = (std::uint16_t)payload.size();
+        if constexpr (std::is_same_v<std::remove_cvref_t<L4>, hdr::UDP>) {
+            if (hbhExtSize == 0 && e2eExtSize == 0) {
+                emitHeaders(scHdr, path, l4);
+                return ErrorCode::Ok;
+            }
+        }
         WriteStream ws(buffer);
         SCION_STREAM_ERROR err;
         if (!writeHeaders(ws, scHdr, path, extensions, l4, err)) {
             SCION_DEBUG_PRINT(err << std::endl);
             return ErrorCode::LogicError;
         }
-
-        payloadSize = (std::uint16_t)payload.size();
         return ErrorCode::Ok;
     }
 
-    /// \brief Update headers in-place with a new payload. (won't update the flow label)
     template <typename L4>
-    std::error_code updatePayload(L4&& l4, std::span<const std::byte> payload)
+    std::error_code updatePayloadImpl(
+        L4&& l4, std::span<const std::byte> payload, std::byte* copyTo)
     {
         std::uint16_t oldLen = 0;
         auto nh = hdr::ScionProto(0);
@@ -138,11 +223,28 @@ public:
         scionHdrChksum += (std::uint32_t)std::remove_reference<L4>::type::PROTO - (std::uint32_t)nh;
         scionHdrChksum += newLen - oldLen;
         l4.chksum = 0;
-        l4.chksum = hdr::details::internetChecksum(payload, scionHdrChksum + l4.checksum());
+        if (copyTo) {
+            l4.chksum = hdr::details::internetChecksumCopy(
+                std::span<std::byte>(copyTo, payload.size()), payload,
+                scionHdrChksum + l4.checksum());
+        } else {
+            l4.chksum = hdr::details::internetChecksum(payload, scionHdrChksum + l4.checksum());
+        }
+    #else
+        if (copyTo) std::ranges::copy(payload, copyTo);
     #endif
 
         // Update headers
         buffer.resize(l4Offset + l4.size());
+        if constexpr (std::is_same_v<std::remove_cvref_t<L4>, hdr::UDP>) {
+            if (nhOffset == 4) {
+                auto out = std::span<std::byte>(buffer);
+                hdr::details::storeBE(out.data() + 4, (std::uint8_t)hdr::ScionProto::UDP);
+                hdr::details::storeBE(out.data() + 6, newLen);
+                hdr::emitUDP(out.subspan(l4Offset).first<8>(), l4);
+                return ErrorCode::Ok;
+            }
+        }
         WriteStream ws(buffer);
         SCION_STREAM_ERROR err;
         if (!updateHeaders(ws, newLen, l4, err)) {
@@ -152,7 +254,18 @@ public:
         return ErrorCode::Ok;
     }
 
-private:
+    /// \brief Fast path for writing SCION and UDP headers without extensions.
+    template <typename Path>
+    void emitHeaders(const hdr::SCION& scHdr, const Path& path, const hdr::UDP& udp)
+    {
+        auto out = std::span<std::byte>(buffer);
+        hdr::emitSCION(out, scHdr);
+        std::ranges::copy(path.encoded(), out.begin() + pathOffset);
+        nhOffset = 4;
+        l4Offset = (std::uint16_t)(pathOffset + pathSize);
+        hdr::emitUDP(out.subspan(l4Offset).first<8>(), udp);
+    }
+
     template <typename Path, ext::extension_range ExtRange, typename L4>
     bool writeHeaders(WriteStream& ws,
         const hdr::SCION& scHdr,
@@ -222,16 +335,21 @@ private:
         return (std::uint32_t)(h1(scHdr.dst) ^ h1(scHdr.src) ^ l4.flowLabel());
     }
 
-    /// \brief Compute the L4 checksum.
+    /// \brief Compute the L4 checksum. Copies the payload to `copyTo` if not
+    /// null.
     template <typename L4>
-    std::uint16_t checksum(
-        const hdr::SCION& scHdr, const L4& l4, std::span<const std::byte> payload)
+    std::uint16_t checksum(const hdr::SCION& scHdr, const L4& l4,
+        std::span<const std::byte> payload, std::byte* copyTo)
     {
         auto chksum = scHdr.checksum((std::uint16_t)(l4.size() + payload.size()), L4::PROTO);
     #ifndef SCION_DISABLE_CHECKSUM
         scionHdrChksum = chksum;
     #endif
         chksum += l4.checksum();
+        if (copyTo) {
+            return hdr::details::internetChecksumCopy(
+                std::span<std::byte>(copyTo, payload.size()), payload, chksum);
+        }
         return hdr::details::internetChecksum(payload, chksum);
     }
 };
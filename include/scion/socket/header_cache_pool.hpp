@@ -0,0 +1,309 @@
+// Copyright (c) 2024-2025 Lars-Christian Schulz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#pragma once
+
+#include "scion/addr/endpoint.hpp"
+#include "scion/addr/generic_ip.hpp"
+#include "scion/error_codes.hpp"
+#include "scion/extensions/extension.hpp"
+#include "scion/path/digest.hpp"
+#include "scion/socket/header_cache.hpp"
+#include "scion/socket/packager.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <span>
+#include <type_traits>
+#include <unordered_map>
+
+
+namespace scion {
+namespace details {
+
+/// \brief Identifies cached headers by remote endpoint and path digest.
+struct HeaderKey
+{
+    Endpoint<generic::IPEndpoint> remote;
+    PathDigest path;
+    bool operator==(const HeaderKey&) const = default;
+};
+
+struct HeaderKeyHasher
+{
+    std::size_t operator()(const HeaderKey& key) const noexcept
+    {
+        using Remote = decltype(key.remote);
+        return std::hash<Remote>{}(key.remote) ^ std::hash<PathDigest>{}(key.path);
+    }
+};
+
+struct HeaderStats
+{
+    /// \brief Number of packets sent with cached headers.
+    std::uint64_t hits = 0;
+    /// \brief Number of packets for which headers had to be built.
+    std::uint64_t misses = 0;
+    /// \brief Number of entries evicted to make space for new ones.
+    std::uint64_t evictions = 0;
+};
+
+/// \brief Header caches keyed by HeaderKey in least recently used order.
+/// Common part of HeaderCachePool and SessionTable.
+/// \tparam Entry Entry type. Must be movable and have the members `key` of
+/// type HeaderKey and `cache` of type HeaderCache. The key of an entry must
+/// not be modified while it is stored.
+template <typename Entry>
+class HeaderLru
+{
+private:
+    using List = std::list<Entry>;
+    using Index = std::unordered_map<HeaderKey, typename List::iterator, HeaderKeyHasher>;
+
+    // Entries in order of last use, most recently used first.
+    List lru;
+    Index index;
+    HeaderStats stats;
+
+public:
+    /// \brief Returns the current number of entries.
+    std::size_t size() const { return index.size(); }
+
+    /// \brief Returns whether there are no entries.
+    bool empty() const { return index.empty(); }
+
+    /// \brief Reserve space in the index for `n` entries.
+    void reserve(std::size_t n) { index.reserve(n); }
+
+    /// \brief Returns cache hit, miss, and eviction counters.
+    const HeaderStats& getStats() const { return stats; }
+
+    /// \brief Reset all counters to zero.
+    void resetStats() { stats = HeaderStats{}; }
+
+    /// \brief Look up an entry without updating the LRU order.
+    /// \return Pointer to the entry or nullptr if there is none.
+    const Entry* find(const HeaderKey& key) const
+    {
+        if (auto i = index.find(key); i != index.end()) return &*i->second;
+        return nullptr;
+    }
+
+    /// \brief Look up an entry and mark it as most recently used.
+    /// \return Pointer to the entry or nullptr if there is none.
+    Entry* touch(const HeaderKey& key)
+    {
+        if (auto i = index.find(key); i != index.end()) {
+            lru.splice(lru.begin(), lru, i->second);
+            return &*i->second;
+        }
+        return nullptr;
+    }
+
+    /// \brief Returns the least recently used entry. There must be at least
+    /// one entry.
+    Entry& oldest() { return lru.back(); }
+
+    /// \brief Insert a new most recently used entry. An entry with the same
+    /// key must not exist.
+    Entry& insert(Entry&& entry)
+    {
+        lru.push_front(std::move(entry));
+        index.emplace(lru.front().key, lru.begin());
+        return lru.front();
+    }
+
+    /// \brief Reassign the least recently used entry to `key` and make it the
+    /// most recently used one. Keeps the entry's buffers. There must be at
+    /// least one entry and none with the same key.
+    Entry& recycle(const HeaderKey& key)
+    {
+        auto& last = lru.back();
+        index.erase(last.key);
+        last.key = key;
+        lru.splice(lru.begin(), lru, std::prev(lru.end()));
+        index.emplace(key, lru.begin());
+        ++stats.evictions;
+        return last;
+    }
+
+    /// \brief Remove the least recently used entry to free memory.
+    void evict()
+    {
+        erase(lru.back().key);
+        ++stats.evictions;
+    }
+
+    /// \brief Remove the entry with the given key if present.
+    void erase(const HeaderKey& key)
+    {
+        if (auto i = index.find(key); i != index.end()) {
+            lru.erase(i->second);
+            index.erase(i);
+        }
+    }
+
+    /// \brief Remove all entries.
+    void clear()
+    {
+        index.clear();
+        lru.clear();
+    }
+
+    /// \brief Update the cached headers of `entry` for sending `payload`. The
+    /// entry is removed if this fails.
+    template <typename L4>
+    Maybe<std::span<const std::byte>> update(
+        ScionPackager& packager, Entry& entry, L4&& l4, std::span<const std::byte> payload)
+    {
+        if constexpr (!std::is_convertible_v<L4, hdr::SCMP>) {
+            l4.sport = packager.getLocalEp().getPort();
+            l4.dport = entry.key.remote.getPort();
+        }
+        if (auto ec = packager.pack(entry.cache, std::forward<L4>(l4), payload); ec) {
+            erase(entry.key);
+            return Error(ec);
+        }
+        ++stats.hits;
+        return entry.cache.get();
+    }
+
+    /// \brief Build new headers in `entry` for sending `payload` to the
+    /// entry's remote endpoint via `path`. The entry is removed if this fails,
+    /// partially built headers are never kept.
+    template <typename Path, typename L4>
+    Maybe<std::span<const std::byte>> build(
+        ScionPackager& packager,
+        Entry& entry,
+        const Path& path,
+        L4&& l4,
+        std::span<const std::byte> payload)
+    {
+        ++stats.misses;
+        auto ec = packager.pack(entry.cache, &entry.key.remote, path,
+            ext::NoExtensions, std::forward<L4>(l4), payload);
+        if (ec) {
+            erase(entry.key);
+            return Error(ec);
+        }
+        return entry.cache.get();
+    }
+};
+
+} // namespace details
+
+/// \brief Bounded set of header caches for sending to many destinations, e.g.,
+/// a server replying to many clients.
+///
+/// Entries are keyed by remote endpoint and path digest and evicted in least
+/// recently used order. If an entry for the destination exists, only the
+/// length and checksum fields of the cached headers are updated for the new
+/// payload. Since the path digest only identifies the sequence of interfaces,
+/// the encoded path is compared to the cached one as well, so that paths with
+/// refreshed hop fields are not sent with stale headers.
+///
+/// Cached headers are not updated if the local endpoint or traffic class of the
+/// packager change. Call clear() in this case.
+template <typename Alloc = std::allocator<std::byte>>
+class HeaderCachePool
+{
+public:
+    using Endpoint = scion::Endpoint<generic::IPEndpoint>;
+    using Stats = details::HeaderStats;
+
+private:
+    struct Entry
+    {
+        details::HeaderKey key;
+        HeaderCache<Alloc> cache;
+    };
+
+    std::size_t maxEntries;
+    Alloc alloc;
+    details::HeaderLru<Entry> entries;
+
+public:
+    /// \param capacity Maximum number of cached destinations. Must be at
+    /// least one.
+    explicit HeaderCachePool(std::size_t capacity, Alloc alloc = Alloc())
+        : maxEntries(std::max<std::size_t>(capacity, 1)), alloc(alloc)
+    {
+        entries.reserve(maxEntries);
+    }
+
+    /// \brief Returns the maximum number of entries.
+    std::size_t capacity() const { return maxEntries; }
+
+    /// \brief Returns the current number of entries.
+    std::size_t size() const { return entries.size(); }
+
+    /// \brief Returns cache hit and miss counters.
+    const Stats& getStats() const { return entries.getStats(); }
+
+    /// \brief Reset all counters to zero.
+    void resetStats() { entries.resetStats(); }
+
+    /// \brief Returns whether headers for the given destination are cached.
+    /// Does not update the LRU order.
+    template <typename Path>
+    bool contains(const Endpoint& remote, const Path& path) const
+    {
+        return entries.find(details::HeaderKey{remote, path.digest()}) != nullptr;
+    }
+
+    /// \brief Remove the entry for the given destination if present.
+    template <typename Path>
+    void erase(const Endpoint& remote, const Path& path)
+    {
+        entries.erase(details::HeaderKey{remote, path.digest()});
+    }
+
+    /// \brief Remove all entries.
+    void clear() { entries.clear(); }
+
+    /// \brief Prepare the headers for sending `payload` to `to` via `path`.
+    /// Builds new headers using the packager if the destination is not in the
+    /// pool, otherwise the cached headers are updated with the new payload.
+    /// \return Returns the headers to be sent in front of the payload. The
+    /// returned buffer is valid until the next call to a non-const method.
+    template <typename Path, typename L4>
+    Maybe<std::span<const std::byte>> pack(
+        ScionPackager& packager,
+        const Endpoint& to,
+        const Path& path,
+        L4&& l4,
+        std::span<const std::byte> payload)
+    {
+        details::HeaderKey key{to, path.digest()};
+        if (auto entry = entries.touch(key); entry) {
+            if (std::ranges::equal(entry->cache.getPath(), path.encoded()))
+                return entries.update(packager, *entry, std::forward<L4>(l4), payload);
+            return entries.build(packager, *entry, path, std::forward<L4>(l4), payload);
+        }
+        // Reuse the least recently used entry to keep its buffer
+        auto& entry = entries.size() >= maxEntries ?
+            entries.recycle(key) : entries.insert(Entry{key, HeaderCache<Alloc>(alloc)});
+        return entries.build(packager, entry, path, std::forward<L4>(l4), payload);
+    }
+};
+
+} // namespace scion
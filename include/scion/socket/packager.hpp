@@ -28,15 +28,21 @@
 #include "scion/error_codes.hpp"
 #include "scion/extensions/extension.hpp"
 #include "scion/hdr/details.hpp"
+#include "scion/hdr/emit.hpp"
 #include "scion/hdr/scion.hpp"
 #include "scion/hdr/scmp.hpp"
+#include "scion/hdr/udp.hpp"
+#include "scion/path/intern_table.hpp"
 #include "scion/path/raw.hpp"
+#include "scion/socket/checksum_policy.hpp"
 #include "scion/socket/header_cache.hpp"
 #include "scion/socket/parsed_packet.hpp"
 
+#include <algorithm>
 #include <array>
 #include <concepts>
 #include <functional>
+#include <limits>
 #include <memory>
 #include <span>
 #include <vector>
@@ -47,7 +53,7 @@ namespace scion {
 template <typename F>
 concept ScmpCallback = std::invocable<F,
     const Address<generic::IPAddress>&,
-    const RawPath&,
+    const RawPathView&,
     const hdr::ScmpMessage&,
     std::span<const std::byte>>;
 
@@ -55,7 +61,7 @@ struct DefaultScmpCallback
 {
     void operator()(
         const Address<generic::IPAddress>& from,
-        const RawPath& path,
+        const RawPathView& path,
         const hdr::ScmpMessage& msg,
         std::span<const std::byte> payload)
     {
@@ -71,6 +77,38 @@ struct DefaultScmpCallback
     }
 };
 
+/// \brief Optional output parameter receiving the path of an unpacked packet.
+/// Refers to either a RawPath the path is copied to, to a RawPathView that
+/// borrows the path from the receive buffer, or to a handle receiving the
+/// path from a PathInternTable.
+class RawPathOutput
+{
+public:
+    RawPathOutput(std::nullptr_t) {}
+    RawPathOutput(RawPath* path) : owned(path) {}
+    RawPathOutput(RawPathView* path) : view(path) {}
+    RawPathOutput(RawPath& path) : owned(&path) {}
+    RawPathOutput(RawPathView& path) : view(&path) {}
+    RawPathOutput(PathInternTable& table, InternedPathPtr& path)
+        : table(&table), interned(&path)
+    {}
+
+    explicit operator bool() const { return owned || view || interned; }
+
+    void assign(IsdAsn source, IsdAsn target, hdr::PathType type, std::span<const std::byte> data)
+    {
+        if (owned) owned->assign(source, target, type, data);
+        else if (view) view->assign(source, target, type, data);
+        else if (interned) *interned = table->intern(RawPathView(source, target, type, data));
+    }
+
+private:
+    RawPath* owned = nullptr;
+    RawPathView* view = nullptr;
+    PathInternTable* table = nullptr;
+    InternedPathPtr* interned = nullptr;
+};
+
 /// \brief Contains SCION packet processing logic.
 class ScionPackager
 {
@@ -83,6 +121,24 @@ public:
         std::span<const std::byte> payload;
     };
 
+    /// \brief Output storage for unpackBatch(). All spans are indexed like the
+    /// input buffers. Optional outputs are skipped if their span is empty.
+    struct BatchResult
+    {
+        /// \brief Payloads of valid packets. Empty for invalid packets.
+        std::span<std::span<const std::byte>> payloads;
+        /// \brief Outcome for each packet. Same codes as returned by unpack().
+        std::span<std::error_code> errors;
+        /// \brief Optional. Source addresses from the SCION header.
+        std::span<Endpoint> from = {};
+        /// \brief Optional. Paths from the SCION header. Not reversed. The
+        /// views point into the input buffers.
+        std::span<RawPathView> paths = {};
+        /// \brief Optional. Checksums to verify later if the checksum policy
+        /// is ChecksumPolicy::Defer.
+        std::span<DeferredChecksum> checksums = {};
+    };
+
     /// \brief Set the local address. The local address is used as source
     /// address for sent packets and to filter received packets.
     ///
@@ -111,6 +167,34 @@ public:
 
     Endpoint getRemoteEp() const { return remote; }
 
+    /// \brief Indicate that the underlay socket is bound to a wildcard IP
+    /// address. The host address of the local endpoint is then only used as
+    /// default source address. Received packets are matched against the
+    /// underlay destination address passed to unpack() instead.
+    void setWildcardLocal(bool wildcard) { wildcardLocal = wildcard; }
+
+    bool isWildcardLocal() const { return wildcardLocal; }
+
+    /// \brief Set how the L4 checksum of received packets is verified.
+    /// Defaults to ChecksumPolicy::Verify, or ChecksumPolicy::Skip if
+    /// SCION_DISABLE_CHECKSUM is defined.
+    /// \param interval Verify one in every `interval` packets if the policy
+    /// is ChecksumPolicy::Sample. Ignored by the other policies.
+    std::error_code setChecksumPolicy(ChecksumPolicy policy, std::uint32_t interval = 1)
+    {
+        if (interval == 0) return ErrorCode::InvalidArgument;
+        checksumPolicy = policy;
+        sampleInterval = interval;
+        sampleCounter = 0;
+        return ErrorCode::Ok;
+    }
+
+    ChecksumPolicy getChecksumPolicy() const { return checksumPolicy; }
+
+    /// \brief Returns the checksum of the last packet returned by unpack() if
+    /// its verification was deferred by ChecksumPolicy::Defer.
+    DeferredChecksum getDeferredChecksum() const { return deferredChecksum; }
+
     /// \brief Set the traffic class (QoS field) for outgoing SCION packets.
     void setTrafficClass(std::uint8_t tc) { trafficClass = tc; }
 
@@ -133,6 +217,9 @@ public:
     ///     Next header after SCION.
     /// \param payload
     ///     Intended packet payload.
+    /// \param srcHost
+    ///     Optional source host address overriding the host address of the
+    ///     local endpoint. Must be a local address of the underlay socket.
     template <
         typename Path,
         ext::extension_range ExtRange,
@@ -144,7 +231,8 @@ public:
         const Path& path,
         ExtRange&& extensions,
         L4&& l4,
-        std::span<const std::byte> payload)
+        std::span<const std::byte> payload,
+        const generic::IPAddress* srcHost = nullptr)
     {
         // A concrete local address must have been bound.
         if (local.getHost().isUnspecified() || local.getPort() == 0) {
@@ -162,6 +250,10 @@ public:
             }
             from = local;
         }
+        if (srcHost) {
+            if (srcHost->isUnspecified()) return ErrorCode::InvalidArgument;
+            from = Endpoint(from.getIsdAsn(), *srcHost, from.getPort());
+        }
 
         // Determine destination address
         if (!to) {
@@ -191,6 +283,112 @@ public:
         return headers.updatePayload(std::forward<L4>(l4), payload);
     }
 
+    /// \brief Same as pack() above, but additionally copies the payload to
+    /// `dst`. The L4 checksum is computed while copying, so that the payload
+    /// is only read once. Typically, `dst` is located directly after the
+    /// headers in a send buffer.
+    template <typename L4, typename Alloc>
+    std::error_code pack(
+        HeaderCache<Alloc>& headers,
+        L4&& l4,
+        std::span<const std::byte> payload,
+        std::span<std::byte> dst)
+    {
+        return headers.updatePayload(std::forward<L4>(l4), payload, dst);
+    }
+
+    /// \brief Prepare a packet in a single contiguous buffer. The payload must
+    /// already be stored in `buf` starting at offset `headroom`. The headers
+    /// are written into the headroom directly in front of the payload, so
+    /// that the packet can be sent without a scatter/gather list.
+    ///
+    /// \param buf
+    ///     Packet buffer containing the payload after `headroom` bytes.
+    /// \param headroom
+    ///     Offset of the payload in `buf`. Must be at least as large as the
+    ///     generated headers, otherwise BufferTooSmall is returned.
+    ///
+    /// See the first overload of pack() for the remaining parameters.
+    /// \return The complete packet, a subspan of `buf` ending at the end of
+    /// the payload.
+    template <
+        typename Path,
+        ext::extension_range ExtRange,
+        typename L4,
+        typename Alloc>
+    Maybe<std::span<std::byte>> packInPlace(
+        HeaderCache<Alloc>& headers,
+        const Endpoint* to,
+        const Path& path,
+        ExtRange&& extensions,
+        L4&& l4,
+        std::span<std::byte> buf,
+        std::size_t headroom,
+        const generic::IPAddress* srcHost = nullptr)
+    {
+        if (headroom > buf.size()) return Error(ErrorCode::InvalidArgument);
+        auto ec = pack(headers, to, path, std::forward<ExtRange>(extensions),
+            std::forward<L4>(l4), buf.subspan(headroom), srcHost);
+        if (ec) return Error(ec);
+        return prependHeaders(headers, buf, headroom);
+    }
+
+    /// \brief Prepare a packet in a single contiguous buffer reusing the
+    /// headers from a previous call to pack() or packInPlace().
+    /// \copydetails packInPlace()
+    template <typename L4, typename Alloc>
+    Maybe<std::span<std::byte>> packInPlace(
+        HeaderCache<Alloc>& headers,
+        L4&& l4,
+        std::span<std::byte> buf,
+        std::size_t headroom)
+    {
+        if (headroom > buf.size()) return Error(ErrorCode::InvalidArgument);
+        auto ec = headers.updatePayload(std::forward<L4>(l4), buf.subspan(headroom));
+        if (ec) return Error(ec);
+        return prependHeaders(headers, buf, headroom);
+    }
+
+    /// \brief Turn a received UDP packet into a reply in place.
+    ///
+    /// Source and destination addresses and ports are swapped, the path is
+    /// reversed in place, and length and checksum are updated. The headers are
+    /// not re-serialized from scratch, so this is considerably cheaper than
+    /// building new headers from the received address and path.
+    ///
+    /// \param packet
+    ///     Buffer starting with the received packet. The reply payload must
+    ///     already be stored where the payload of the received packet begins,
+    ///     e.g., by leaving the received payload in place to echo it.
+    /// \param payloadSize
+    ///     Size of the reply payload.
+    /// \return The reply packet, a leading subrange of `packet`.
+    ///     InvalidPacket if `packet` does not start with a valid SCION/UDP
+    ///     packet. NotImplemented for packets with extension headers or path
+    ///     types that cannot be reversed. BufferTooSmall if `packet` cannot
+    ///     hold the reply payload.
+    Maybe<std::span<std::byte>> packReply(std::span<std::byte> packet, std::size_t payloadSize)
+    {
+        return packReplyImpl(packet, packet, payloadSize, nullptr);
+    }
+
+    /// \brief Build a reply to a received UDP packet in `dst` using the
+    /// headers of `request`. The payload is copied to `dst` while its checksum
+    /// is computed.
+    ///
+    /// \param request Received packet.
+    /// \param payload Reply payload.
+    /// \param dst Buffer receiving the reply. Must not overlap `request`.
+    /// \return The reply packet, a leading subrange of `dst`.
+    ///     See the first overload for the possible errors.
+    Maybe<std::span<std::byte>> packReply(
+        std::span<const std::byte> request,
+        std::span<const std::byte> payload,
+        std::span<std::byte> dst)
+    {
+        return packReplyImpl(request, dst, payload.size(), payload.data());
+    }
+
     /// \brief Parse a SCION packet received from the underlay.
     ///
     /// \param buf
@@ -205,8 +403,8 @@ public:
     ///     Optional pointer to an endpoint that receives the packet's
     ///     destination.
     /// \param path
-    ///     Optional pointer to a path to store the raw path from the SCION
-    ///     header in.
+    ///     Optional pointer to a RawPath to copy the raw path from the SCION
+    ///     header to or to a RawPathView referring to it in `buf`.
     /// \param scmp
     ///     Optional callable that is invoked if an SCMP packet was received
     ///     instead of the expected data.
@@ -220,7 +418,8 @@ public:
     ///     are returned.
     ///
     ///     ChecksumError indicates a packet was received and parsed, but the
-    ///     L4 checksum is incorrect.
+    ///     L4 checksum is incorrect. Checksums are verified according to the
+    ///     policy set by setChecksumPolicy().
     template <
         typename L4,
         ext::extension_range HbHExt,
@@ -233,19 +432,299 @@ public:
         HbHExt&& hbhExt,
         E2EExt&& e2eExt,
         Endpoint* from,
-        RawPath* path,
+        RawPathOutput path,
         ScmpHandler scmpCallback = DefaultScmpCallback())
     {
-        ParsedPacket<L4> pkt;
-        ReadStream rs(buf);
+        return unpack<L4>(buf, ulSource, nullptr,
+            std::forward<HbHExt>(hbhExt), std::forward<E2EExt>(e2eExt),
+            from, path, scmpCallback);
+    }
+
+    /// \brief Parse a SCION packet received from the underlay.
+    ///
+    /// \param ulDest
+    ///     Optional underlay destination address of the packet. Required to
+    ///     verify the destination host of packets received on sockets bound to
+    ///     a wildcard address, see setWildcardLocal(). If it is missing, all
+    ///     packets on such sockets are rejected with DstAddrMismatch.
+    ///
+    /// See the overload above for the remaining parameters.
+    template <
+        typename L4,
+        ext::extension_range HbHExt,
+        ext::extension_range E2EExt,
+        ScmpCallback ScmpHandler = DefaultScmpCallback
+    >
+    Maybe<std::span<const std::byte>> unpack(
+        std::span<const std::byte> buf,
+        const generic::IPAddress& ulSource,
+        const generic::IPAddress* ulDest,
+        HbHExt&& hbhExt,
+        E2EExt&& e2eExt,
+        Endpoint* from,
+        RawPathOutput path,
+        ScmpHandler scmpCallback = DefaultScmpCallback())
+    {
+        return unpackImpl<L4>(buf, ulSource, ulDest,
+            std::forward<HbHExt>(hbhExt), std::forward<E2EExt>(e2eExt),
+            from, path, std::span<std::byte>(), scmpCallback);
+    }
+
+    /// \brief Parse a SCION packet received from the underlay and copy the
+    /// payload to `dst`. The L4 checksum is verified while copying, so that
+    /// the payload is only read once.
+    ///
+    /// \param dst
+    ///     Buffer receiving the payload. BufferTooSmall is returned if the
+    ///     payload does not fit.
+    /// \return Returns the part of `dst` holding the payload. Payloads of
+    ///     SCMP messages are not copied but passed to the SCMP handler.
+    ///
+    /// See unpack() for the remaining parameters.
+    template <
+        typename L4,
+        ext::extension_range HbHExt,
+        ext::extension_range E2EExt,
+        ScmpCallback ScmpHandler = DefaultScmpCallback
+    >
+    Maybe<std::span<std::byte>> unpackInto(
+        std::span<const std::byte> buf,
+        const generic::IPAddress& ulSource,
+        const generic::IPAddress* ulDest,
+        HbHExt&& hbhExt,
+        E2EExt&& e2eExt,
+        Endpoint* from,
+        RawPathOutput path,
+        std::span<std::byte> dst,
+        ScmpHandler scmpCallback = DefaultScmpCallback())
+    {
+        auto payload = unpackImpl<L4>(buf, ulSource, ulDest,
+            std::forward<HbHExt>(hbhExt), std::forward<E2EExt>(e2eExt),
+            from, path, dst, scmpCallback);
+        if (isError(payload)) return propagateError(payload);
+        return dst.first(get(payload).size());
+    }
+
+    /// \brief Unpack a batch of received packets.
+    ///
+    /// Produces the same results as calling unpack() without extensions on
+    /// each buffer, but processes the batch in stages: All address headers
+    /// are decoded and filtered first, then the remaining headers of the
+    /// accepted packets are parsed, then checksums are verified. This keeps
+    /// the per-stage loops tight and independent of the receive backend.
+    ///
+    /// \param bufs Received underlay payloads.
+    /// \param ulSources Underlay source address of each packet.
+    /// \param ulDests Underlay destination address of each packet if the
+    ///     underlay socket is bound to a wildcard address. Otherwise empty.
+    /// \param result Output storage for at least `bufs.size()` packets.
+    /// \param scmpCallback Invoked for each received SCMP message.
+    /// \return Number of valid packets or InvalidArgument if any of the
+    ///     non-empty spans is too small or `ulDests` is empty although
+    ///     isWildcardLocal() is true.
+    template <typename L4, ScmpCallback ScmpHandler = DefaultScmpCallback>
+    Maybe<std::size_t> unpackBatch(
+        std::span<const std::span<const std::byte>> bufs,
+        std::span<const generic::IPAddress> ulSources,
+        std::span<const generic::IPAddress> ulDests,
+        const BatchResult& result,
+        ScmpHandler scmpCallback = DefaultScmpCallback())
+    {
+        const auto n = bufs.size();
+        auto fits = [n] (auto span) { return span.empty() || span.size() >= n; };
+        if (ulSources.size() < n || !fits(ulDests) || (wildcardLocal && ulDests.empty())
+            || result.payloads.size() < n || result.errors.size() < n
+            || !fits(result.from) || !fits(result.paths) || !fits(result.checksums)) {
+            return Error(ErrorCode::InvalidArgument);
+        }
+
+        std::size_t valid = 0;
+        std::array<ParsedPacket<L4>, UNPACK_CHUNK_SIZE> pkts;
+        for (std::size_t base = 0; base < n; base += UNPACK_CHUNK_SIZE) {
+            const auto m = std::min(UNPACK_CHUNK_SIZE, n - base);
+            auto errors = result.errors.subspan(base, m);
+
+            // Common and address header
+            for (std::size_t i = 0; i < m; ++i) {
+                SCION_STREAM_ERROR err;
+                if (pkts[i].parseHeader(bufs[base + i], err)) {
+                    errors[i] = ErrorCode::Ok;
+                } else {
+                    SCION_DEBUG_PRINT(err << std::endl);
+                    errors[i] = ErrorCode::InvalidPacket;
+                }
+            }
+            // Address filter
+            for (std::size_t i = 0; i < m; ++i) {
+                if (errors[i]) continue;
+                errors[i] = verifyAddresses(pkts[i].sci, ulSources[base + i],
+                    ulDests.empty() ? nullptr : &ulDests[base + i]);
+            }
+            // Path, extension, and L4 headers
+            for (std::size_t i = 0; i < m; ++i) {
+                if (errors[i]) continue;
+                SCION_STREAM_ERROR err;
+                if (!pkts[i].parseRemainder(bufs[base + i], err)) {
+                    SCION_DEBUG_PRINT(err << std::endl);
+                    errors[i] = ErrorCode::InvalidPacket;
+                }
+            }
+            // Checksums
+            for (std::size_t i = 0; i < m; ++i) {
+                if (errors[i]) continue;
+                if (sampleChecksum(std::holds_alternative<hdr::SCMP>(pkts[i].l4))
+                    && pkts[i].checksum() != 0xffffu) {
+                    errors[i] = ErrorCode::ChecksumError;
+                }
+            }
+            // Outputs
+            for (std::size_t i = 0; i < m; ++i) {
+                auto& pkt = pkts[i];
+                const auto j = base + i;
+                result.payloads[j] = std::span<const std::byte>();
+                if (errors[i]) continue;
+                if (!result.from.empty()) {
+                    std::uint16_t sport = 0;
+                    if (std::holds_alternative<L4>(pkt.l4))
+                        sport = std::get<L4>(pkt.l4).sport;
+                    result.from[j] = Endpoint(pkt.sci.src, sport);
+                }
+                if (!result.paths.empty()) {
+                    result.paths[j].assign(
+                        pkt.sci.src.getIsdAsn(), pkt.sci.dst.getIsdAsn(),
+                        pkt.sci.ptype, pkt.path);
+                }
+                if (std::holds_alternative<hdr::SCMP>(pkt.l4)) {
+                    invokeScmpHandler(pkt, scmpCallback);
+                    errors[i] = ErrorCode::ScmpReceived;
+                    continue;
+                }
+                if (!result.checksums.empty()) {
+                    result.checksums[j] = checksumPolicy == ChecksumPolicy::Defer ?
+                        DeferredChecksum(pkt.pseudoHeaderChecksum()) : DeferredChecksum();
+                }
+                result.payloads[j] = pkt.payload;
+                ++valid;
+            }
+        }
+        return valid;
+    }
+
+private:
+    // Number of packets unpackBatch() processes per stage.
+    static constexpr std::size_t UNPACK_CHUNK_SIZE = 16;
+
+    // Write a reply to the UDP packet in `request` to `dst`. `request` and
+    // `dst` may be the same buffer. If `payload` is null, the reply payload is
+    // expected in `dst` directly after the headers, otherwise it is copied
+    // from `payload`.
+    Maybe<std::span<std::byte>> packReplyImpl(
+        std::span<const std::byte> request, std::span<std::byte> dst,
+        std::size_t payloadSize, const std::byte* payload)
+    {
+        ParsedPacket<hdr::UDP> pkt;
         SCION_STREAM_ERROR err;
-        if (!pkt.parse(rs, err)) {
+        if (!pkt.parse(request, err)) {
             SCION_DEBUG_PRINT(err << std::endl);
             return Error(ErrorCode::InvalidPacket);
         }
+        auto udp = std::get_if<hdr::UDP>(&pkt.l4);
+        if (!udp || !pkt.hbhOpts.empty() || !pkt.e2eOpts.empty()) {
+            return Error(ErrorCode::NotImplemented);
+        }
+        const auto hdrSize = (std::size_t)(pkt.payload.data() - request.data());
+        const auto l4Size = udp->size() + payloadSize;
+        if (l4Size > std::numeric_limits<std::uint16_t>::max()) {
+            return Error(ErrorCode::InvalidArgument);
+        }
+        if (dst.size() < hdrSize + payloadSize) return Error(ErrorCode::BufferTooSmall);
+
+        // Reverse the path
+        const auto pathOffset = (std::size_t)(pkt.path.data() - request.data());
+        auto path = dst.subspan(pathOffset, pkt.path.size());
+        if (path.data() != pkt.path.data()) std::ranges::copy(pkt.path, path.begin());
+        if (auto ec = details::reversePathInPlace(pkt.sci.ptype, path); ec) {
+            return Error(ec);
+        }
+
+        // Swap addresses and ports
+        hdr::SCION sci = pkt.sci;
+        std::swap(sci.src, sci.dst);
+        sci.qos = trafficClass;
+        sci.plen = (std::uint16_t)l4Size;
+        hdr::UDP reply;
+        reply.sport = udp->dport;
+        reply.dport = udp->sport;
+        reply.len = (std::uint16_t)l4Size;
+
+        auto out = dst.subspan(hdrSize, payloadSize);
+    #ifndef SCION_DISABLE_CHECKSUM
+        auto sum = sci.checksum(reply.len, hdr::ScionProto::UDP) + reply.checksum();
+        if (payload) {
+            reply.chksum = hdr::details::internetChecksumCopy(
+                out, std::span<const std::byte>(payload, payloadSize), sum);
+        } else {
+            reply.chksum = hdr::details::internetChecksum(out, sum);
+        }
+    #else
+        if (payload) std::ranges::copy(std::span(payload, payloadSize), out.begin());
+    #endif
+        hdr::emitSCION(dst, sci);
+        hdr::emitUDP(dst.subspan(hdrSize - reply.size()).first<8>(), reply);
+        return dst.first(hdrSize + payloadSize);
+    }
+
+    template <typename Alloc>
+    static Maybe<std::span<std::byte>> prependHeaders(
+        const HeaderCache<Alloc>& headers, std::span<std::byte> buf, std::size_t headroom)
+    {
+        auto hdrs = headers.get();
+        if (hdrs.size() > headroom) return Error(ErrorCode::BufferTooSmall);
+        auto packet = buf.subspan(headroom - hdrs.size());
+        std::ranges::copy(hdrs, packet.begin());
+        return packet;
+    }
 
+    template <
+        typename L4,
+        ext::extension_range HbHExt,
+        ext::extension_range E2EExt,
+        ScmpCallback ScmpHandler
+    >
+    Maybe<std::span<const std::byte>> unpackImpl(
+        std::span<const std::byte> buf,
+        const generic::IPAddress& ulSource,
+        const generic::IPAddress* ulDest,
+        HbHExt&& hbhExt,
+        E2EExt&& e2eExt,
+        Endpoint* from,
+        RawPathOutput path,
+        std::span<std::byte> copyTo,
+        ScmpHandler scmpCallback)
+    {
+        ParsedPacket<L4> pkt;
+        SCION_STREAM_ERROR err;
+        deferredChecksum = DeferredChecksum();
+        if (!pkt.parseHeader(buf, err)) {
+            SCION_DEBUG_PRINT(err << std::endl);
+            return Error(ErrorCode::InvalidPacket);
+        }
+        // Reject packets not meant for this socket before parsing the path,
+        // extensions, and transport header.
         std::error_code ec;
-        if ((ec = verifyReceived(pkt, ulSource))) return Error(ec);
+        if ((ec = verifyAddresses(pkt.sci, ulSource, ulDest))) return Error(ec);
+        if (!pkt.parseRemainder(buf, err)) {
+            SCION_DEBUG_PRINT(err << std::endl);
+            return Error(ErrorCode::InvalidPacket);
+        }
+
+        const bool isScmp = std::holds_alternative<hdr::SCMP>(pkt.l4);
+        const bool copy = copyTo.data() && !isScmp;
+        const bool verify = sampleChecksum(isScmp);
+        // The checksum is verified while copying if the payload is copied.
+        if (verify && !copy && pkt.checksum() != 0xffffu) {
+            return Error(ErrorCode::ChecksumError);
+        }
 
         if (!hbhExt.empty()) {
             ReadStream rs(pkt.hbhOpts);
@@ -269,51 +748,79 @@ public:
             *from = Endpoint(pkt.sci.src, sport);
         }
         if (path) {
-            path->assign(
+            path.assign(
                 pkt.sci.src.getIsdAsn(), pkt.sci.dst.getIsdAsn(),
                 pkt.sci.ptype, pkt.path);
         }
 
         if (std::holds_alternative<hdr::SCMP>(pkt.l4)) {
-            if (path) {
-                scmpCallback(pkt.sci.src, *path, std::get<hdr::SCMP>(pkt.l4).msg, pkt.payload);
+            invokeScmpHandler(pkt, scmpCallback);
+            return Error(ErrorCode::ScmpReceived);
+        }
+        if (copy) {
+            if (copyTo.size() < pkt.payload.size()) return Error(ErrorCode::BufferTooSmall);
+            if (verify) {
+                if (pkt.checksum(copyTo) != 0xffffu) return Error(ErrorCode::ChecksumError);
             } else {
-                invokeScmpHandler(pkt, scmpCallback);
+                std::ranges::copy(pkt.payload, copyTo.begin());
             }
-            return Error(ErrorCode::ScmpReceived);
+        }
+        if (checksumPolicy == ChecksumPolicy::Defer) {
+            deferredChecksum = DeferredChecksum(pkt.pseudoHeaderChecksum());
         }
         return pkt.payload;
     }
 
-private:
-    template <typename L4>
-    std::error_code verifyReceived(
-        const ParsedPacket<L4>& pkt, const generic::IPAddress& ulSource)
+    // Decide whether the checksum of the next received packet is verified.
+    bool sampleChecksum(bool isScmp)
     {
-        if (!local.getAddress().matches(pkt.sci.dst)) {
+        switch (checksumPolicy) {
+        case ChecksumPolicy::Verify:
+            return true;
+        case ChecksumPolicy::Skip:
+            return false;
+        case ChecksumPolicy::Sample:
+            if (++sampleCounter < sampleInterval) return false;
+            sampleCounter = 0;
+            return true;
+        case ChecksumPolicy::Defer:
+            return isScmp;
+        }
+        return true;
+    }
+
+    std::error_code verifyAddresses(const hdr::SCION& sci,
+        const generic::IPAddress& ulSource, const generic::IPAddress* ulDest)
+    {
+        if (wildcardLocal) {
+            // The socket accepts packets for any local address, but the SCION
+            // destination must be the address the packet was delivered to.
+            // Without it, the destination host cannot be verified.
+            if (!ulDest || !local.getIsdAsn().matches(sci.dst.getIsdAsn())) {
+                return ErrorCode::DstAddrMismatch;
+            }
+        } else if (!local.getAddress().matches(sci.dst)) {
             return ErrorCode::DstAddrMismatch;
         }
-        if (!remote.getAddress().matches(pkt.sci.src)) {
+        if (ulDest && *ulDest != sci.dst.getHost()) {
+            return ErrorCode::DstAddrMismatch;
+        }
+        if (!remote.getAddress().matches(sci.src)) {
             return ErrorCode::SrcAddrMismatch;
         }
-        if (pkt.sci.ptype == hdr::PathType::Empty && ulSource != pkt.sci.src.getHost()) {
+        if (sci.ptype == hdr::PathType::Empty && ulSource != sci.src.getHost()) {
             // For AS-internal communication with empty paths underlay address
             // of the sender must match the source host addressin the SCION
             // header.
             return ErrorCode::InvalidPacket;
         }
-    #ifndef SCION_DISABLE_CHECKSUM
-        if (pkt.checksum() != 0xffffu) {
-            return ErrorCode::ChecksumError;
-        }
-    #endif
         return ErrorCode::Ok;
     }
 
     template <typename L4, ScmpCallback ScmpHandler>
-    void invokeScmpHandler(ParsedPacket<L4> pkt, ScmpHandler handler)
+    void invokeScmpHandler(const ParsedPacket<L4>& pkt, ScmpHandler handler)
     {
-        RawPath rp(pkt.sci.src.getIsdAsn(), pkt.sci.dst.getIsdAsn(), pkt.sci.ptype, pkt.path);
+        RawPathView rp(pkt.sci.src.getIsdAsn(), pkt.sci.dst.getIsdAsn(), pkt.sci.ptype, pkt.path);
         handler(pkt.sci.src, rp, std::get<hdr::SCMP>(pkt.l4).msg, pkt.payload);
     }
 
@@ -325,6 +832,18 @@ private:
     // "Connected" remote endpoint. If set (not unspecified), packets from
     // endpoints not matching remote are rejected.
     Endpoint remote;
+    // Underlay socket is bound to a wildcard address.
+    bool wildcardLocal = false;
+    // Verification of received checksums.
+#ifdef SCION_DISABLE_CHECKSUM
+    ChecksumPolicy checksumPolicy = ChecksumPolicy::Skip;
+#else
+    ChecksumPolicy checksumPolicy = ChecksumPolicy::Verify;
+#endif
+    std::uint32_t sampleInterval = 1;
+    std::uint32_t sampleCounter = 0;
+    // Checksum of the last received packet if verification was deferred.
+    DeferredChecksum deferredChecksum;
 };
 
 } // namespace scion
@@ -24,13 +24,16 @@
 #include "scion/details/debug.hpp"
 #include "scion/error_codes.hpp"
 #include "scion/extensions/extension.hpp"
+#include "scion/hdr/details.hpp"
 #include "scion/hdr/scion.hpp"
 #include "scion/hdr/scmp.hpp"
+#include "scion/hdr/udp.hpp"
 
 #include <cassert>
 #include <concepts>
 #include <cstdint>
 #include <span>
+#include <type_traits>
 #include <variant>
 
 
@@ -74,6 +77,91 @@ struct ParsedPacket
     bool parse(ReadStream& rs, Error& err)
     {
         if (!sci.serialize(rs, err)) return err.propagate();
+        return parseRemainder(rs, err);
+    }
+
+    /// \brief Parse a packet from a contiguous buffer.
+    ///
+    /// Equivalent to calling parseHeader() followed by parseRemainder().
+    /// The result is always identical to `parse(ReadStream&, Error&)`.
+    template <typename Error = StreamError>
+    bool parse(std::span<const std::byte> buf, Error& err)
+    {
+        if (!parseHeader(buf, err)) return err.propagate();
+        return parseRemainder(buf, err);
+    }
+
+    /// \brief First parsing stage. Decodes only the SCION common and address
+    /// header into `sci`, so that packets can be filtered by address before
+    /// any further work is done.
+    template <typename Error = StreamError>
+    bool parseHeader(std::span<const std::byte> buf, Error& err)
+    {
+        if (parseHeaderFast(buf)) return true;
+        ReadStream rs(buf);
+        if (!sci.serialize(rs, err)) return err.propagate();
+        return true;
+    }
+
+    /// \brief Second parsing stage. Locates the path and extension headers
+    /// and decodes the transport header. `sci` must have been filled by a
+    /// successful call to parseHeader() on the same buffer.
+    ///
+    /// UDP packets without extension headers are decoded directly from fixed
+    /// offsets. All other packets, including any the fast path does not
+    /// recognize as valid, are handed to the general stream parser.
+    template <typename Error = StreamError>
+    bool parseRemainder(std::span<const std::byte> buf, Error& err)
+    {
+        if constexpr (std::is_same_v<L4, hdr::UDP>) {
+            if (parseUdpFast(buf)) return true;
+        }
+        ReadStream rs(buf);
+        if (!rs.advanceBytes(sci.size(), err)) return err.propagate();
+        return parseRemainder(rs, err);
+    }
+
+    /// \brief Compute the checksum of the (inner, not underlay) L4 header.
+    std::uint16_t checksum() const
+    {
+        return hdr::details::internetChecksum(payload, pseudoHeaderChecksum());
+    }
+
+    /// \brief Compute the checksum of the (inner, not underlay) L4 header
+    /// while copying the payload to `dst`.
+    /// \param dst Destination buffer. Must be at least as large as the payload.
+    std::uint16_t checksum(std::span<std::byte> dst) const
+    {
+        return hdr::details::internetChecksumCopy(dst, payload, pseudoHeaderChecksum());
+    }
+
+    /// \brief Sum of the SCION pseudo header and the L4 header without the
+    /// payload. Not folded to 16 bits.
+    std::uint32_t pseudoHeaderChecksum() const
+    {
+        auto nh = hdr::ScionProto(0);
+        std::uint32_t checksum = 0;
+        std::visit([&](auto&& arg) -> auto {
+            nh = std::remove_reference<decltype(arg)>::type::PROTO;
+            checksum = arg.checksum();
+        }, l4);
+        auto hbhSize = (std::uint16_t)hbhOpts.size();
+        auto e2eSize = (std::uint16_t)e2eOpts.size();
+        std::uint16_t len = sci.plen - hbhSize - e2eSize;
+        len -= 2 * (hbhSize > 0) + 2 * (e2eSize > 0);
+        checksum += sci.checksum(len, nh);
+        return checksum;
+    }
+
+private:
+    static constexpr std::size_t COMMON_HDR_SIZE = 28;
+    static constexpr std::size_t UDP_HDR_SIZE = 8;
+
+    template <typename Error>
+    bool parseRemainder(ReadStream& rs, Error& err)
+    {
+        hbhOpts = std::span<const std::byte>();
+        e2eOpts = std::span<const std::byte>();
         if (!rs.lookahead(path, sci.pathSize(), err)) return err.propagate();
         if (!rs.advanceBytes(sci.pathSize(), err)) return err.propagate();
         hdr::ScionProto nh = sci.nh;
@@ -107,21 +195,71 @@ struct ParsedPacket
         return true;
     }
 
-    /// \brief Compute the checksum of the (inner, not underlay) L4 header.
-    std::uint16_t checksum() const
+    /// \brief Decode the common and address header using fixed field offsets.
+    /// Returns false without reporting an error if the header is malformed.
+    bool parseHeaderFast(std::span<const std::byte> buf)
     {
-        auto nh = hdr::ScionProto(0);
-        std::uint32_t checksum = 0;
-        std::visit([&](auto&& arg) -> auto {
-            nh = std::remove_reference<decltype(arg)>::type::PROTO;
-            checksum = arg.checksum();
-        }, l4);
-        auto hbhSize = (std::uint16_t)hbhOpts.size();
-        auto e2eSize = (std::uint16_t)e2eOpts.size();
-        std::uint16_t len = sci.plen - hbhSize - e2eSize;
-        len -= 2 * (hbhSize > 0) + 2 * (e2eSize > 0);
-        checksum += sci.checksum(len, nh);
-        return hdr::details::internetChecksum(payload, checksum);
+        using hdr::details::loadBE;
+
+        if (buf.size() < COMMON_HDR_SIZE) return false;
+        const std::byte* p = buf.data();
+        auto w0 = loadBE<std::uint32_t>(p);
+        if ((w0 >> 28) != hdr::SCION::version) return false;
+        auto hlen = std::to_integer<std::uint8_t>(p[5]);
+        if (hlen < hdr::SCION::minSize / 4) return false;
+
+        auto dstType = HostAddrType(std::to_integer<std::uint8_t>(p[9]) >> 4);
+        auto srcType = HostAddrType(std::to_integer<std::uint8_t>(p[9]) & 0x0f);
+        if (dstType != HostAddrType::IPv4 && dstType != HostAddrType::IPv6) return false;
+        if (srcType != HostAddrType::IPv4 && srcType != HostAddrType::IPv6) return false;
+        std::size_t dstLen = dstType == HostAddrType::IPv4 ? 4 : 16;
+        std::size_t srcLen = srcType == HostAddrType::IPv4 ? 4 : 16;
+        if (buf.size() < COMMON_HDR_SIZE + dstLen + srcLen) return false;
+
+        auto loadHost = [](const std::byte* p, bool v4) {
+            if (v4) return generic::IPAddress::MakeIPv4(loadBE<std::uint32_t>(p));
+            return generic::IPAddress::MakeIPv6(
+                loadBE<std::uint64_t>(p), loadBE<std::uint64_t>(p + 8));
+        };
+        sci.qos = (std::uint8_t)(w0 >> 20);
+        sci.fl = w0 & 0xfffff;
+        sci.nh = hdr::ScionProto(p[4]);
+        sci.hlen = hlen;
+        sci.plen = loadBE<std::uint16_t>(p + 6);
+        sci.ptype = hdr::PathType(p[8]);
+        sci.dst = Address<generic::IPAddress>(
+            IsdAsn(loadBE<std::uint64_t>(p + 12)),
+            loadHost(p + COMMON_HDR_SIZE, dstType == HostAddrType::IPv4));
+        sci.src = Address<generic::IPAddress>(
+            IsdAsn(loadBE<std::uint64_t>(p + 20)),
+            loadHost(p + COMMON_HDR_SIZE + dstLen, srcType == HostAddrType::IPv4));
+        return true;
+    }
+
+    /// \brief Decode the UDP header of a packet without extension headers
+    /// using fixed offsets. Returns false without reporting an error if the
+    /// packet is not eligible for the fast path or is malformed.
+    bool parseUdpFast(std::span<const std::byte> buf)
+    {
+        using hdr::details::loadBE;
+
+        if (sci.nh != hdr::ScionProto::UDP) return false;
+        std::size_t addrEnd = sci.size();
+        std::size_t l4Offset = 4 * (std::size_t)sci.hlen;
+        if (l4Offset < addrEnd || buf.size() < l4Offset + UDP_HDR_SIZE) return false;
+
+        path = buf.subspan(addrEnd, l4Offset - addrEnd);
+        hbhOpts = std::span<const std::byte>();
+        e2eOpts = std::span<const std::byte>();
+
+        const std::byte* p = buf.data() + l4Offset;
+        auto& udp = l4.template emplace<L4>();
+        udp.sport = loadBE<std::uint16_t>(p);
+        udp.dport = loadBE<std::uint16_t>(p + 2);
+        udp.len = loadBE<std::uint16_t>(p + 4);
+        udp.chksum = loadBE<std::uint16_t>(p + 6);
+        payload = buf.subspan(l4Offset + UDP_HDR_SIZE);
+        return true;
     }
 };
 
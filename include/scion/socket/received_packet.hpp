@@ -0,0 +1,59 @@
+// Copyright (c) 2024-2025 Lars-Christian Schulz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "scion/addr/endpoint.hpp"
+#include "scion/addr/generic_ip.hpp"
+#include "scion/path/raw.hpp"
+#include "scion/socket/checksum_policy.hpp"
+
+#include <cstddef>
+#include <span>
+
+
+namespace scion {
+
+/// \brief A packet returned from a batched receive operation.
+/// \tparam UnderlayEp Type of underlay endpoints.
+template <typename UnderlayEp>
+struct ReceivedPacket
+{
+    /// \brief Packet payload. Points into the receive buffer.
+    std::span<std::byte> payload;
+    /// \brief The complete SCION packet including headers. Points into the
+    /// receive buffer. See ScionPackager::packReply().
+    std::span<std::byte> packet;
+    /// \brief Source address from the SCION header.
+    Endpoint<generic::IPEndpoint> from;
+    /// \brief Path from the SCION header. Not reversed. Points into the
+    /// receive buffer.
+    RawPathView path;
+    /// \brief Underlay address of the last hop.
+    UnderlayEp ulSource;
+    /// \brief Local address the packet was received on. Differs from the
+    /// socket's default address only on sockets bound to a wildcard address.
+    generic::IPAddress localAddr;
+    /// \brief Checksum to verify before consuming the payload if the socket
+    /// uses ChecksumPolicy::Defer.
+    DeferredChecksum checksum;
+};
+
+} // namespace scion
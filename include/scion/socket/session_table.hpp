@@ -0,0 +1,269 @@
+// Copyright (c) 2024-2025 Lars-Christian Schulz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#pragma once
+
+#include "scion/addr/endpoint.hpp"
+#include "scion/addr/generic_ip.hpp"
+#include "scion/error_codes.hpp"
+#include "scion/path/raw.hpp"
+#include "scion/socket/header_cache.hpp"
+#include "scion/socket/header_cache_pool.hpp"
+#include "scion/socket/packager.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+
+namespace scion {
+
+/// \brief Per-client reply state for connectionless servers.
+///
+/// Extends the keyed header caches of HeaderCachePool with what a server needs
+/// to answer requests: Sessions are created from the path a request was
+/// received on and hold the headers for replying on the reversed path as well
+/// as the underlay address of the client's last request. Requests on a path
+/// that is already known do not reverse the path again.
+///
+/// Instead of a fixed number of entries, the approximate memory used by all
+/// sessions is bounded. Sessions that have been idle for longer than a
+/// timeout are removed. As with HeaderCachePool, the table must be cleared if
+/// the local endpoint or traffic class of the packager change.
+template <
+    typename UnderlayEp = generic::IPEndpoint,
+    typename Alloc = std::allocator<std::byte>>
+class SessionTable
+{
+public:
+    using Endpoint = scion::Endpoint<generic::IPEndpoint>;
+    using Clock = std::chrono::steady_clock;
+
+    struct Stats : details::HeaderStats
+    {
+        /// \brief Number of sessions removed after being idle.
+        std::uint64_t expired = 0;
+    };
+
+    /// \brief Reply state of a single client.
+    class Session
+    {
+    private:
+        friend class SessionTable;
+        friend class details::HeaderLru<Session>;
+
+        details::HeaderKey key;
+        HeaderCache<Alloc> cache;
+        // Encoded path of the request the headers were built for
+        std::vector<std::byte, Alloc> received;
+        IsdAsn source, target;
+        hdr::PathType type = hdr::PathType::Empty;
+        UnderlayEp underlay;
+        Clock::time_point lastUsed;
+
+        Session(const details::HeaderKey& key, Alloc alloc)
+            : key(key), cache(alloc), received(alloc)
+        {}
+
+    public:
+        /// \brief Remote endpoint of the client.
+        const Endpoint& remote() const { return key.remote; }
+
+        /// \brief Reversed path used to reply to the client. Refers to the
+        /// cached headers.
+        RawPathView path() const
+        {
+            return RawPathView(source, target, type, cache.getPath());
+        }
+
+        /// \brief Headers of the last reply.
+        const HeaderCache<Alloc>& headers() const { return cache; }
+
+        /// \brief Underlay address the last request was received from.
+        const UnderlayEp& nextHop() const { return underlay; }
+
+        /// \brief Time the session was last used.
+        Clock::time_point lastActive() const { return lastUsed; }
+    };
+
+private:
+    std::size_t maxBytes;
+    Clock::duration idleTimeout;
+    Alloc alloc;
+    std::size_t usedBytes = 0;
+    std::uint64_t expired = 0;
+    details::HeaderLru<Session> sessions;
+
+public:
+    /// \param memoryLimit Approximate upper bound on the memory used by all
+    /// sessions in bytes. At least one session is always kept.
+    /// \param idleTimeout Sessions not used for this long are removed.
+    SessionTable(std::size_t memoryLimit, Clock::duration idleTimeout, Alloc alloc = Alloc())
+        : maxBytes(memoryLimit), idleTimeout(idleTimeout), alloc(alloc)
+    {}
+
+    /// \brief Returns the memory limit in bytes.
+    std::size_t memoryLimit() const { return maxBytes; }
+
+    /// \brief Returns the approximate memory used by all sessions in bytes.
+    std::size_t memoryUsage() const { return usedBytes; }
+
+    /// \brief Returns the current number of sessions.
+    std::size_t size() const { return sessions.size(); }
+
+    /// \brief Returns hit, miss, eviction, and expiry counters.
+    Stats getStats() const
+    {
+        Stats stats;
+        static_cast<details::HeaderStats&>(stats) = sessions.getStats();
+        stats.expired = expired;
+        return stats;
+    }
+
+    /// \brief Reset all counters to zero.
+    void resetStats()
+    {
+        sessions.resetStats();
+        expired = 0;
+    }
+
+    /// \brief Look up the session for requests from `remote` received on
+    /// `path`. Does not update the LRU order or the last use time.
+    /// \return Pointer to the session or nullptr if there is none. The pointer
+    /// is valid until the next call to a non-const method.
+    const Session* find(const Endpoint& remote, const RawPathView& path) const
+    {
+        return sessions.find(details::HeaderKey{remote, path.digest()});
+    }
+
+    /// \brief Remove the session for the given client if present.
+    void erase(const Endpoint& remote, const RawPathView& path)
+    {
+        details::HeaderKey key{remote, path.digest()};
+        if (auto session = sessions.find(key); session) {
+            usedBytes -= sessionSize(*session);
+            sessions.erase(key);
+        }
+    }
+
+    /// \brief Remove all sessions.
+    void clear()
+    {
+        sessions.clear();
+        usedBytes = 0;
+    }
+
+    /// \brief Remove all sessions that have been idle since before
+    /// `now - idleTimeout`.
+    void expire(Clock::time_point now = Clock::now())
+    {
+        while (!sessions.empty() && now - sessions.oldest().lastUsed >= idleTimeout) {
+            usedBytes -= sessionSize(sessions.oldest());
+            sessions.erase(sessions.oldest().key);
+            ++expired;
+        }
+    }
+
+    /// \brief Prepare the headers for replying with `payload` to a request.
+    /// Reverses the path and builds new headers if there is no session for
+    /// the client yet, otherwise the cached headers are updated with the new
+    /// payload.
+    /// \param from Source of the request.
+    /// \param path Path of the request as received, i.e., not reversed.
+    /// \param ulSource Underlay source address of the request. Replies must be
+    /// sent to this address.
+    /// \param now Current time for idle aging.
+    /// \return Returns the headers to be sent in front of the payload. The
+    /// returned buffer is valid until the next call to a non-const method.
+    template <typename L4>
+    Maybe<std::span<const std::byte>> packReply(
+        ScionPackager& packager,
+        const Endpoint& from,
+        const RawPathView& path,
+        const UnderlayEp& ulSource,
+        L4&& l4,
+        std::span<const std::byte> payload,
+        Clock::time_point now = Clock::now())
+    {
+        expire(now);
+        details::HeaderKey key{from, path.digest()};
+        auto session = sessions.touch(key);
+        if (!session) {
+            session = &sessions.insert(Session(key, alloc));
+            usedBytes += sessionSize(*session);
+        }
+        session->lastUsed = now;
+        session->underlay = ulSource;
+        if (session->cache.size() > 0 && session->type == path.type()
+            && std::ranges::equal(session->received, path.encoded())) {
+            auto size = sessionSize(*session);
+            auto headers = sessions.update(packager, *session, std::forward<L4>(l4), payload);
+            if (isError(headers)) usedBytes -= size;
+            return headers;
+        }
+        return build(packager, *session, path, std::forward<L4>(l4), payload);
+    }
+
+private:
+    // Approximate memory used by a session including its list and index nodes.
+    static std::size_t sessionSize(const Session& session)
+    {
+        constexpr std::size_t NODE_OVERHEAD = 5 * sizeof(void*) + sizeof(details::HeaderKey);
+        return sizeof(Session) + NODE_OVERHEAD
+            + session.received.capacity() + session.cache.size();
+    }
+
+    template <typename L4>
+    Maybe<std::span<const std::byte>> build(
+        ScionPackager& packager,
+        Session& session,
+        const RawPathView& path,
+        L4&& l4,
+        std::span<const std::byte> payload)
+    {
+        usedBytes -= sessionSize(session);
+        std::array<std::byte, RawPath::MAX_SIZE> buffer;
+        RawPathView reversed = path;
+        if (auto ec = reversed.reverseInto(buffer); ec) {
+            sessions.erase(session.key);
+            return Error(ec);
+        }
+        auto headers = sessions.build(packager, session, reversed, std::forward<L4>(l4), payload);
+        if (isError(headers)) return headers;
+        session.received.assign(path.encoded().begin(), path.encoded().end());
+        session.source = reversed.firstAS();
+        session.target = reversed.lastAS();
+        session.type = reversed.type();
+        usedBytes += sessionSize(session);
+
+        // Evict least recently used sessions, but never the new one
+        while (usedBytes > maxBytes && sessions.size() > 1) {
+            usedBytes -= sessionSize(sessions.oldest());
+            sessions.evict();
+        }
+        return headers;
+    }
+};
+
+} // namespace scion
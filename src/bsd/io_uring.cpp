@@ -0,0 +1,263 @@
+// Copyright (c) 2024-2025 Lars-Christian Schulz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "scion/bsd/io_uring.hpp"
+
+#include <linux/io_uring.h>
+#include <linux/time_types.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <csignal>
+
+
+namespace scion {
+namespace bsd {
+namespace details {
+
+static constexpr std::uint64_t RECV_USER_DATA = 1;
+static constexpr std::uint16_t BUFFER_GROUP = 0;
+
+static std::error_code lastError()
+{
+    return std::error_code(errno, std::system_category());
+}
+
+template <typename T>
+static T* offsetPtr(void* base, std::size_t offset)
+{
+    return reinterpret_cast<T*>(reinterpret_cast<std::byte*>(base) + offset);
+}
+
+IoUring::~IoUring()
+{
+    if (ringFd >= 0) ::close(ringFd);
+    if (buffers) ::munmap(buffers, buffersSize);
+    if (bufRing) ::munmap(bufRing, bufRingSize);
+    if (sqeMem) ::munmap(sqeMem, sqeMemSize);
+    if (ringMem) ::munmap(ringMem, ringMemSize);
+}
+
+std::error_code IoUring::init(NativeHandle fd, socklen_t nameLen, std::size_t controlLen,
+    unsigned entries, std::size_t count, std::size_t size)
+{
+    if (ringFd >= 0) return ErrorCode::LogicError;
+    if (count == 0 || (count & (count - 1)) || count > 32768) return ErrorCode::InvalidArgument;
+    if (size <= sizeof(io_uring_recvmsg_out) + nameLen + controlLen)
+        return ErrorCode::InvalidArgument;
+
+    io_uring_params params = {};
+    ringFd = (int)::syscall(__NR_io_uring_setup, entries, &params);
+    if (ringFd < 0) return lastError();
+    constexpr auto requiredFeatures = IORING_FEAT_SINGLE_MMAP | IORING_FEAT_EXT_ARG;
+    if ((params.features & requiredFeatures) != requiredFeatures)
+        return ErrorCode::NotImplemented;
+
+    // Map submission and completion queue
+    ringMemSize = std::max(
+        params.sq_off.array + params.sq_entries * sizeof(unsigned),
+        params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe));
+    ringMem = ::mmap(nullptr, ringMemSize, PROT_READ | PROT_WRITE,
+        MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQ_RING);
+    if (ringMem == MAP_FAILED) {
+        ringMem = nullptr;
+        return lastError();
+    }
+    sqeMemSize = params.sq_entries * sizeof(io_uring_sqe);
+    sqeMem = ::mmap(nullptr, sqeMemSize, PROT_READ | PROT_WRITE,
+        MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQES);
+    if (sqeMem == MAP_FAILED) {
+        sqeMem = nullptr;
+        return lastError();
+    }
+    sqTail = offsetPtr<unsigned>(ringMem, params.sq_off.tail);
+    sqMask = offsetPtr<unsigned>(ringMem, params.sq_off.ring_mask);
+    sqArray = offsetPtr<unsigned>(ringMem, params.sq_off.array);
+    cqHead = offsetPtr<unsigned>(ringMem, params.cq_off.head);
+    cqTail = offsetPtr<unsigned>(ringMem, params.cq_off.tail);
+    cqMask = offsetPtr<unsigned>(ringMem, params.cq_off.ring_mask);
+    cqes = offsetPtr<void>(ringMem, params.cq_off.cqes);
+
+    // Allocate and register provided buffers
+    bufCount = count;
+    bufSize = size;
+    bufRingSize = count * sizeof(io_uring_buf);
+    bufRing = ::mmap(nullptr, bufRingSize, PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (bufRing == MAP_FAILED) {
+        bufRing = nullptr;
+        return lastError();
+    }
+    buffersSize = count * size;
+    auto mem = ::mmap(nullptr, buffersSize, PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE, -1, 0);
+    if (mem == MAP_FAILED) return lastError();
+    buffers = reinterpret_cast<std::byte*>(mem);
+
+    io_uring_buf_reg reg = {};
+    reg.ring_addr = reinterpret_cast<std::uint64_t>(bufRing);
+    reg.ring_entries = (std::uint32_t)count;
+    reg.bgid = BUFFER_GROUP;
+    if (::syscall(__NR_io_uring_register, ringFd, IORING_REGISTER_PBUF_RING, &reg, 1) < 0)
+        return lastError();
+    for (std::size_t i = 0; i < count; ++i) release((unsigned)i);
+
+    // Template for the multishot receive operation
+    sockFd = fd;
+    recvHdr.msg_namelen = nameLen;
+    recvHdr.msg_controllen = controlLen;
+    return ErrorCode::Ok;
+}
+
+std::error_code IoUring::arm()
+{
+    if (!armed) armRecv();
+    if (auto ec = enter(0, std::nullopt); ec) return ec;
+
+    // Invalid operations complete immediately with an error
+    unsigned head = *cqHead;
+    unsigned tail = std::atomic_ref(*cqTail).load(std::memory_order_acquire);
+    if (head != tail) {
+        auto& cqe = reinterpret_cast<io_uring_cqe*>(cqes)[head & *cqMask];
+        if (cqe.user_data == RECV_USER_DATA && cqe.res < 0 && -cqe.res != ENOBUFS) {
+            auto res = cqe.res;
+            std::atomic_ref(*cqHead).store(head + 1, std::memory_order_release);
+            armed = false;
+            return std::error_code(-res, std::system_category());
+        }
+    }
+    return ErrorCode::Ok;
+}
+
+Maybe<IoUring::Completion> IoUring::receive(
+    bool block, std::optional<std::chrono::microseconds> timeout)
+{
+    bool polled = false;
+    while (true) {
+        if (!armed) armRecv();
+
+        unsigned head = *cqHead;
+        unsigned tail = std::atomic_ref(*cqTail).load(std::memory_order_acquire);
+        if (head == tail) {
+            if (!block && (polled || toSubmit == 0))
+                return Error(std::make_error_code(std::errc::resource_unavailable_try_again));
+            auto ec = enter(block ? 1 : 0, timeout);
+            if (ec) return Error(ec);
+            polled = true;
+            continue;
+        }
+
+        auto cqe = reinterpret_cast<io_uring_cqe*>(cqes)[head & *cqMask];
+        std::atomic_ref(*cqHead).store(head + 1, std::memory_order_release);
+        if (cqe.user_data != RECV_USER_DATA) continue;
+        if (!(cqe.flags & IORING_CQE_F_MORE)) armed = false;
+        if (cqe.res < 0) {
+            if (-cqe.res == ENOBUFS) continue;
+            return Error(std::error_code(-cqe.res, std::system_category()));
+        }
+        if (!(cqe.flags & IORING_CQE_F_BUFFER)) continue;
+
+        auto bid = cqe.flags >> IORING_CQE_BUFFER_SHIFT;
+        auto buf = std::span<const std::byte>(buffers + bid * bufSize, (std::size_t)cqe.res);
+        io_uring_recvmsg_out out;
+        std::memcpy(&out, buf.data(), sizeof(out));
+        auto name = buf.subspan(sizeof(out), recvHdr.msg_namelen);
+        auto control = buf.subspan(sizeof(out) + recvHdr.msg_namelen, recvHdr.msg_controllen);
+        auto payload = buf.subspan(sizeof(out) + recvHdr.msg_namelen + recvHdr.msg_controllen);
+        return Completion{
+            .bufferId = bid,
+            .name = name.first(std::min<std::size_t>(out.namelen, name.size())),
+            .control = control.first(std::min<std::size_t>(out.controllen, control.size())),
+            .payload = payload,
+            .truncated = (out.flags & MSG_TRUNC) != 0,
+        };
+    }
+}
+
+void IoUring::release(unsigned bufferId)
+{
+    // Not using io_uring_buf_ring, because its flexible array member is
+    // declared in a way that changes the layout when compiled as C++. The ring
+    // tail overlays the reserved field of the first buffer.
+    auto ring = reinterpret_cast<io_uring_buf*>(bufRing);
+    auto& buf = ring[bufTail & (bufCount - 1)];
+    buf.addr = reinterpret_cast<std::uint64_t>(buffers + bufferId * bufSize);
+    buf.len = (std::uint32_t)bufSize;
+    buf.bid = (std::uint16_t)bufferId;
+    std::atomic_ref(ring[0].resv).store(++bufTail, std::memory_order_release);
+}
+
+void IoUring::armRecv()
+{
+    unsigned tail = *sqTail;
+    unsigned index = tail & *sqMask;
+    auto sqe = reinterpret_cast<io_uring_sqe*>(sqeMem) + index;
+    std::memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = IORING_OP_RECVMSG;
+    sqe->fd = sockFd;
+    sqe->addr = reinterpret_cast<std::uint64_t>(&recvHdr);
+    sqe->len = 1;
+    sqe->ioprio = IORING_RECV_MULTISHOT;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = BUFFER_GROUP;
+    sqe->user_data = RECV_USER_DATA;
+    sqArray[index] = index;
+    std::atomic_ref(*sqTail).store(tail + 1, std::memory_order_release);
+    ++toSubmit;
+    armed = true;
+}
+
+std::error_code IoUring::enter(
+    unsigned minComplete, std::optional<std::chrono::microseconds> timeout)
+{
+    unsigned flags = IORING_ENTER_GETEVENTS;
+    __kernel_timespec ts = {};
+    io_uring_getevents_arg arg = {};
+    const void* argp = nullptr;
+    std::size_t argSize = 0;
+    if (timeout && minComplete > 0) {
+        ts.tv_sec = timeout->count() / 1'000'000;
+        ts.tv_nsec = (timeout->count() % 1'000'000) * 1000;
+        arg.sigmask = 0;
+        arg.sigmask_sz = _NSIG / 8;
+        arg.ts = reinterpret_cast<std::uint64_t>(&ts);
+        flags |= IORING_ENTER_EXT_ARG;
+        argp = &arg;
+        argSize = sizeof(arg);
+    }
+    while (true) {
+        auto res = ::syscall(__NR_io_uring_enter,
+            ringFd, toSubmit, minComplete, flags, argp, argSize);
+        if (res >= 0) {
+            toSubmit -= std::min<unsigned>(toSubmit, (unsigned)res);
+            return ErrorCode::Ok;
+        }
+        if (errno == EINTR) continue;
+        if (errno == ETIME)
+            return std::make_error_code(std::errc::resource_unavailable_try_again);
+        return lastError();
+    }
+}
+
+} // namespace details
+} // namespace bsd
+} // namespace scion
@@ -0,0 +1,77 @@
+// Copyright (c) 2024-2025 Lars-Christian Schulz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "scion/bsd/sharded_server.hpp"
+
+#include <linux/filter.h>
+#include <pthread.h>
+#include <sched.h>
+
+
+namespace scion {
+namespace bsd {
+namespace details {
+
+std::vector<unsigned> getAllowedCpus()
+{
+    std::vector<unsigned> cpus;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (::sched_getaffinity(0, sizeof(set), &set)) return cpus;
+    for (unsigned cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+        if (CPU_ISSET(cpu, &set)) cpus.push_back(cpu);
+    }
+    return cpus;
+}
+
+std::error_code pinThisThread(unsigned cpu)
+{
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    int err = ::pthread_setaffinity_np(::pthread_self(), sizeof(set), &set);
+    if (err) return std::error_code(err, std::system_category());
+    return ErrorCode::Ok;
+}
+
+std::error_code attachFlowSteering(NativeHandle handle, std::uint32_t groupSize)
+{
+    if (groupSize == 0) return ErrorCode::InvalidArgument;
+    // The program sees the UDP payload. The first word of the SCION header
+    // contains the version, traffic class, and 20-bit flow ID. Datagrams too
+    // short to contain it go to the first socket.
+    sock_filter code[] = {
+        BPF_STMT(BPF_LD | BPF_W | BPF_ABS, 0),
+        BPF_STMT(BPF_ALU | BPF_AND | BPF_K, 0xfffff),
+        BPF_STMT(BPF_ALU | BPF_MOD | BPF_K, groupSize),
+        BPF_STMT(BPF_RET | BPF_A, 0),
+    };
+    sock_fprog prog = {
+        .len = (unsigned short)(sizeof(code) / sizeof(sock_filter)),
+        .filter = code,
+    };
+    if (::setsockopt(handle, SOL_SOCKET, SO_ATTACH_REUSEPORT_CBPF, &prog, sizeof(prog)))
+        return getLastError();
+    return ErrorCode::Ok;
+}
+
+} // namespace details
+} // namespace bsd
+} // namespace scion
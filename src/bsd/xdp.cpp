@@ -0,0 +1,574 @@
+// Copyright (c) 2024-2025 Lars-Christian Schulz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "scion/bsd/xdp.hpp"
+#include "scion/details/debug.hpp"
+#include "scion/hdr/ethernet.hpp"
+#include "scion/hdr/ip.hpp"
+#include "scion/hdr/udp.hpp"
+
+#include <arpa/inet.h>
+#include <ifaddrs.h>
+#include <linux/bpf.h>
+#include <linux/if_ether.h>
+#include <linux/if_link.h>
+#include <linux/if_packet.h>
+#include <linux/if_xdp.h>
+#include <linux/neighbour.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#include <net/if.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <vector>
+
+#ifndef SOL_XDP
+#define SOL_XDP 283
+#endif
+
+
+namespace scion {
+namespace bsd {
+namespace details {
+
+static std::error_code lastError()
+{
+    return std::error_code(errno, std::system_category());
+}
+
+////////////////////
+// Interface Info //
+////////////////////
+
+Maybe<InterfaceInfo> findInterface(const generic::IPAddress& addr)
+{
+    ifaddrs* addrs = nullptr;
+    if (::getifaddrs(&addrs)) return Error(lastError());
+
+    const char* name = nullptr;
+    for (auto ifa = addrs; ifa; ifa = ifa->ifa_next) {
+        if (!ifa->ifa_addr) continue;
+        if (ifa->ifa_addr->sa_family == AF_INET) {
+            auto sin = reinterpret_cast<const sockaddr_in*>(ifa->ifa_addr);
+            if (addr == generic::toGenericAddr(sin->sin_addr)) name = ifa->ifa_name;
+        } else if (ifa->ifa_addr->sa_family == AF_INET6) {
+            auto sin6 = reinterpret_cast<const sockaddr_in6*>(ifa->ifa_addr);
+            if (addr == generic::toGenericAddr(sin6->sin6_addr)) name = ifa->ifa_name;
+        }
+        if (name) break;
+    }
+
+    InterfaceInfo info;
+    if (name) {
+        info.index = ::if_nametoindex(name);
+        for (auto ifa = addrs; ifa; ifa = ifa->ifa_next) {
+            if (!ifa->ifa_addr || ifa->ifa_addr->sa_family != AF_PACKET) continue;
+            if (std::strcmp(ifa->ifa_name, name) != 0) continue;
+            auto sll = reinterpret_cast<const sockaddr_ll*>(ifa->ifa_addr);
+            if (sll->sll_halen == info.mac.size())
+                std::memcpy(info.mac.data(), sll->sll_addr, info.mac.size());
+        }
+    }
+    ::freeifaddrs(addrs);
+
+    if (info.index == 0) return Error(ErrorCode::NoLocalHostAddr);
+    return info;
+}
+
+std::optional<MacAddress> lookupNeighbor(unsigned ifindex, const generic::IPAddress& addr)
+{
+    struct {
+        nlmsghdr nh;
+        ndmsg ndm;
+        alignas(NLMSG_ALIGNTO) std::byte attrs[RTA_SPACE(16)];
+    } req = {};
+    std::array<std::byte, 16> bytes;
+    if (addr.is4()) addr.toBytes4(std::span<std::byte, 4>(bytes.data(), 4));
+    else addr.toBytes16(bytes);
+    auto addrLen = addr.size();
+
+    req.nh.nlmsg_len = NLMSG_LENGTH(sizeof(ndmsg)) + RTA_LENGTH(addrLen);
+    req.nh.nlmsg_type = RTM_GETNEIGH;
+    req.nh.nlmsg_flags = NLM_F_REQUEST;
+    req.ndm.ndm_family = addr.is4() ? AF_INET : AF_INET6;
+    req.ndm.ndm_ifindex = (int)ifindex;
+    auto rta = reinterpret_cast<rtattr*>(req.attrs);
+    rta->rta_type = NDA_DST;
+    rta->rta_len = (unsigned short)RTA_LENGTH(addrLen);
+    std::memcpy(RTA_DATA(rta), bytes.data(), addrLen);
+
+    int nl = ::socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_ROUTE);
+    if (nl < 0) return std::nullopt;
+    std::optional<MacAddress> mac;
+    alignas(nlmsghdr) std::byte resp[1024];
+    if (::send(nl, &req, req.nh.nlmsg_len, 0) < 0) {
+        ::close(nl);
+        return std::nullopt;
+    }
+    auto len = ::recv(nl, resp, sizeof(resp), 0);
+    ::close(nl);
+    if (len < 0) return std::nullopt;
+
+    auto nh = reinterpret_cast<nlmsghdr*>(resp);
+    if (!NLMSG_OK(nh, (unsigned)len) || nh->nlmsg_type != RTM_NEWNEIGH) return std::nullopt;
+    auto ndm = reinterpret_cast<ndmsg*>(NLMSG_DATA(nh));
+    constexpr auto valid = NUD_REACHABLE | NUD_STALE | NUD_DELAY | NUD_PROBE | NUD_PERMANENT;
+    if (!(ndm->ndm_state & valid)) return std::nullopt;
+    int attrLen = (int)RTM_PAYLOAD(nh);
+    for (auto attr = RTM_RTA(ndm); RTA_OK(attr, attrLen); attr = RTA_NEXT(attr, attrLen)) {
+        if (attr->rta_type == NDA_LLADDR && RTA_PAYLOAD(attr) == sizeof(MacAddress)) {
+            mac.emplace();
+            std::memcpy(mac->data(), RTA_DATA(attr), sizeof(MacAddress));
+        }
+    }
+    return mac;
+}
+
+/////////////////////
+// Underlay Header //
+/////////////////////
+
+std::error_code writeUnderlayHeaders(std::span<std::byte> frame,
+    const MacAddress& srcMac, const MacAddress& dstMac,
+    const generic::IPEndpoint& src, const generic::IPEndpoint& dst)
+{
+    auto hdrSize = underlayHeaderSize(dst.getHost());
+    if (frame.size() < hdrSize || src.getHost().is4() != dst.getHost().is4())
+        return ErrorCode::InvalidArgument;
+    auto payload = frame.subspan(hdrSize);
+
+    hdr::Ethernet eth;
+    eth.dst = dstMac;
+    eth.src = srcMac;
+    hdr::UDP udp;
+    udp.sport = src.getPort();
+    udp.dport = dst.getPort();
+    udp.setPayload(payload);
+
+    WriteStream ws(frame);
+    SCION_STREAM_ERROR err;
+    if (dst.getHost().is4()) {
+        hdr::IPv4 ip;
+        ip.len = (std::uint16_t)(ip.size() + udp.len);
+        ip.src = src.getHost();
+        ip.dst = dst.getHost();
+        udp.chksum = hdr::details::internetChecksum(payload, ip.checksum(udp.len) + udp.checksum());
+        eth.type = hdr::EtherType::IPv4;
+        if (!eth.serialize(ws, err) || !ip.serialize(ws, err) || !udp.serialize(ws, err)) {
+            SCION_DEBUG_PRINT(err << std::endl);
+            return ErrorCode::LogicError;
+        }
+    } else {
+        hdr::IPv6 ip;
+        ip.plen = udp.len;
+        ip.src = src.getHost();
+        ip.dst = dst.getHost();
+        udp.chksum = hdr::details::internetChecksum(payload, ip.checksum(udp.len) + udp.checksum());
+        eth.type = hdr::EtherType::IPv6;
+        if (!eth.serialize(ws, err) || !ip.serialize(ws, err) || !udp.serialize(ws, err)) {
+            SCION_DEBUG_PRINT(err << std::endl);
+            return ErrorCode::LogicError;
+        }
+    }
+    return ErrorCode::Ok;
+}
+
+Maybe<std::span<std::byte>> parseUnderlayHeaders(std::span<std::byte> frame,
+    generic::IPEndpoint& src, generic::IPEndpoint& dst)
+{
+    ReadStream rs(frame);
+    SCION_STREAM_ERROR err;
+    hdr::Ethernet eth;
+    hdr::UDP udp;
+    generic::IPAddress srcIP, dstIP;
+    std::size_t ipPayload = 0;
+    if (!eth.serialize(rs, err)) return Error(ErrorCode::InvalidPacket);
+    if (eth.type == hdr::EtherType::IPv4) {
+        hdr::IPv4 ip;
+        if (!ip.serialize(rs, err)) return Error(ErrorCode::InvalidPacket);
+        if (ip.proto != hdr::IPProto::UDP || ip.frag != 0
+            || (ip.flags & hdr::IPv4::Flags::MoreFragments)
+            || ip.len < ip.size()) {
+            return Error(ErrorCode::InvalidPacket);
+        }
+        srcIP = ip.src;
+        dstIP = ip.dst;
+        ipPayload = ip.len - ip.size();
+    } else if (eth.type == hdr::EtherType::IPv6) {
+        hdr::IPv6 ip;
+        if (!ip.serialize(rs, err)) return Error(ErrorCode::InvalidPacket);
+        if (ip.nh != hdr::IPProto::UDP) return Error(ErrorCode::InvalidPacket);
+        srcIP = ip.src;
+        dstIP = ip.dst;
+        ipPayload = ip.plen;
+    } else {
+        return Error(ErrorCode::InvalidPacket);
+    }
+    if (!udp.serialize(rs, err)) return Error(ErrorCode::InvalidPacket);
+
+    // The UDP checksum is not verified, as the SCION header carries its own
+    // checksum over the payload.
+    auto offset = rs.getPos().first;
+    if (udp.len < udp.size() || udp.len > ipPayload || offset + udp.len - udp.size() > frame.size())
+        return Error(ErrorCode::InvalidPacket);
+    src = generic::IPEndpoint(srcIP, udp.sport);
+    dst = generic::IPEndpoint(dstIP, udp.dport);
+    return frame.subspan(offset, udp.len - udp.size());
+}
+
+/////////////////
+// XDP Program //
+/////////////////
+
+static bpf_insn insn(std::uint8_t code, std::uint8_t dst, std::uint8_t src,
+    std::int16_t off, std::int32_t imm)
+{
+    bpf_insn i = {};
+    i.code = code;
+    i.dst_reg = dst & 0x0f;
+    i.src_reg = src & 0x0f;
+    i.off = off;
+    i.imm = imm;
+    return i;
+}
+
+static long bpf(int cmd, bpf_attr& attr)
+{
+    return ::syscall(__NR_bpf, cmd, &attr, sizeof(attr));
+}
+
+std::error_code Xsk::loadProgram(
+    unsigned ifindex, unsigned queue, const generic::IPEndpoint& local)
+{
+    bpf_attr attr = {};
+    attr.map_type = BPF_MAP_TYPE_XSKMAP;
+    attr.key_size = sizeof(std::uint32_t);
+    attr.value_size = sizeof(std::uint32_t);
+    attr.max_entries = queue + 1;
+    mapFd = (int)bpf(BPF_MAP_CREATE, attr);
+    if (mapFd < 0) return lastError();
+
+    // Redirect UDP datagrams addressed to `local` to the socket in the XSKMAP
+    // entry of the receive queue. Frames redirected to the socket cannot be
+    // returned to the kernel, so everything else is passed, including packets
+    // of the other IP family, packets to other addresses on the interface,
+    // IPv4 packets with options, fragments, and IPv6 packets with extension
+    // headers.
+    constexpr std::uint8_t LDXW = BPF_LDX | BPF_MEM | BPF_W;
+    constexpr std::uint8_t LDXH = BPF_LDX | BPF_MEM | BPF_H;
+    constexpr std::uint8_t LDXB = BPF_LDX | BPF_MEM | BPF_B;
+    constexpr std::uint8_t MOV = BPF_ALU64 | BPF_MOV;
+    constexpr std::uint8_t ADD = BPF_ALU64 | BPF_ADD | BPF_K;
+    constexpr std::uint8_t JGT = BPF_JMP | BPF_JGT | BPF_X;
+    constexpr std::uint8_t JNE = BPF_JMP | BPF_JNE | BPF_K;
+    constexpr std::uint8_t JNE32 = BPF_JMP32 | BPF_JNE | BPF_K;
+
+    // Destination address as 32-bit words in the byte order loaded by LDXW
+    const bool v4 = local.getHost().is4();
+    std::array<std::byte, 16> addr = {};
+    if (v4) local.getHost().toBytes4(std::span(addr).first<4>());
+    else local.getHost().toBytes16(addr);
+    std::array<std::int32_t, 4> words = {};
+    std::memcpy(words.data(), addr.data(), addr.size());
+
+    const std::int16_t ipHdrLen = v4 ? 20 : 40;
+    const std::int32_t nport = htons(local.getPort());
+    std::vector<bpf_insn> prog;
+    std::vector<std::size_t> toPass; // jumps to PASS
+    auto jumpToPass = [&] (std::uint8_t code, std::int32_t imm) {
+        toPass.push_back(prog.size());
+        prog.push_back(insn(code, 5, 0, 0, imm));
+    };
+    prog.push_back(insn(MOV | BPF_X, 6, 1, 0, 0));                        // r6 = ctx
+    prog.push_back(insn(LDXW, 2, 6, offsetof(xdp_md, data), 0));          // r2 = data
+    prog.push_back(insn(LDXW, 3, 6, offsetof(xdp_md, data_end), 0));      // r3 = data_end
+    prog.push_back(insn(MOV | BPF_X, 5, 2, 0, 0));
+    prog.push_back(insn(ADD, 5, 0, 0, 14 + ipHdrLen + 8));
+    toPass.push_back(prog.size());
+    prog.push_back(insn(JGT, 5, 3, 0, 0));                                // headers > data_end
+    prog.push_back(insn(LDXH, 5, 2, 12, 0));                              // EtherType
+    jumpToPass(JNE, htons(v4 ? ETH_P_IP : ETH_P_IPV6));
+    if (v4) {
+        prog.push_back(insn(LDXB, 5, 2, 14, 0));                          // version and IHL
+        jumpToPass(JNE, 0x45);
+        prog.push_back(insn(LDXB, 5, 2, 14 + 9, 0));                      // protocol
+        jumpToPass(JNE, IPPROTO_UDP);
+        prog.push_back(insn(LDXW, 5, 2, 14 + 16, 0));                     // destination
+        jumpToPass(JNE32, words[0]);
+    } else {
+        prog.push_back(insn(LDXB, 5, 2, 14 + 6, 0));                      // next header
+        jumpToPass(JNE, IPPROTO_UDP);
+        for (std::int16_t i = 0; i < 4; ++i) {
+            prog.push_back(insn(LDXW, 5, 2, 14 + 24 + 4 * i, 0));         // destination
+            jumpToPass(JNE32, words[i]);
+        }
+    }
+    prog.push_back(insn(LDXH, 5, 2, 14 + ipHdrLen + 2, 0));               // destination port
+    jumpToPass(JNE, nport);
+    prog.push_back(insn(LDXW, 2, 6, offsetof(xdp_md, rx_queue_index), 0));
+    prog.push_back(insn(BPF_LD | BPF_DW | BPF_IMM, 1, BPF_PSEUDO_MAP_FD, 0, mapFd));
+    prog.push_back(insn(0, 0, 0, 0, 0));
+    prog.push_back(insn(MOV | BPF_K, 3, 0, 0, XDP_PASS));                 // fallback action
+    prog.push_back(insn(BPF_JMP | BPF_CALL, 0, 0, 0, BPF_FUNC_redirect_map));
+    prog.push_back(insn(BPF_JMP | BPF_EXIT, 0, 0, 0, 0));
+    const auto pass = prog.size();
+    prog.push_back(insn(MOV | BPF_K, 0, 0, 0, XDP_PASS));                 // PASS:
+    prog.push_back(insn(BPF_JMP | BPF_EXIT, 0, 0, 0, 0));
+    for (auto i : toPass) prog[i].off = (std::int16_t)(pass - i - 1);
+    static const char license[] = "Dual MIT/GPL";
+
+    attr = {};
+    attr.prog_type = BPF_PROG_TYPE_XDP;
+    attr.insns = reinterpret_cast<std::uint64_t>(prog.data());
+    attr.insn_cnt = (std::uint32_t)prog.size();
+    attr.license = reinterpret_cast<std::uint64_t>(license);
+    progFd = (int)bpf(BPF_PROG_LOAD, attr);
+    if (progFd < 0) return lastError();
+
+    // Insert the socket into the map before attaching the program
+    std::uint32_t key = queue;
+    std::uint32_t value = (std::uint32_t)fd;
+    attr = {};
+    attr.map_fd = (std::uint32_t)mapFd;
+    attr.key = reinterpret_cast<std::uint64_t>(&key);
+    attr.value = reinterpret_cast<std::uint64_t>(&value);
+    if (bpf(BPF_MAP_UPDATE_ELEM, attr) < 0) return lastError();
+
+    // The program is detached when the link is closed
+    attr = {};
+    attr.link_create.prog_fd = (std::uint32_t)progFd;
+    attr.link_create.target_ifindex = ifindex;
+    attr.link_create.attach_type = BPF_XDP;
+    linkFd = (int)bpf(BPF_LINK_CREATE, attr);
+    if (linkFd < 0) return lastError();
+    return ErrorCode::Ok;
+}
+
+////////////////
+// XDP Socket //
+////////////////
+
+static std::uint32_t loadAcquire(std::uint32_t* p)
+{
+    return std::atomic_ref<std::uint32_t>(*p).load(std::memory_order_acquire);
+}
+
+static void storeRelease(std::uint32_t* p, std::uint32_t value)
+{
+    std::atomic_ref<std::uint32_t>(*p).store(value, std::memory_order_release);
+}
+
+template <typename T>
+static T* descriptors(Xsk::Ring& ring)
+{
+    return reinterpret_cast<T*>(ring.desc);
+}
+
+static std::error_code mapRing(Xsk::Ring& ring, int fd, const xdp_ring_offset& off,
+    std::uint32_t entries, std::size_t descSize, off_t pgoff)
+{
+    ring.mapSize = off.desc + entries * descSize;
+    ring.map = ::mmap(nullptr, ring.mapSize, PROT_READ | PROT_WRITE,
+        MAP_SHARED | MAP_POPULATE, fd, pgoff);
+    if (ring.map == MAP_FAILED) {
+        ring.map = nullptr;
+        return lastError();
+    }
+    auto base = reinterpret_cast<std::byte*>(ring.map);
+    ring.producer = reinterpret_cast<std::uint32_t*>(base + off.producer);
+    ring.consumer = reinterpret_cast<std::uint32_t*>(base + off.consumer);
+    ring.flags = reinterpret_cast<std::uint32_t*>(base + off.flags);
+    ring.desc = base + off.desc;
+    ring.mask = entries - 1;
+    return ErrorCode::Ok;
+}
+
+Xsk::~Xsk()
+{
+    if (linkFd >= 0) ::close(linkFd);
+    if (progFd >= 0) ::close(progFd);
+    if (mapFd >= 0) ::close(mapFd);
+    for (auto ring : {&rx, &tx, &fill, &comp}) {
+        if (ring->map) ::munmap(ring->map, ring->mapSize);
+    }
+    if (fd >= 0) ::close(fd);
+    if (umem) ::munmap(umem, umemSize);
+}
+
+std::error_code Xsk::open(unsigned ifindex, unsigned queue,
+    const generic::IPEndpoint& local, std::size_t frameCount, std::size_t size)
+{
+    if (fd >= 0) return ErrorCode::LogicError;
+    if (frameCount < 4 || (frameCount & (frameCount - 1))) return ErrorCode::InvalidArgument;
+    if (size < 2048 || (size & (size - 1))) return ErrorCode::InvalidArgument;
+    frameSize = size;
+    auto entries = (std::uint32_t)(frameCount / 2);
+
+    umemSize = frameCount * frameSize;
+    auto mem = ::mmap(nullptr, umemSize, PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE, -1, 0);
+    if (mem == MAP_FAILED) return lastError();
+    umem = reinterpret_cast<std::byte*>(mem);
+
+    fd = ::socket(AF_XDP, SOCK_RAW | SOCK_CLOEXEC, 0);
+    if (fd < 0) return lastError();
+
+    xdp_umem_reg reg = {};
+    reg.addr = reinterpret_cast<std::uint64_t>(umem);
+    reg.len = umemSize;
+    reg.chunk_size = (std::uint32_t)frameSize;
+    if (::setsockopt(fd, SOL_XDP, XDP_UMEM_REG, &reg, sizeof(reg))) return lastError();
+    for (auto opt : {XDP_UMEM_FILL_RING, XDP_UMEM_COMPLETION_RING, XDP_RX_RING, XDP_TX_RING}) {
+        if (::setsockopt(fd, SOL_XDP, opt, &entries, sizeof(entries))) return lastError();
+    }
+
+    xdp_mmap_offsets off = {};
+    socklen_t optlen = sizeof(off);
+    if (::getsockopt(fd, SOL_XDP, XDP_MMAP_OFFSETS, &off, &optlen)) return lastError();
+    std::error_code ec;
+    if ((ec = mapRing(rx, fd, off.rx, entries, sizeof(xdp_desc), XDP_PGOFF_RX_RING)))
+        return ec;
+    if ((ec = mapRing(tx, fd, off.tx, entries, sizeof(xdp_desc), XDP_PGOFF_TX_RING)))
+        return ec;
+    if ((ec = mapRing(fill, fd, off.fr, entries, sizeof(std::uint64_t),
+        XDP_UMEM_PGOFF_FILL_RING))) return ec;
+    if ((ec = mapRing(comp, fd, off.cr, entries, sizeof(std::uint64_t),
+        XDP_UMEM_PGOFF_COMPLETION_RING))) return ec;
+
+    // The lower half of the UMEM is used for receiving, the upper half for
+    // sending.
+    auto prod = *fill.producer;
+    for (std::uint32_t i = 0; i < entries; ++i)
+        descriptors<std::uint64_t>(fill)[(prod + i) & fill.mask] = i * frameSize;
+    storeRelease(fill.producer, prod + entries);
+    txFree = std::make_unique<std::uint64_t[]>(entries);
+    for (std::uint32_t i = 0; i < entries; ++i)
+        txFree[i] = (entries + i) * frameSize;
+    txFreeCount = entries;
+
+    sockaddr_xdp sxdp = {};
+    sxdp.sxdp_family = AF_XDP;
+    sxdp.sxdp_ifindex = ifindex;
+    sxdp.sxdp_queue_id = queue;
+    sxdp.sxdp_flags = XDP_USE_NEED_WAKEUP;
+    if (::bind(fd, reinterpret_cast<sockaddr*>(&sxdp), sizeof(sxdp))) return lastError();
+
+    return loadProgram(ifindex, queue, local);
+}
+
+Maybe<std::size_t> Xsk::receive(std::span<Frame> frames,
+    bool block, std::optional<std::chrono::microseconds> timeout)
+{
+    auto cons = *rx.consumer;
+    auto avail = loadAcquire(rx.producer) - cons;
+    if (avail == 0) {
+        if (block) {
+            pollfd pfd = {fd, POLLIN, 0};
+            int ms = timeout ? (int)((timeout->count() + 999) / 1000) : -1;
+            int res = ::poll(&pfd, 1, ms);
+            if (res < 0) return Error(lastError());
+        } else if (loadAcquire(fill.flags) & XDP_RING_NEED_WAKEUP) {
+            ::recvfrom(fd, nullptr, 0, MSG_DONTWAIT, nullptr, nullptr);
+        }
+        avail = loadAcquire(rx.producer) - cons;
+        if (avail == 0) return Error(std::make_error_code(std::errc::resource_unavailable_try_again));
+    }
+
+    auto n = std::min<std::size_t>(avail, frames.size());
+    for (std::size_t i = 0; i < n; ++i) {
+        const auto& desc = descriptors<xdp_desc>(rx)[(cons + i) & rx.mask];
+        frames[i].addr = desc.addr;
+        frames[i].data = std::span<std::byte>(umem + desc.addr, desc.len);
+    }
+    storeRelease(rx.consumer, cons + (std::uint32_t)n);
+    return n;
+}
+
+void Xsk::release(std::span<const std::uint64_t> addrs)
+{
+    if (addrs.empty()) return;
+    // The fill ring is large enough to hold all receive frames
+    auto prod = *fill.producer;
+    for (std::size_t i = 0; i < addrs.size(); ++i) {
+        descriptors<std::uint64_t>(fill)[(prod + i) & fill.mask] = addrs[i] & ~(frameSize - 1);
+    }
+    storeRelease(fill.producer, prod + (std::uint32_t)addrs.size());
+}
+
+void Xsk::reclaim()
+{
+    auto cons = *comp.consumer;
+    auto avail = loadAcquire(comp.producer) - cons;
+    for (std::uint32_t i = 0; i < avail; ++i)
+        txFree[txFreeCount++] = descriptors<std::uint64_t>(comp)[(cons + i) & comp.mask];
+    storeRelease(comp.consumer, cons + avail);
+}
+
+Maybe<Xsk::Frame> Xsk::allocate()
+{
+    if (txFreeCount == 0) {
+        reclaim();
+        if (txFreeCount == 0) {
+            if (auto ec = flush(); ec) return Error(ec);
+            reclaim();
+            if (txFreeCount == 0)
+                return Error(std::make_error_code(std::errc::resource_unavailable_try_again));
+        }
+    }
+    auto addr = txFree[--txFreeCount];
+    return Frame{addr, std::span<std::byte>(umem + addr, frameSize)};
+}
+
+void Xsk::submit(std::uint64_t addr, std::size_t len)
+{
+    // The transmit ring is large enough to hold all transmit frames
+    auto prod = *tx.producer;
+    auto& desc = descriptors<xdp_desc>(tx)[prod & tx.mask];
+    desc.addr = addr;
+    desc.len = (std::uint32_t)len;
+    desc.options = 0;
+    storeRelease(tx.producer, prod + 1);
+}
+
+std::error_code Xsk::flush()
+{
+    // In copy mode, the kernel transmits a limited number of frames per
+    // wakeup.
+    constexpr int MAX_WAKEUPS = 64;
+    for (int i = 0; i < MAX_WAKEUPS; ++i) {
+        if (loadAcquire(tx.consumer) == *tx.producer) break;
+        if (!(loadAcquire(tx.flags) & XDP_RING_NEED_WAKEUP)) break;
+        if (::sendto(fd, nullptr, 0, MSG_DONTWAIT, nullptr, 0) < 0) {
+            if (errno != EAGAIN && errno != EBUSY && errno != ENOBUFS) return lastError();
+        }
+    }
+    reclaim();
+    return ErrorCode::Ok;
+}
+
+} // namespace details
+} // namespace bsd
+} // namespace scion
@@ -24,72 +24,238 @@
 #if __linux__
 #include <sys/types.h>
 #include <sys/socket.h>
-#include <netdb.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
 #include <unistd.h>
 #elif _WIN32
 #include <ws2tcpip.h>
-#define close closesocket
 #endif
 
+#include <array>
+#include <cstring>
+#include <limits>
+#include <mutex>
 #include <optional>
 
 
-static const char* HOST_NAME = "www.lcschulz.de";
+using scion::generic::IPAddress;
 
-template <typename SockAddrT>
-static std::optional<scion::generic::IPAddress> getDefaultAddr(int family)
+// Destination used to find the source address of the default route if the
+// route does not specify one. The documentation addresses (RFC 5737, RFC 3849)
+// are normally routed via the default route. No packets are sent to them.
+static IPAddress probeAddr(int family)
 {
-    using namespace scion;
+    if (family == AF_INET)
+        return IPAddress::MakeIPv4(0xc0000201u);
+    else
+        return IPAddress::MakeIPv6(0x20010db800000000ull, 1ull);
+}
 
-    addrinfo* result;
-    addrinfo hints = {};
-    hints.ai_family = family;
-    hints.ai_socktype = SOCK_DGRAM;
+#if __linux__
 
-    int err = getaddrinfo(HOST_NAME, "https", &hints, &result);
-    if (err != 0) return std::nullopt;
+/// \brief Send a request to the kernel's routing subsystem and pass every
+/// message of the response to `handler`.
+template <typename Handler>
+static bool rtnlRequest(nlmsghdr* req, Handler&& handler)
+{
+    int fd = ::socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_ROUTE);
+    if (fd < 0) return false;
+    if (::send(fd, req, req->nlmsg_len, 0) < 0) {
+        ::close(fd);
+        return false;
+    }
 
-    addrinfo* cur;
-    bsd::NativeHandle sockfd = -1;
-    for (cur = result; cur; cur = cur->ai_next) {
-        sockfd = socket(cur->ai_family, cur->ai_socktype, cur->ai_protocol);
-        if (sockfd < 0) continue;
-        if (connect(sockfd, cur->ai_addr, static_cast<socklen_t>(cur->ai_addrlen)) != -1)
+    alignas(nlmsghdr) std::array<std::byte, 16384> buf;
+    bool done = false, ok = true;
+    while (!done) {
+        auto len = ::recv(fd, buf.data(), buf.size(), 0);
+        if (len <= 0) {
+            ok = false;
             break;
-        close(sockfd);
+        }
+        auto nh = reinterpret_cast<nlmsghdr*>(buf.data());
+        for (; NLMSG_OK(nh, (unsigned)len); nh = NLMSG_NEXT(nh, len)) {
+            if (nh->nlmsg_type == NLMSG_DONE) {
+                done = true;
+            } else if (nh->nlmsg_type == NLMSG_ERROR) {
+                auto err = reinterpret_cast<nlmsgerr*>(NLMSG_DATA(nh));
+                ok = (err->error == 0);
+                done = true;
+            } else {
+                handler(nh);
+                if (!(nh->nlmsg_flags & NLM_F_MULTI)) done = true;
+            }
+            if (done) break;
+        }
     }
+    ::close(fd);
+    return ok;
+}
+
+static std::optional<IPAddress> parseAddr(const rtattr* attr)
+{
+    auto addr = scion::AddressTraits<IPAddress>::fromBytes(std::span<const std::byte>(
+        reinterpret_cast<const std::byte*>(RTA_DATA(attr)), RTA_PAYLOAD(attr)));
+    if (scion::isError(addr)) return std::nullopt;
+    return *addr;
+}
 
-    freeaddrinfo(result);
-    if (sockfd < 0) return std::nullopt;
+/// \brief Look up the preferred source address of the route to `dst`.
+static std::optional<IPAddress> routeGet(const IPAddress& dst)
+{
+    struct {
+        nlmsghdr nh;
+        rtmsg rtm;
+        alignas(NLMSG_ALIGNTO) std::byte attrs[RTA_SPACE(16)];
+    } req = {};
+    std::array<std::byte, 16> bytes;
+    [[maybe_unused]] auto ec = scion::AddressTraits<IPAddress>::toBytes(dst, bytes);
 
-    SockAddrT local = {};
-    socklen_t len = sizeof(local);
-    err = getsockname(sockfd, reinterpret_cast<sockaddr*>(&local), &len);
-    close(sockfd);
+    req.nh.nlmsg_len = NLMSG_LENGTH(sizeof(rtmsg)) + RTA_LENGTH(dst.size());
+    req.nh.nlmsg_type = RTM_GETROUTE;
+    req.nh.nlmsg_flags = NLM_F_REQUEST;
+    req.rtm.rtm_family = dst.is4() ? AF_INET : AF_INET6;
+    req.rtm.rtm_dst_len = (unsigned char)(8 * dst.size());
+    auto rta = reinterpret_cast<rtattr*>(req.attrs);
+    rta->rta_type = RTA_DST;
+    rta->rta_len = (unsigned short)RTA_LENGTH(dst.size());
+    std::memcpy(RTA_DATA(rta), bytes.data(), dst.size());
 
-    if (err < 0) {
-        return std::nullopt;
-    } else {
-        return scion::generic::toGenericAddr(EndpointTraits<SockAddrT>::getHost(local));
-    }
+    std::optional<IPAddress> src;
+    rtnlRequest(&req.nh, [&] (const nlmsghdr* nh) {
+        if (nh->nlmsg_type != RTM_NEWROUTE) return;
+        auto rtm = reinterpret_cast<const rtmsg*>(NLMSG_DATA(nh));
+        int len = (int)RTM_PAYLOAD(nh);
+        for (auto attr = RTM_RTA(rtm); RTA_OK(attr, len); attr = RTA_NEXT(attr, len)) {
+            if (attr->rta_type == RTA_PREFSRC) src = parseAddr(attr);
+        }
+    });
+    return src;
 }
 
+/// \brief Find the source address of the default route with the lowest metric
+/// in the main routing table.
+static std::optional<IPAddress> getDefaultAddr(int family)
+{
+    struct {
+        nlmsghdr nh;
+        rtmsg rtm;
+    } req = {};
+    req.nh.nlmsg_len = NLMSG_LENGTH(sizeof(rtmsg));
+    req.nh.nlmsg_type = RTM_GETROUTE;
+    req.nh.nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+    req.rtm.rtm_family = (unsigned char)family;
+
+    bool found = false;
+    std::uint32_t bestMetric = std::numeric_limits<std::uint32_t>::max();
+    std::optional<IPAddress> prefSrc, gateway;
+    bool ok = rtnlRequest(&req.nh, [&] (const nlmsghdr* nh) {
+        if (nh->nlmsg_type != RTM_NEWROUTE) return;
+        auto rtm = reinterpret_cast<const rtmsg*>(NLMSG_DATA(nh));
+        if (rtm->rtm_dst_len != 0 || rtm->rtm_type != RTN_UNICAST) return;
+        std::uint32_t table = rtm->rtm_table, metric = 0;
+        std::optional<IPAddress> src, gw;
+        int len = (int)RTM_PAYLOAD(nh);
+        for (auto attr = RTM_RTA(rtm); RTA_OK(attr, len); attr = RTA_NEXT(attr, len)) {
+            switch (attr->rta_type) {
+            case RTA_TABLE:
+                std::memcpy(&table, RTA_DATA(attr), sizeof(table));
+                break;
+            case RTA_PRIORITY:
+                std::memcpy(&metric, RTA_DATA(attr), sizeof(metric));
+                break;
+            case RTA_PREFSRC:
+                src = parseAddr(attr);
+                break;
+            case RTA_GATEWAY:
+                gw = parseAddr(attr);
+                break;
+            }
+        }
+        if (table != RT_TABLE_MAIN || (found && metric >= bestMetric)) return;
+        found = true;
+        bestMetric = metric;
+        prefSrc = src;
+        gateway = gw;
+    });
+    if (!ok || !found) return std::nullopt;
+    if (prefSrc) return prefSrc;
+    if (gateway) return routeGet(*gateway);
+    return routeGet(probeAddr(family));
+}
+
+#else
+
+/// \brief Find the source address the OS picks for `dst` by connecting a UDP
+/// socket. Connecting does not send any packets.
+static std::optional<IPAddress> routeGet(const IPAddress& dst)
+{
+    using namespace scion;
+    auto to = generic::toUnderlay<bsd::IPEndpoint>(generic::IPEndpoint(dst, 443));
+    if (isError(to)) return std::nullopt;
+    bsd::BSDSocket<bsd::IPEndpoint> s;
+    if (s.connect(*to)) return std::nullopt;
+    auto local = s.getsockname();
+    if (isError(local)) return std::nullopt;
+    return generic::toGenericAddr(EndpointTraits<bsd::IPEndpoint>::getHost(*local));
+}
+
+static std::optional<IPAddress> getDefaultAddr(int family)
+{
+    return routeGet(probeAddr(family));
+}
+
+#endif // __linux__
+
+namespace {
+struct DefaultAddrCache
+{
+    std::mutex mutex;
+    std::optional<std::optional<IPAddress>> addr4, addr6;
+};
+
+DefaultAddrCache& defaultAddrCache()
+{
+    static DefaultAddrCache cache;
+    return cache;
+}
+} // namespace
+
 namespace scion {
 namespace bsd {
 namespace details {
 
-/// \brief Get a local IPv4 address that was able to connect to the Internet.
+/// \brief Get the local IPv4 address of the default route. The result is
+/// cached until invalidateDefaultInterfaceAddr() is called.
 std::optional<generic::IPAddress> getDefaultInterfaceAddr4()
 {
-    static std::optional<generic::IPAddress> def = getDefaultAddr<sockaddr_in>(AF_INET);
-    return def;
+    auto& cache = defaultAddrCache();
+    std::lock_guard lock(cache.mutex);
+    if (!cache.addr4) cache.addr4 = getDefaultAddr(AF_INET);
+    return *cache.addr4;
 }
 
-/// \brief Get a local IPv6 address that was able to connect to the Internet.
+/// \brief Get the local IPv6 address of the default route. The result is
+/// cached until invalidateDefaultInterfaceAddr() is called.
 std::optional<generic::IPAddress> getDefaultInterfaceAddr6()
 {
-    static std::optional<generic::IPAddress> def = getDefaultAddr<sockaddr_in6>(AF_INET6);
-    return def;
+    auto& cache = defaultAddrCache();
+    std::lock_guard lock(cache.mutex);
+    if (!cache.addr6) cache.addr6 = getDefaultAddr(AF_INET6);
+    return *cache.addr6;
+}
+
+void invalidateDefaultInterfaceAddr()
+{
+    auto& cache = defaultAddrCache();
+    std::lock_guard lock(cache.mutex);
+    cache.addr4.reset();
+    cache.addr6.reset();
+}
+
+std::optional<generic::IPAddress> getSourceAddress(const generic::IPAddress& dst)
+{
+    return routeGet(dst);
 }
 
 } // namespace details
@@ -0,0 +1,310 @@
+// Copyright (c) 2024-2025 Lars-Christian Schulz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "scion/hdr/details.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define SCION_CHECKSUM_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define SCION_TARGET_AVX2
+#else
+#define SCION_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define SCION_CHECKSUM_NEON 1
+#include <arm_neon.h>
+#endif
+
+
+namespace scion {
+namespace hdr {
+namespace details {
+
+namespace {
+
+using SumKernel = std::uint16_t(*)(const std::byte* data, std::size_t len);
+using CopyKernel = std::uint16_t(*)(std::byte* dst, const std::byte* src, std::size_t len);
+
+struct Kernels
+{
+    ChecksumImpl impl;
+    SumKernel sum;
+    CopyKernel copy;
+};
+
+std::uint16_t fold(std::uint64_t sum)
+{
+    while (sum >> 16) sum = (sum & 0xffffu) + (sum >> 16);
+    return std::uint16_t(sum);
+}
+
+// The kernels below sum `len` bytes starting at `src`. If `Copy` is true, the
+// data is also copied to `dst`.
+
+template <bool Copy>
+std::uint16_t sumScalar(std::byte* dst, const std::byte* src, std::size_t len)
+{
+    std::uint64_t sum = 0;
+    std::size_t i = 0;
+    for (; i + 4 <= len; i += 4) {
+        std::uint32_t word;
+        std::memcpy(&word, src + i, sizeof(word));
+        if constexpr (Copy) std::memcpy(dst + i, &word, sizeof(word));
+        sum += word;
+    }
+    if (i < len) {
+        std::uint16_t word;
+        std::memcpy(&word, src + i, sizeof(word));
+        if constexpr (Copy) std::memcpy(dst + i, &word, sizeof(word));
+        sum += word;
+    }
+    return fold(sum);
+}
+
+#if SCION_CHECKSUM_X86
+// Each iteration adds at most 0xffff to every 32-bit lane of the accumulators,
+// so they have to be widened to 64 bits at least every 65536 iterations.
+constexpr std::size_t MAX_INNER_ITERATIONS = 65536;
+
+template <bool Copy>
+std::uint16_t sumSSE2(std::byte* dst, const std::byte* src, std::size_t len)
+{
+    const __m128i zero = _mm_setzero_si128();
+    __m128i acc64 = _mm_setzero_si128();
+    std::size_t i = 0;
+    while (i + 16 <= len) {
+        __m128i acc32a = _mm_setzero_si128();
+        __m128i acc32b = _mm_setzero_si128();
+        auto end = std::min(len - (len - i) % 16, i + 16 * MAX_INNER_ITERATIONS);
+        for (; i < end; i += 16) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+            if constexpr (Copy) _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), v);
+            acc32a = _mm_add_epi32(acc32a, _mm_unpacklo_epi16(v, zero));
+            acc32b = _mm_add_epi32(acc32b, _mm_unpackhi_epi16(v, zero));
+        }
+        acc64 = _mm_add_epi64(acc64, _mm_unpacklo_epi32(acc32a, zero));
+        acc64 = _mm_add_epi64(acc64, _mm_unpackhi_epi32(acc32a, zero));
+        acc64 = _mm_add_epi64(acc64, _mm_unpacklo_epi32(acc32b, zero));
+        acc64 = _mm_add_epi64(acc64, _mm_unpackhi_epi32(acc32b, zero));
+    }
+    alignas(16) std::uint64_t lanes[2];
+    _mm_store_si128(reinterpret_cast<__m128i*>(lanes), acc64);
+    std::uint64_t sum = fold(lanes[0]) + fold(lanes[1]);
+    if (i < len) sum += sumScalar<Copy>(dst + i, src + i, len - i);
+    return fold(sum);
+}
+
+template <bool Copy>
+SCION_TARGET_AVX2
+std::uint16_t sumAVX2(std::byte* dst, const std::byte* src, std::size_t len)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i acc64 = _mm256_setzero_si256();
+    std::size_t i = 0;
+    while (i + 32 <= len) {
+        __m256i acc32a = _mm256_setzero_si256();
+        __m256i acc32b = _mm256_setzero_si256();
+        auto end = std::min(len - (len - i) % 32, i + 32 * MAX_INNER_ITERATIONS);
+        for (; i < end; i += 32) {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+            if constexpr (Copy) _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), v);
+            acc32a = _mm256_add_epi32(acc32a, _mm256_unpacklo_epi16(v, zero));
+            acc32b = _mm256_add_epi32(acc32b, _mm256_unpackhi_epi16(v, zero));
+        }
+        acc64 = _mm256_add_epi64(acc64, _mm256_unpacklo_epi32(acc32a, zero));
+        acc64 = _mm256_add_epi64(acc64, _mm256_unpackhi_epi32(acc32a, zero));
+        acc64 = _mm256_add_epi64(acc64, _mm256_unpacklo_epi32(acc32b, zero));
+        acc64 = _mm256_add_epi64(acc64, _mm256_unpackhi_epi32(acc32b, zero));
+    }
+    alignas(32) std::uint64_t lanes[4];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), acc64);
+    std::uint64_t sum = fold(lanes[0]) + fold(lanes[1]) + fold(lanes[2]) + fold(lanes[3]);
+    if (i < len) sum += sumScalar<Copy>(dst + i, src + i, len - i);
+    return fold(sum);
+}
+
+bool cpuHasAVX2()
+{
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) return false;
+    __cpuid(info, 1);
+    bool osxsave = info[2] & (1 << 27), avx = info[2] & (1 << 28);
+    if (!osxsave || !avx || (_xgetbv(0) & 6) != 6) return false;
+    __cpuidex(info, 7, 0);
+    return info[1] & (1 << 5);
+#else
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+#endif // SCION_CHECKSUM_X86
+
+#if SCION_CHECKSUM_NEON
+// Each iteration adds at most 2 * 0xffff to every 32-bit lane.
+constexpr std::size_t MAX_INNER_ITERATIONS = 32768;
+
+template <bool Copy>
+std::uint16_t sumNEON(std::byte* dst, const std::byte* src, std::size_t len)
+{
+    uint64x2_t acc64 = vdupq_n_u64(0);
+    std::size_t i = 0;
+    while (i + 16 <= len) {
+        uint32x4_t acc32 = vdupq_n_u32(0);
+        auto end = std::min(len - (len - i) % 16, i + 16 * MAX_INNER_ITERATIONS);
+        for (; i < end; i += 16) {
+            uint8x16_t v = vld1q_u8(reinterpret_cast<const std::uint8_t*>(src + i));
+            if constexpr (Copy) vst1q_u8(reinterpret_cast<std::uint8_t*>(dst + i), v);
+            acc32 = vpadalq_u16(acc32, vreinterpretq_u16_u8(v));
+        }
+        acc64 = vpadalq_u32(acc64, acc32);
+    }
+    std::uint64_t sum = fold(vgetq_lane_u64(acc64, 0)) + fold(vgetq_lane_u64(acc64, 1));
+    if (i < len) sum += sumScalar<Copy>(dst + i, src + i, len - i);
+    return fold(sum);
+}
+#endif // SCION_CHECKSUM_NEON
+
+constexpr Kernels scalarKernels = {
+    ChecksumImpl::Scalar,
+    [] (const std::byte* data, std::size_t len) { return sumScalar<false>(nullptr, data, len); },
+    &sumScalar<true>,
+};
+#if SCION_CHECKSUM_X86
+constexpr Kernels sse2Kernels = {
+    ChecksumImpl::SSE2,
+    [] (const std::byte* data, std::size_t len) { return sumSSE2<false>(nullptr, data, len); },
+    &sumSSE2<true>,
+};
+constexpr Kernels avx2Kernels = {
+    ChecksumImpl::AVX2,
+    [] (const std::byte* data, std::size_t len) { return sumAVX2<false>(nullptr, data, len); },
+    &sumAVX2<true>,
+};
+#endif
+#if SCION_CHECKSUM_NEON
+constexpr Kernels neonKernels = {
+    ChecksumImpl::NEON,
+    [] (const std::byte* data, std::size_t len) { return sumNEON<false>(nullptr, data, len); },
+    &sumNEON<true>,
+};
+#endif
+
+const Kernels* getKernels(ChecksumImpl impl)
+{
+    switch (impl) {
+    case ChecksumImpl::Scalar:
+        return &scalarKernels;
+#if SCION_CHECKSUM_X86
+    case ChecksumImpl::SSE2:
+        return &sse2Kernels;
+    case ChecksumImpl::AVX2:
+        return cpuHasAVX2() ? &avx2Kernels : nullptr;
+#endif
+#if SCION_CHECKSUM_NEON
+    case ChecksumImpl::NEON:
+        return &neonKernels;
+#endif
+    default:
+        return nullptr;
+    }
+}
+
+ChecksumImpl bestImpl()
+{
+#if SCION_CHECKSUM_X86
+    return cpuHasAVX2() ? ChecksumImpl::AVX2 : ChecksumImpl::SSE2;
+#elif SCION_CHECKSUM_NEON
+    return ChecksumImpl::NEON;
+#else
+    return ChecksumImpl::Scalar;
+#endif
+}
+
+const Kernels* resolve();
+
+// Placeholder selecting the best implementation on first use.
+constexpr Kernels resolveKernels = {
+    ChecksumImpl::Scalar,
+    [] (const std::byte* data, std::size_t len) {
+        return resolve()->sum(data, len);
+    },
+    [] (std::byte* dst, const std::byte* src, std::size_t len) {
+        return resolve()->copy(dst, src, len);
+    },
+};
+
+// Constant-initialized so that checksums can be computed during static
+// initialization of other translation units.
+std::atomic<const Kernels*> activeKernels = &resolveKernels;
+
+const Kernels* resolve()
+{
+    auto kernels = activeKernels.load(std::memory_order_relaxed);
+    if (kernels == &resolveKernels) {
+        kernels = getKernels(bestImpl());
+        activeKernels.store(kernels, std::memory_order_relaxed);
+    }
+    return kernels;
+}
+
+} // namespace
+
+std::uint16_t onesComplementSumNative(std::span<const std::byte> data)
+{
+    return activeKernels.load(std::memory_order_relaxed)->sum(data.data(), data.size());
+}
+
+std::uint16_t onesComplementSumNativeCopy(
+    std::span<std::byte> dst, std::span<const std::byte> src)
+{
+    assert(dst.size() >= src.size());
+    return activeKernels.load(std::memory_order_relaxed)->copy(
+        dst.data(), src.data(), src.size());
+}
+
+ChecksumImpl getChecksumImpl()
+{
+    return resolve()->impl;
+}
+
+bool isChecksumImplSupported(ChecksumImpl impl)
+{
+    return getKernels(impl) != nullptr;
+}
+
+bool setChecksumImpl(ChecksumImpl impl)
+{
+    auto kernels = getKernels(impl);
+    if (!kernels) return false;
+    activeKernels.store(kernels, std::memory_order_relaxed);
+    return true;
+}
+
+} // namespace details
+} // namespace hdr
+} // namespace scion
@@ -48,23 +48,39 @@ std::ostream& operator<<(std::ostream& stream, const RawPath& rp)
     return stream;
 }
 
+std::ostream& operator<<(std::ostream& stream, const RawPathView& rp)
+{
+    stream << std::format("{}", rp);
+    return stream;
+}
+
 std::ostream& operator<<(std::ostream& stream, const Path& path)
 {
     stream << std::format("{}", path);
     return stream;
 }
 
-PathDigest RawPath::digest() const
+template <typename Path>
+static PathDigest digestFromHops(const Path& path)
 {
-    if (!m_digest) {
-        std::array<std::pair<std::uint16_t, std::uint16_t>, 64> buffer;
-        std::size_t i = 0;
-        for (auto hop : hops()) {
-            if (i >= buffer.size()) break;
-            buffer[i++] = hop;
-        }
-        m_digest = details::computeDigest(m_source, buffer);
+    std::array<std::pair<std::uint16_t, std::uint16_t>, 64> buffer;
+    std::size_t i = 0;
+    for (auto hop : path.hops()) {
+        if (i >= buffer.size()) break;
+        buffer[i++] = hop;
     }
+    return details::computeDigest(path.firstAS(), buffer);
+}
+
+PathDigest RawPath::digest() const
+{
+    if (!m_digest) m_digest = digestFromHops(*this);
+    return *m_digest;
+}
+
+PathDigest RawPathView::digest() const
+{
+    if (!m_digest) m_digest = digestFromHops(*this);
     return *m_digest;
 }
 
@@ -19,6 +19,7 @@
 // SOFTWARE.
 
 #include "scion/asio/udp_socket.hpp"
+#include "scion/bsd/udp_socket.hpp"
 #include "scion/extensions/idint.hpp"
 #include "scion/scmp/handler.hpp"
 
@@ -26,8 +27,13 @@
 #include "gmock/gmock.h"
 #include "utilities.hpp"
 
+#include <algorithm>
 #include <array>
 #include <chrono>
+#include <functional>
+#include <memory>
+#include <new>
+#include <utility>
 #include <vector>
 
 
@@ -570,16 +576,329 @@ TEST_F(AsioUdpSocketFixture, SendCachedAsync)
     ioCtx.run();
 }
 
+// Test receiving batches of packets asynchronously.
+TEST_F(AsioUdpSocketFixture, SendInPlaceAsync)
+{
+    using namespace scion;
+    using namespace boost::asio;
+
+    HeaderCache headers;
+    std::vector<std::byte> buffer(1024);
+    static const std::array<std::byte, 8> payload = {
+        1_b, 2_b, 3_b, 4_b, 5_b, 6_b, 7_b, 8_b
+    };
+    constexpr std::size_t headroom = 128;
+    std::vector<std::byte> packet(headroom + payload.size());
+    std::ranges::copy(payload, packet.begin() + headroom);
+
+    constexpr auto token = boost::asio::use_awaitable;
+    auto test = [&] () -> awaitable<void>
+    {
+        auto nh = unwrap(toUnderlay<Socket::UnderlayEp>(ep2.getLocalEp()));
+        auto sent = co_await sock1->sendToInPlaceAsync(
+            headers, ep2, RawPath(), nh, packet, headroom, token);
+        EXPECT_FALSE(isError(sent)) << getError(sent);
+        if (isError(sent)) co_return;
+        EXPECT_THAT(get(sent), testing::ElementsAreArray(payload));
+
+        sent = co_await sock1->sendCachedInPlaceAsync(headers, nh, packet, 8, token);
+        EXPECT_TRUE(isError(sent));
+        EXPECT_EQ(getError(sent), ErrorCode::BufferTooSmall);
+
+        sent = sock1->sendCachedInPlace(headers, nh, packet, headroom);
+        EXPECT_FALSE(isError(sent)) << getError(sent);
+
+        Socket::UnderlayEp ulSource;
+        for (int i = 0; i < 2; ++i) {
+            auto recvd = co_await sock2->recvAsync(buffer, ulSource, token);
+            EXPECT_FALSE(isError(recvd)) << getError(recvd);
+            if (isError(recvd)) co_return;
+            EXPECT_THAT(get(recvd), testing::ElementsAreArray(payload));
+        }
+    };
+
+    ioCtx.restart();
+    co_spawn(ioCtx, test(), detached);
+    ioCtx.run();
+}
+
+TEST_F(AsioUdpSocketFixture, SendReplyAsync)
+{
+    using namespace scion;
+    using namespace boost::asio;
+
+    HeaderCache headers;
+    std::vector<std::byte> buffer(1024);
+    static const std::array<std::byte, 8> payload = {
+        1_b, 2_b, 3_b, 4_b, 5_b, 6_b, 7_b, 8_b
+    };
+
+    constexpr auto token = boost::asio::use_awaitable;
+    auto test = [&] () -> awaitable<void>
+    {
+        auto nh = unwrap(toUnderlay<Socket::UnderlayEp>(ep2.getLocalEp()));
+        auto sent = co_await sock1->sendToAsync(headers, ep2, RawPath(), nh, payload, token);
+        EXPECT_FALSE(isError(sent)) << getError(sent);
+
+        // Echo the received packet
+        Socket::UnderlayEp ulSource;
+        auto recvd = co_await sock2->recvAsync(buffer, ulSource, token);
+        EXPECT_FALSE(isError(recvd)) << getError(recvd);
+        if (isError(recvd)) co_return;
+        auto packet = std::span(buffer).first(
+            (std::size_t)(get(recvd).data() - buffer.data()) + get(recvd).size());
+        sent = co_await sock2->sendReplyAsync(packet, payload.size(), ulSource, token);
+        EXPECT_FALSE(isError(sent)) << getError(sent);
+
+        Socket::Endpoint from;
+        recvd = co_await sock1->recvFromAsync(buffer, from, ulSource, token);
+        EXPECT_FALSE(isError(recvd)) << getError(recvd);
+        if (isError(recvd)) co_return;
+        EXPECT_THAT(get(recvd), testing::ElementsAreArray(payload));
+        EXPECT_EQ(from, ep2);
+    };
+
+    ioCtx.restart();
+    co_spawn(ioCtx, test(), detached);
+    ioCtx.run();
+}
+
+TEST(AsioUdpSocket, RecvManyAsync)
+{
+    using namespace scion;
+    using namespace boost::asio;
+    using namespace std::chrono_literals;
+    using Socket = scion::asio::UDPSocket;
+    using Sender = scion::bsd::UDPSocket<scion::bsd::BSDSocket<scion::bsd::IPEndpoint>>;
+
+    constexpr std::size_t PACKETS = 20;
+    auto ep = unwrap(Socket::Endpoint::Parse("[1-ff00:0:1,::1]:0"));
+
+    io_context ioCtx(1);
+    Sender sock1;
+    Socket sock2(ioCtx);
+    sock1.bind(ep);
+    sock2.bind(ep);
+
+    std::size_t received = 0, batches = 0;
+    std::vector<std::byte> buffer(8 * 1024);
+    std::vector<ReceivedPacket<Socket::UnderlayEp>> packets(8);
+    auto loop = [&] () -> awaitable<void>
+    {
+        while (received < PACKETS) {
+            auto batch = co_await sock2.recvManyAsync(buffer, packets, use_awaitable);
+            EXPECT_FALSE(isError(batch)) << getError(batch);
+            if (isError(batch)) co_return;
+            EXPECT_LE(batch->size(), packets.size());
+            ++batches;
+            for (const auto& pkt : *batch) {
+                EXPECT_EQ(pkt.payload.size(), 1);
+                EXPECT_EQ(pkt.payload[0], std::byte(received++));
+                EXPECT_EQ(pkt.from, sock1.getLocalEp());
+                EXPECT_EQ(pkt.localAddr, sock2.getLocalEp().getHost());
+            }
+        }
+    };
+    co_spawn(ioCtx, loop(), detached);
+
+    // Nothing to receive yet
+    ioCtx.run_for(10ms);
+    EXPECT_EQ(received, 0);
+
+    HeaderCache headers;
+    auto nh = unwrap(toUnderlay<Sender::UnderlayEp>(sock2.getLocalEp().getLocalEp()));
+    for (std::size_t i = 0; i < PACKETS; ++i) {
+        std::array<std::byte, 1> payload = {std::byte(i)};
+        auto sent = sock1.sendTo(headers, sock2.getLocalEp(), RawPath(), nh, payload);
+        ASSERT_FALSE(isError(sent)) << getError(sent);
+    }
+    ioCtx.run_for(1s);
+    EXPECT_EQ(received, PACKETS);
+    EXPECT_EQ(batches, (PACKETS + packets.size() - 1) / packets.size());
+}
+
+// Test that the steady-state coroutine receive loop does not allocate memory.
+// Freed memory blocks of a RecyclingAllocator.
+struct AllocationPool
+{
+    std::size_t allocations = 0;
+    std::size_t requests = 0;
+    std::vector<std::pair<void*, std::size_t>> free;
+
+    ~AllocationPool()
+    {
+        for (auto [p, size] : free) ::operator delete(p);
+    }
+};
+
+// Allocator keeping freed blocks for reuse. Counts how often it has to
+// allocate new memory.
+template <typename T>
+class RecyclingAllocator
+{
+public:
+    using value_type = T;
+    using Pool = AllocationPool;
+
+    explicit RecyclingAllocator(Pool& pool) : pool(&pool) {}
+
+    template <typename U>
+    RecyclingAllocator(const RecyclingAllocator<U>& other) : pool(other.pool) {}
+
+    T* allocate(std::size_t n)
+    {
+        auto size = n * sizeof(T);
+        ++pool->requests;
+        auto i = std::ranges::find(pool->free, size, &std::pair<void*, std::size_t>::second);
+        if (i != pool->free.end()) {
+            auto p = i->first;
+            pool->free.erase(i);
+            return static_cast<T*>(p);
+        }
+        ++pool->allocations;
+        return static_cast<T*>(::operator new(size));
+    }
+
+    void deallocate(T* p, std::size_t n)
+    {
+        pool->free.emplace_back(p, n * sizeof(T));
+    }
+
+    template <typename U>
+    bool operator==(const RecyclingAllocator<U>& other) const { return pool == other.pool; }
+
+private:
+    template <typename U> friend class RecyclingAllocator;
+    Pool* pool;
+};
+
+// Test that receive operations allocate through the associated allocator of
+// the completion handler and do not need new memory for every packet.
+TEST(AsioUdpSocket, RecvAsyncRecycling)
+{
+    using namespace scion;
+    using namespace boost::asio;
+    using Socket = scion::asio::UDPSocket;
+    using Sender = scion::bsd::UDPSocket<scion::bsd::BSDSocket<scion::bsd::IPEndpoint>>;
+
+    constexpr std::size_t WARMUP = 8, PACKETS = 64;
+    auto ep = unwrap(Socket::Endpoint::Parse("[1-ff00:0:1,::1]:0"));
+
+    io_context ioCtx(1);
+    Sender sock1;
+    Socket sock2(ioCtx);
+    ASSERT_FALSE(sock1.bind(ep));
+    ASSERT_FALSE(sock2.bind(ep));
+
+    HeaderCache headers;
+    static const std::array<std::byte, 8> payload = {
+        1_b, 2_b, 3_b, 4_b, 5_b, 6_b, 7_b, 8_b
+    };
+    auto nh = unwrap(toUnderlay<Sender::UnderlayEp>(sock2.getLocalEp().getLocalEp()));
+    for (std::size_t i = 0; i < WARMUP + PACKETS; ++i) {
+        auto sent = sock1.sendTo(headers, sock2.getLocalEp(), RawPath(), nh, payload);
+        ASSERT_FALSE(isError(sent)) << getError(sent);
+    }
+
+    AllocationPool pool;
+    RecyclingAllocator<std::byte> alloc(pool);
+    std::size_t received = 0, warmupAllocations = 0;
+    std::vector<std::byte> buffer(1024);
+    auto loop = [&] () -> awaitable<void>
+    {
+        Socket::UnderlayEp ulSource;
+        for (std::size_t i = 0; i < WARMUP + PACKETS; ++i) {
+            if (i == WARMUP) warmupAllocations = pool.allocations;
+            auto recvd = co_await sock2.recvAsync(
+                buffer, ulSource, bind_allocator(alloc, use_awaitable));
+            if (isError(recvd)) break;
+            ++received;
+        }
+    };
+
+    co_spawn(ioCtx, loop(), detached);
+    ioCtx.run();
+    EXPECT_EQ(received, WARMUP + PACKETS);
+    EXPECT_GE(pool.requests, WARMUP + PACKETS);
+    EXPECT_EQ(pool.allocations, warmupAllocations);
+}
+
 class MockSCMPHandler : public scion::ScmpHandlerImpl
 {
 public:
     MOCK_METHOD(bool, handleScmpCallback, (
         const scion::Address<scion::generic::IPAddress>&,
-        const scion::RawPath&,
+        const scion::RawPathView&,
         const scion::hdr::ScmpMessage& msg,
         std::span<const std::byte>), (override));
 };
 
+// Test receiving packets coalesced by UDP GRO.
+TEST(AsioUdpSocket, Gro)
+{
+    using namespace scion;
+    using namespace boost::asio;
+    using namespace std::chrono_literals;
+    using Socket = scion::asio::UDPSocket;
+    using Sender = scion::bsd::UDPSocket<scion::bsd::BSDSocket<scion::bsd::IPEndpoint>>;
+
+    auto ep1 = unwrap(Socket::Endpoint::Parse("[1-ff00:0:1,::1]:0"));
+    auto ep2 = ep1;
+
+    io_context ioCtx;
+    Sender sock1;
+    Socket sock2(ioCtx);
+    sock1.bind(ep1);
+    ep1 = sock1.getLocalEp();
+    sock2.bind(ep2);
+    ep2 = sock2.getLocalEp();
+    sock1.connect(ep2);
+    ASSERT_FALSE(sock2.setGro(true));
+
+    std::array<std::array<std::byte, 100>, 6> payloads;
+    for (std::size_t i = 0; i < payloads.size(); ++i) {
+        std::ranges::fill(payloads[i], std::byte(i));
+    }
+    std::array<std::span<const std::byte>, 6> burst;
+    std::ranges::copy(payloads, burst.begin());
+    burst.back() = burst.back().first(50);
+
+    HeaderCache headers;
+    std::vector<std::byte> scratch(4096);
+    auto nh = unwrap(toUnderlay<Sender::UnderlayEp>(ep2.getLocalEp()));
+    auto sent = sock1.send(headers, RawPath(), nh, burst[0]);
+    ASSERT_FALSE(isError(sent)) << getError(sent);
+    auto count = sock1.sendCachedBurst(headers, nh, burst, scratch);
+    ASSERT_FALSE(isError(count)) << getError(count);
+    count = sock1.sendCachedBurst(headers, nh, burst, scratch);
+    ASSERT_FALSE(isError(count)) << getError(count);
+
+    // synchronous receive
+    std::vector<std::byte> buffer(65536);
+    auto recvd = sock2.recv(buffer);
+    ASSERT_FALSE(isError(recvd)) << getError(recvd);
+    EXPECT_THAT(get(recvd), testing::ElementsAreArray(burst[0]));
+    for (const auto& payload : burst) {
+        recvd = sock2.recv(buffer);
+        ASSERT_FALSE(isError(recvd)) << getError(recvd);
+        EXPECT_THAT(get(recvd), testing::ElementsAreArray(payload));
+    }
+
+    // asynchronous receive
+    std::size_t i = 0;
+    Socket::UnderlayEp ulSource;
+    std::function<void(Maybe<std::span<std::byte>>)> recvHandler;
+    recvHandler = [&] (Maybe<std::span<std::byte>> recvd) {
+        ASSERT_FALSE(isError(recvd)) << getError(recvd);
+        EXPECT_THAT(*recvd, testing::ElementsAreArray(burst[i]));
+        if (++i < burst.size()) sock2.recvAsync(buffer, ulSource, recvHandler);
+    };
+    sock2.recvAsync(buffer, ulSource, recvHandler);
+
+    ioCtx.run_for(1s);
+    EXPECT_EQ(i, burst.size());
+}
+
 // Test invoking the SCMP handler.
 TEST(AsioUdpSocket, SCMPHandler)
 {
@@ -613,7 +932,7 @@ TEST(AsioUdpSocket, SCMPHandler)
     std::span<const std::byte> payload;
 
     MockSCMPHandler handler;
-    EXPECT_CALL(handler, handleScmpCallback(from, rp, msg, _)).Times(1);
+    EXPECT_CALL(handler, handleScmpCallback(from, testing::Eq(rp), msg, _)).Times(1);
     sock2.setNextScmpHandler(&handler);
 
     auto nh = unwrap(toUnderlay<Socket::UnderlayEp>(ep2.getLocalEp()));
@@ -659,7 +978,7 @@ TEST(AsioUdpSocket, SCMPHandlerAsync)
     std::span<const std::byte> payload;
 
     MockSCMPHandler handler;
-    EXPECT_CALL(handler, handleScmpCallback(from, rp, msg, _)).Times(1);
+    EXPECT_CALL(handler, handleScmpCallback(from, testing::Eq(rp), msg, _)).Times(1);
     sock2.setNextScmpHandler(&handler);
 
     auto nh = unwrap(toUnderlay<Socket::UnderlayEp>(ep2.getLocalEp()));
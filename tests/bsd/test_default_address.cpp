@@ -0,0 +1,59 @@
+// Copyright (c) 2024-2025 Lars-Christian Schulz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "scion/bsd/socket.hpp"
+
+#include "gtest/gtest.h"
+#include "utilities.hpp"
+
+
+TEST(DefaultAddress, SourceAddress)
+{
+    using namespace scion;
+    using namespace scion::bsd::details;
+
+    auto lo4 = unwrap(generic::IPAddress::Parse("127.0.0.1"));
+    EXPECT_EQ(getSourceAddress(lo4), lo4);
+    auto lo6 = unwrap(generic::IPAddress::Parse("::1"));
+    EXPECT_EQ(getSourceAddress(lo6), lo6);
+}
+
+TEST(DefaultAddress, Cache)
+{
+    using namespace scion::bsd::details;
+
+    // The result depends on the host, but must not change between calls and
+    // must be a local address.
+    auto addr4 = getDefaultInterfaceAddr4();
+    auto addr6 = getDefaultInterfaceAddr6();
+    EXPECT_EQ(getDefaultInterfaceAddr4(), addr4);
+    EXPECT_EQ(getDefaultInterfaceAddr6(), addr6);
+    invalidateDefaultInterfaceAddr();
+    EXPECT_EQ(getDefaultInterfaceAddr4(), addr4);
+    EXPECT_EQ(getDefaultInterfaceAddr6(), addr6);
+    if (addr4) {
+        EXPECT_TRUE(addr4->is4());
+        EXPECT_EQ(getSourceAddress(*addr4), addr4);
+    }
+    if (addr6) {
+        EXPECT_FALSE(addr6->is4());
+        EXPECT_EQ(getSourceAddress(*addr6), addr6);
+    }
+}
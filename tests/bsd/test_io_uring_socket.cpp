@@ -0,0 +1,223 @@
+// Copyright (c) 2024-2025 Lars-Christian Schulz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "scion/bsd/io_uring.hpp"
+#include "scion/bsd/udp_socket.hpp"
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+#include "utilities.hpp"
+
+#include <poll.h>
+
+#include <array>
+#include <chrono>
+#include <vector>
+
+
+class IoUringSocketFixture : public testing::Test
+{
+public:
+    using Socket = scion::bsd::UDPSocket<scion::bsd::IoUringSocket<scion::bsd::IPEndpoint>>;
+
+protected:
+    static void SetUpTestSuite()
+    {
+        using namespace scion;
+        using namespace std::chrono_literals;
+
+        ep1 = unwrap(Socket::Endpoint::Parse("[1-ff00:0:1,::1]:0"));
+        ep2 = ep1;
+
+        // io_uring may be missing, too old, or blocked by seccomp
+        if (auto ec = probe(); ec) {
+            if (ec == std::errc::function_not_supported
+                || ec == std::errc::operation_not_permitted
+                || ec == std::errc::invalid_argument
+                || ec == ErrorCode::NotImplemented) {
+                unavailable = ec;
+                return;
+            }
+        }
+
+        bindError = sock1.bind(ep1);
+        if (bindError) return;
+        ep1 = sock1.getLocalEp();
+        bindError = sock2.bind(ep2);
+        if (bindError) return;
+        ep2 = sock2.getLocalEp();
+
+        sock1.setRecvTimeout(1s);
+        sock2.setRecvTimeout(1s);
+
+        sock1.connect(ep2);
+        sock2.connect(ep1);
+    };
+
+    static void TearDownTestSuite()
+    {
+        sock1.close();
+        sock2.close();
+    }
+
+    void SetUp() override
+    {
+        if (unavailable) GTEST_SKIP() << "io_uring not available: " << unavailable.message();
+        ASSERT_FALSE(bindError) << bindError.message();
+    }
+
+    // Try to set up a ring with a multishot receive operation.
+    static std::error_code probe()
+    {
+        using namespace scion;
+        bsd::IoUringSocket<bsd::IPEndpoint> socket;
+        auto addr = unwrap(generic::toUnderlay<bsd::IPEndpoint>(
+            unwrap(generic::IPEndpoint::Parse("[::1]:0"))));
+        return socket.bind(addr);
+    }
+
+    inline static std::error_code unavailable, bindError;
+    inline static Socket::Endpoint ep1, ep2;
+    inline static Socket sock1, sock2;
+};
+
+TEST_F(IoUringSocketFixture, SendRecv)
+{
+    using namespace scion;
+
+    HeaderCache headers;
+    std::vector<std::byte> buffer(1024);
+    static const std::array<std::byte, 8> payload = {
+        1_b, 2_b, 3_b, 4_b, 5_b, 6_b, 7_b, 8_b
+    };
+
+    auto nh = unwrap(toUnderlay<Socket::UnderlayEp>(ep2.getLocalEp()));
+    for (int i = 0; i < 3; ++i) {
+        auto sent = sock1.send(headers, RawPath(), nh, payload);
+        ASSERT_FALSE(isError(sent)) << getError(sent);
+    }
+
+    for (int i = 0; i < 3; ++i) {
+        Socket::Endpoint from;
+        RawPath path;
+        Socket::UnderlayEp ulSource;
+        auto recvd = sock2.recvFromVia(buffer, from, path, ulSource);
+        ASSERT_FALSE(isError(recvd)) << getError(recvd);
+        EXPECT_THAT(get(recvd), testing::ElementsAreArray(payload));
+        EXPECT_EQ(from, ep1);
+        EXPECT_EQ(
+            EndpointTraits<bsd::IPEndpoint>::getHost(ulSource),
+            unwrap(AddressTraits<bsd::IPAddress>::fromString("::1")));
+    }
+}
+
+TEST_F(IoUringSocketFixture, RecvBatch)
+{
+    using namespace scion;
+
+    HeaderCache headers;
+    static const std::array<std::byte, 8> payload = {
+        1_b, 2_b, 3_b, 4_b, 5_b, 6_b, 7_b, 8_b
+    };
+    static const std::array<std::byte, 4> payload2 = {
+        4_b, 3_b, 2_b, 1_b
+    };
+
+    auto nh = unwrap(toUnderlay<Socket::UnderlayEp>(ep2.getLocalEp()));
+    auto sent = sock1.send(headers, RawPath(), nh, payload);
+    ASSERT_FALSE(isError(sent)) << getError(sent);
+    sent = sock1.sendCached(headers, nh, payload2);
+    ASSERT_FALSE(isError(sent)) << getError(sent);
+
+    std::vector<std::byte> buffer(4 * 1024);
+    std::vector<ReceivedPacket<Socket::UnderlayEp>> packets(4);
+    std::vector<std::span<const std::byte>> expected = {payload, payload2};
+    std::size_t i = 0;
+    while (i < expected.size()) {
+        auto recvd = sock2.recvBatch(buffer, packets);
+        ASSERT_FALSE(isError(recvd)) << getError(recvd);
+        for (const auto& pkt : *recvd) {
+            ASSERT_LT(i, expected.size());
+            EXPECT_THAT(pkt.payload, testing::ElementsAreArray(expected[i++]));
+            EXPECT_EQ(pkt.from, ep1);
+        }
+    }
+}
+
+// Test receive timeout and nonblocking receive.
+TEST_F(IoUringSocketFixture, NoData)
+{
+    using namespace scion;
+
+    std::vector<std::byte> buffer(1024);
+    auto recvd = sock2.recv(buffer);
+    ASSERT_TRUE(isError(recvd));
+    EXPECT_EQ(getError(recvd), std::errc::resource_unavailable_try_again);
+
+    ASSERT_FALSE(sock2.setNonblocking(true));
+    recvd = sock2.recv(buffer);
+    ASSERT_TRUE(isError(recvd));
+    EXPECT_EQ(getError(recvd), std::errc::resource_unavailable_try_again);
+    ASSERT_FALSE(sock2.setNonblocking(false));
+}
+
+// Test receiving a datagram larger than the receive buffer.
+TEST_F(IoUringSocketFixture, BufferTooSmall)
+{
+    using namespace scion;
+
+    static const std::array<std::byte, 128> payload = {};
+    HeaderCache headers;
+    auto nh = unwrap(toUnderlay<Socket::UnderlayEp>(ep2.getLocalEp()));
+    auto sent = sock1.send(headers, RawPath(), nh, payload);
+    ASSERT_FALSE(isError(sent)) << getError(sent);
+
+    std::vector<std::byte> buffer(64);
+    auto recvd = sock2.recv(buffer);
+    ASSERT_TRUE(isError(recvd));
+    EXPECT_EQ(getError(recvd), ErrorCode::BufferTooSmall);
+}
+
+// Test polling the ring before the first receive call.
+TEST_F(IoUringSocketFixture, PollRing)
+{
+    using namespace scion;
+
+    Socket sock;
+    ASSERT_FALSE(sock.bind(unwrap(Socket::Endpoint::Parse("[1-ff00:0:1,::1]:0"))));
+    auto ep = sock.getLocalEp();
+    int ringFd = sock.getUnderlay().getRingHandle();
+    ASSERT_GE(ringFd, 0);
+
+    static const std::array<std::byte, 8> payload = {};
+    HeaderCache headers;
+    auto nh = unwrap(toUnderlay<Socket::UnderlayEp>(ep.getLocalEp()));
+    auto sent = sock1.sendTo(headers, ep, RawPath(), nh, payload);
+    ASSERT_FALSE(isError(sent)) << getError(sent);
+
+    pollfd pfd = {.fd = ringFd, .events = POLLIN, .revents = 0};
+    ASSERT_EQ(::poll(&pfd, 1, 1000), 1);
+    EXPECT_TRUE(pfd.revents & POLLIN);
+
+    std::vector<std::byte> buffer(1024);
+    auto recvd = sock.recv(buffer);
+    ASSERT_FALSE(isError(recvd)) << getError(recvd);
+    EXPECT_THAT(get(recvd), testing::ElementsAreArray(payload));
+}
@@ -0,0 +1,91 @@
+// Copyright (c) 2024-2025 Lars-Christian Schulz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "scion/bsd/sharded_server.hpp"
+#include "scion/bsd/udp_socket.hpp"
+
+#include "gtest/gtest.h"
+#include "utilities.hpp"
+
+#include <array>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <vector>
+
+
+TEST(ShardedUDPServer, SteerByFlow)
+{
+    using namespace scion;
+    using namespace std::chrono_literals;
+    using Socket = bsd::UDPSocket<>;
+    constexpr std::size_t SHARDS = 4, CLIENTS = 8, PACKETS = 5;
+
+    bsd::ShardedUDPServer<Socket> server;
+    auto ec = server.bind(unwrap(Socket::Endpoint::Parse("[1-ff00:0:1,::1]:0")), SHARDS);
+    ASSERT_FALSE(ec) << ec;
+    ASSERT_EQ(server.size(), SHARDS);
+    auto serverEp = server.getLocalEp();
+    ASSERT_NE(serverEp.getPort(), 0);
+    for (std::size_t i = 0; i < SHARDS; ++i) {
+        EXPECT_EQ(server[i].getLocalEp(), serverEp);
+        server[i].setRecvTimeout(200ms);
+    }
+
+    // Send from multiple clients and remember which shard each client's flow
+    // must be steered to.
+    static const std::array<std::byte, 4> payload = {1_b, 2_b, 3_b, 4_b};
+    auto nh = unwrap(toUnderlay<Socket::UnderlayEp>(serverEp.getLocalEp()));
+    std::array<Socket, CLIENTS> clients;
+    std::map<Socket::Endpoint, std::size_t> expected;
+    for (auto& client : clients) {
+        ASSERT_FALSE(client.bind(unwrap(Socket::Endpoint::Parse("[1-ff00:0:1,::1]:0"))));
+        ASSERT_FALSE(client.connect(serverEp));
+        HeaderCache headers;
+        for (std::size_t i = 0; i < PACKETS; ++i) {
+            auto sent = client.send(headers, RawPath(), nh, payload);
+            ASSERT_FALSE(isError(sent)) << getError(sent);
+        }
+        auto hdr = headers.get();
+        auto flowId = (std::uint32_t(hdr[1]) & 0x0f) << 16
+            | std::uint32_t(hdr[2]) << 8 | std::uint32_t(hdr[3]);
+        expected[client.getLocalEp()] = flowId % SHARDS;
+    }
+
+    std::mutex mutex;
+    std::map<Socket::Endpoint, std::vector<std::size_t>> received;
+    server.run([&] (std::size_t shard, Socket& socket) {
+        std::array<std::byte, 1024> buffer;
+        while (true) {
+            Socket::Endpoint from;
+            auto recvd = socket.recvFrom(buffer, from);
+            if (isError(recvd)) break;
+            std::lock_guard lock(mutex);
+            received[from].push_back(shard);
+        }
+    });
+
+    ASSERT_EQ(received.size(), CLIENTS);
+    for (const auto& [from, shards] : received) {
+        EXPECT_EQ(shards.size(), PACKETS);
+        for (auto shard : shards) EXPECT_EQ(shard, expected.at(from));
+    }
+    server.close();
+}
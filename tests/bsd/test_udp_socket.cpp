@@ -26,8 +26,11 @@
 #include "gmock/gmock.h"
 #include "utilities.hpp"
 
+#include <algorithm>
 #include <array>
 #include <chrono>
+#include <span>
+#include <tuple>
 #include <vector>
 
 
@@ -224,6 +227,35 @@ TEST_F(UdpSocketFixture, SendToRecvFromVia)
     EXPECT_EQ(
         EndpointTraits<bsd::IPEndpoint>::getHost(ulSource),
         unwrap(AddressTraits<bsd::IPAddress>::fromString("::1")));
+
+    // Borrow the path from the receive buffer and reply on it
+    sent = sock1.sendTo(headers, ep2, RawPath(), nh, payload);
+    ASSERT_FALSE(isError(sent)) << getError(sent);
+    RawPathView view;
+    recvd = sock2.recvFromVia(buffer, from, view, ulSource);
+    ASSERT_FALSE(isError(recvd)) << getError(recvd);
+    EXPECT_TRUE(view.empty());
+    EXPECT_EQ(view, path);
+    auto nh1 = unwrap(toUnderlay<Socket::UnderlayEp>(ep1.getLocalEp()));
+    sent = sock2.sendTo(headers, from, view, nh1, payload);
+    ASSERT_FALSE(isError(sent)) << getError(sent);
+    recvd = sock1.recvFrom(buffer, from);
+    ASSERT_FALSE(isError(recvd)) << getError(recvd);
+    EXPECT_EQ(from, ep2);
+
+    // Intern the path
+    PathInternTable table;
+    std::array<InternedPathPtr, 2> interned;
+    for (auto& p : interned) {
+        sent = sock1.sendTo(headers, ep2, RawPath(), nh, payload);
+        ASSERT_FALSE(isError(sent)) << getError(sent);
+        recvd = sock2.recvFromVia(buffer, from, {table, p}, ulSource);
+        ASSERT_FALSE(isError(recvd)) << getError(recvd);
+        ASSERT_TRUE(p);
+        EXPECT_EQ(*p, path);
+    }
+    EXPECT_EQ(interned[0], interned[1]);
+    EXPECT_EQ(table.size(), 1);
 }
 
 TEST_F(UdpSocketFixture, SendToRecvFromViaExt)
@@ -302,6 +334,232 @@ TEST_F(UdpSocketFixture, SendCached)
     ASSERT_THAT(get(recvd), testing::ElementsAreArray(payload2));
 }
 
+TEST_F(UdpSocketFixture, SendToPooled)
+{
+    using namespace scion;
+
+    HeaderCachePool pool(8);
+    std::vector<std::byte> buffer(1024);
+    static const std::array<std::byte, 8> payload = {
+        1_b, 2_b, 3_b, 4_b, 5_b, 6_b, 7_b, 8_b
+    };
+    static const std::array<std::byte, 4> payload2 = {
+        4_b, 3_b, 2_b, 1_b
+    };
+
+    auto nh = unwrap(toUnderlay<Socket::UnderlayEp>(ep2.getLocalEp()));
+    auto sent = sock1.sendTo(pool, ep2, RawPath(), nh, payload);
+    ASSERT_FALSE(isError(sent)) << getError(sent);
+    sent = sock1.sendTo(pool, ep2, RawPath(), nh, payload2);
+    ASSERT_FALSE(isError(sent)) << getError(sent);
+    EXPECT_EQ(pool.getStats().hits, 1);
+    EXPECT_EQ(pool.getStats().misses, 1);
+
+    Socket::Endpoint from;
+    auto recvd = sock2.recvFrom(buffer, from);
+    ASSERT_FALSE(isError(recvd)) << getError(recvd);
+    ASSERT_THAT(get(recvd), testing::ElementsAreArray(payload));
+    recvd = sock2.recvFrom(buffer, from);
+    ASSERT_FALSE(isError(recvd)) << getError(recvd);
+    ASSERT_THAT(get(recvd), testing::ElementsAreArray(payload2));
+    EXPECT_EQ(from, ep1);
+}
+
+TEST_F(UdpSocketFixture, SendInPlace)
+{
+    using namespace scion;
+
+    HeaderCache headers;
+    std::vector<std::byte> buffer(1024);
+    static const std::array<std::byte, 8> payload = {
+        1_b, 2_b, 3_b, 4_b, 5_b, 6_b, 7_b, 8_b
+    };
+    constexpr std::size_t headroom = 128;
+    std::vector<std::byte> packet(headroom + payload.size());
+    std::ranges::copy(payload, packet.begin() + headroom);
+
+    auto nh = unwrap(toUnderlay<Socket::UnderlayEp>(ep2.getLocalEp()));
+    auto sent = sock1.sendToInPlace(headers, ep2, RawPath(), nh, packet, headroom);
+    ASSERT_FALSE(isError(sent)) << getError(sent);
+    ASSERT_THAT(get(sent), testing::ElementsAreArray(payload));
+
+    std::ranges::fill(std::span(packet).subspan(headroom), 0xff_b);
+    sent = sock1.sendCachedInPlace(headers, nh, packet, headroom);
+    ASSERT_FALSE(isError(sent)) << getError(sent);
+
+    sent = sock1.sendCachedInPlace(headers, nh, packet, 8);
+    ASSERT_TRUE(isError(sent));
+    EXPECT_EQ(getError(sent), ErrorCode::BufferTooSmall);
+
+    Socket::Endpoint from;
+    auto recvd = sock2.recvFrom(buffer, from);
+    ASSERT_FALSE(isError(recvd)) << getError(recvd);
+    ASSERT_THAT(get(recvd), testing::ElementsAreArray(payload));
+    EXPECT_EQ(from, ep1);
+    recvd = sock2.recv(buffer);
+    ASSERT_FALSE(isError(recvd)) << getError(recvd);
+    ASSERT_THAT(get(recvd), testing::Each(0xff_b));
+}
+
+TEST_F(UdpSocketFixture, SendCachedBurst)
+{
+    using namespace scion;
+
+    HeaderCache headers;
+    std::vector<std::byte> buffer(1024);
+    std::array<std::array<std::byte, 100>, 6> payloads;
+    for (std::size_t i = 0; i < payloads.size(); ++i) {
+        std::ranges::fill(payloads[i], std::byte(i));
+    }
+    std::array<std::span<const std::byte>, 6> burst;
+    std::ranges::copy(payloads, burst.begin());
+    burst.back() = burst.back().first(50);
+
+    // create headers from scratch
+    auto nh = unwrap(toUnderlay<Socket::UnderlayEp>(ep2.getLocalEp()));
+    auto sent = sock1.send(headers, RawPath(), nh, burst[0]);
+    ASSERT_FALSE(isError(sent)) << getError(sent);
+    auto recvd = sock2.recv(buffer);
+    ASSERT_FALSE(isError(recvd)) << getError(recvd);
+
+    // scratch buffer is too small for the entire burst
+    std::vector<std::byte> scratch(512);
+    auto count = sock1.sendCachedBurst(headers, nh, burst, scratch);
+    ASSERT_FALSE(isError(count)) << getError(count);
+    EXPECT_EQ(get(count), burst.size());
+
+    for (const auto& payload : burst) {
+        recvd = sock2.recv(buffer);
+        ASSERT_FALSE(isError(recvd)) << getError(recvd);
+        EXPECT_THAT(get(recvd), testing::ElementsAreArray(payload));
+    }
+
+    // payloads of different sizes
+    std::array<std::span<const std::byte>, 2> invalid = {burst.back(), burst.front()};
+    count = sock1.sendCachedBurst(headers, nh, invalid, scratch);
+    ASSERT_TRUE(isError(count));
+    EXPECT_EQ(getError(count), ErrorCode::InvalidArgument);
+
+    // headers have not been built yet
+    HeaderCache empty;
+    std::array<std::span<const std::byte>, 2> emptyPayloads = {};
+    count = sock1.sendCachedBurst(empty, nh, emptyPayloads, scratch);
+    ASSERT_TRUE(isError(count));
+    EXPECT_EQ(getError(count), ErrorCode::InvalidArgument);
+}
+
+TEST_F(UdpSocketFixture, RecvBatch)
+{
+    using namespace scion;
+
+    HeaderCache headers;
+    static const std::array<std::byte, 8> payload = {
+        1_b, 2_b, 3_b, 4_b, 5_b, 6_b, 7_b, 8_b
+    };
+    static const std::array<std::byte, 4> payload2 = {
+        4_b, 3_b, 2_b, 1_b
+    };
+
+    auto nh = unwrap(toUnderlay<Socket::UnderlayEp>(ep2.getLocalEp()));
+    auto sent = sock1.send(headers, RawPath(), nh, payload);
+    ASSERT_FALSE(isError(sent)) << getError(sent);
+    sent = sock1.sendCached(headers, nh, payload2);
+    ASSERT_FALSE(isError(sent)) << getError(sent);
+    sent = sock1.sendCached(headers, nh, payload);
+    ASSERT_FALSE(isError(sent)) << getError(sent);
+
+    std::vector<std::byte> buffer(4 * 1024);
+    std::vector<ReceivedPacket<Socket::UnderlayEp>> packets(4);
+    auto recvd = sock2.recvBatch(buffer, packets);
+    ASSERT_FALSE(isError(recvd)) << getError(recvd);
+    ASSERT_EQ(recvd->size(), 3);
+    EXPECT_THAT((*recvd)[0].payload, testing::ElementsAreArray(payload));
+    EXPECT_THAT((*recvd)[1].payload, testing::ElementsAreArray(payload2));
+    EXPECT_THAT((*recvd)[2].payload, testing::ElementsAreArray(payload));
+    for (const auto& pkt : *recvd) {
+        EXPECT_EQ(pkt.from, ep1);
+        EXPECT_TRUE(pkt.path.empty());
+        EXPECT_EQ(
+            EndpointTraits<bsd::IPEndpoint>::getHost(pkt.ulSource),
+            unwrap(AddressTraits<bsd::IPAddress>::fromString("::1")));
+    }
+}
+
+TEST_F(UdpSocketFixture, SendReply)
+{
+    using namespace scion;
+
+    HeaderCache headers;
+    static const std::array<std::byte, 8> payload = {
+        1_b, 2_b, 3_b, 4_b, 5_b, 6_b, 7_b, 8_b
+    };
+
+    auto nh = unwrap(toUnderlay<Socket::UnderlayEp>(ep2.getLocalEp()));
+    auto sent = sock1.sendTo(headers, ep2, RawPath(), nh, payload);
+    ASSERT_FALSE(isError(sent)) << getError(sent);
+
+    std::vector<std::byte> buffer(1024);
+    std::vector<ReceivedPacket<Socket::UnderlayEp>> packets(1);
+    auto recvd = sock2.recvBatch(buffer, packets);
+    ASSERT_FALSE(isError(recvd)) << getError(recvd);
+    ASSERT_EQ(recvd->size(), 1);
+    auto& pkt = (*recvd)[0];
+    EXPECT_EQ(pkt.packet.data() + pkt.packet.size(), pkt.payload.data() + pkt.payload.size());
+
+    // Reply with the first half of the payload reversed
+    std::ranges::reverse(pkt.payload);
+    sent = sock2.sendReply(pkt.packet, 4, pkt.ulSource);
+    ASSERT_FALSE(isError(sent)) << getError(sent);
+
+    Socket::Endpoint from;
+    auto reply = sock1.recvFrom(buffer, from);
+    ASSERT_FALSE(isError(reply)) << getError(reply);
+    EXPECT_THAT(get(reply), testing::ElementsAre(8_b, 7_b, 6_b, 5_b));
+    EXPECT_EQ(from, ep2);
+}
+
+TEST_F(UdpSocketFixture, SendBatch)
+{
+    using namespace scion;
+
+    static const std::array<std::byte, 8> payload = {
+        1_b, 2_b, 3_b, 4_b, 5_b, 6_b, 7_b, 8_b
+    };
+    static const std::array<std::byte, 4> payload2 = {
+        4_b, 3_b, 2_b, 1_b
+    };
+
+    // initialize headers
+    std::array<HeaderCache<>, 3> headers;
+    auto nh = unwrap(toUnderlay<Socket::UnderlayEp>(ep2.getLocalEp()));
+    std::vector<std::byte> buffer(1024);
+    for (auto& cache : headers) {
+        auto sent = sock1.sendTo(cache, ep2, RawPath(), nh, payload);
+        ASSERT_FALSE(isError(sent)) << getError(sent);
+        auto recvd = sock2.recv(buffer);
+        ASSERT_FALSE(isError(recvd)) << getError(recvd);
+    }
+
+    using Entry = std::tuple<HeaderCache<>&, std::span<const std::byte>, Socket::UnderlayEp>;
+    std::vector<Entry> batch = {
+        Entry{headers[0], payload2, nh},
+        Entry{headers[1], payload, nh},
+        Entry{headers[2], payload2, nh},
+    };
+    auto sent = sock1.sendBatch(batch);
+    ASSERT_FALSE(isError(sent)) << getError(sent);
+    EXPECT_EQ(get(sent), 3);
+
+    for (const auto& expected : {std::span<const std::byte>(payload2),
+        std::span<const std::byte>(payload), std::span<const std::byte>(payload2)}) {
+        Socket::Endpoint from;
+        auto recvd = sock2.recvFrom(buffer, from);
+        ASSERT_FALSE(isError(recvd)) << getError(recvd);
+        EXPECT_THAT(get(recvd), testing::ElementsAreArray(expected));
+        EXPECT_EQ(from, ep1);
+    }
+}
+
 // Test binding to an address of the wrong type.
 TEST(UdpSocket, WrongBindAddr)
 {
@@ -337,12 +595,132 @@ TEST(UdpSocket, NotConnected)
     ASSERT_EQ(getError(sent), ErrorCode::InvalidArgument);
 }
 
+// Test receiving packets coalesced by UDP GRO.
+TEST(UdpSocket, Gro)
+{
+    using namespace scion;
+    using namespace std::chrono_literals;
+    using Socket = scion::bsd::UDPSocket<scion::bsd::BSDSocket<scion::bsd::IPEndpoint>>;
+
+    auto ep1 = unwrap(Socket::Endpoint::Parse("[1-ff00:0:1,::1]:0"));
+    auto ep2 = ep1;
+
+    Socket sock1, sock2;
+    sock1.bind(ep1);
+    ep1 = sock1.getLocalEp();
+    sock2.bind(ep2);
+    ep2 = sock2.getLocalEp();
+    sock2.setRecvTimeout(1s);
+    sock1.connect(ep2);
+    ASSERT_FALSE(sock2.setGro(true));
+
+    std::array<std::array<std::byte, 100>, 6> payloads;
+    for (std::size_t i = 0; i < payloads.size(); ++i) {
+        std::ranges::fill(payloads[i], std::byte(i));
+    }
+    std::array<std::span<const std::byte>, 6> burst;
+    std::ranges::copy(payloads, burst.begin());
+    burst.back() = burst.back().first(50);
+
+    HeaderCache headers;
+    std::vector<std::byte> scratch(4096);
+    auto nh = unwrap(toUnderlay<Socket::UnderlayEp>(ep2.getLocalEp()));
+    auto sent = sock1.send(headers, RawPath(), nh, burst[0]);
+    ASSERT_FALSE(isError(sent)) << getError(sent);
+    auto count = sock1.sendCachedBurst(headers, nh, burst, scratch);
+    ASSERT_FALSE(isError(count)) << getError(count);
+    count = sock1.sendCachedBurst(headers, nh, burst, scratch);
+    ASSERT_FALSE(isError(count)) << getError(count);
+
+    // receive packets one at a time
+    std::vector<std::byte> buffer(65536);
+    auto recvd = sock2.recv(buffer);
+    ASSERT_FALSE(isError(recvd)) << getError(recvd);
+    EXPECT_THAT(get(recvd), testing::ElementsAreArray(burst[0]));
+    for (const auto& payload : burst) {
+        Socket::Endpoint from;
+        recvd = sock2.recvFrom(buffer, from);
+        ASSERT_FALSE(isError(recvd)) << getError(recvd);
+        EXPECT_THAT(get(recvd), testing::ElementsAreArray(payload));
+        EXPECT_EQ(from, ep1);
+    }
+
+    // receive a batch
+    std::size_t i = 0;
+    std::vector<ReceivedPacket<Socket::UnderlayEp>> packets(4);
+    while (i < burst.size()) {
+        auto batch = sock2.recvBatch(buffer, packets);
+        ASSERT_FALSE(isError(batch)) << getError(batch);
+        for (const auto& pkt : *batch) {
+            ASSERT_LT(i, burst.size());
+            EXPECT_THAT(pkt.payload, testing::ElementsAreArray(burst[i++]));
+            EXPECT_EQ(pkt.from, ep1);
+        }
+    }
+}
+
+// Test receiving on a socket bound to a wildcard address and replying from the
+// address a packet was received on.
+TEST(UdpSocket, WildcardBind)
+{
+    using namespace scion;
+    using namespace std::chrono_literals;
+    using Socket = scion::bsd::UDPSocket<scion::bsd::BSDSocket<scion::bsd::IPEndpoint>>;
+
+    static const std::array<std::byte, 8> payload = {
+        1_b, 2_b, 3_b, 4_b, 5_b, 6_b, 7_b, 8_b
+    };
+
+    Socket server, client;
+    ASSERT_FALSE(server.bind(unwrap(Socket::Endpoint::Parse("[1-ff00:0:1,0.0.0.0]:0"))));
+    ASSERT_FALSE(client.bind(unwrap(Socket::Endpoint::Parse("[1-ff00:0:1,127.0.0.1]:0"))));
+    server.setRecvTimeout(100ms);
+    client.setRecvTimeout(1s);
+    auto port = server.getLocalEp().getPort();
+    auto serverEp = Socket::Endpoint(
+        server.getLocalEp().getIsdAsn(), unwrap(generic::IPAddress::Parse("127.0.0.2")), port);
+    auto nh = unwrap(toUnderlay<Socket::UnderlayEp>(serverEp.getLocalEp()));
+
+    // SCION destination does not match the underlay destination
+    HeaderCache headers;
+    auto wrongEp = Socket::Endpoint(
+        serverEp.getIsdAsn(), unwrap(generic::IPAddress::Parse("127.0.0.3")), port);
+    auto sent = client.sendTo(headers, wrongEp, RawPath(), nh, payload);
+    ASSERT_FALSE(isError(sent)) << getError(sent);
+
+    std::vector<std::byte> buffer(1024);
+    Socket::Endpoint from;
+    RawPath path;
+    Socket::UnderlayEp ulSource;
+    generic::IPAddress localAddr;
+    auto recvd = server.recvFromVia(buffer, from, path, ulSource, localAddr);
+    ASSERT_TRUE(isError(recvd));
+
+    // Matching destination
+    sent = client.sendTo(headers, serverEp, RawPath(), nh, payload);
+    ASSERT_FALSE(isError(sent)) << getError(sent);
+    recvd = server.recvFromVia(buffer, from, path, ulSource, localAddr);
+    ASSERT_FALSE(isError(recvd)) << getError(recvd);
+    EXPECT_THAT(get(recvd), testing::ElementsAreArray(payload));
+    EXPECT_EQ(from, client.getLocalEp());
+    EXPECT_EQ(localAddr, serverEp.getHost());
+
+    // Reply from the same address
+    sent = server.sendToFrom(headers, from, localAddr, path, ulSource, payload);
+    ASSERT_FALSE(isError(sent)) << getError(sent);
+    Socket::UnderlayEp replySource;
+    recvd = client.recvFromVia(buffer, from, path, replySource);
+    ASSERT_FALSE(isError(recvd)) << getError(recvd);
+    EXPECT_EQ(from, serverEp);
+    EXPECT_EQ(replySource, nh);
+}
+
 class MockSCMPHandler : public scion::ScmpHandlerImpl
 {
 public:
     MOCK_METHOD(bool, handleScmpCallback, (
         const scion::Address<scion::generic::IPAddress>&,
-        const scion::RawPath&,
+        const scion::RawPathView&,
         const scion::hdr::ScmpMessage& msg,
         std::span<const std::byte>), (override));
 };
@@ -381,7 +759,7 @@ TEST(UdpSocket, SCMPHandler)
     std::span<const std::byte> payload;
 
     MockSCMPHandler handler;
-    EXPECT_CALL(handler, handleScmpCallback(from, rp, msg, _)).Times(1);
+    EXPECT_CALL(handler, handleScmpCallback(from, testing::Eq(rp), msg, _)).Times(1);
     sock2.setNextScmpHandler(&handler);
 
     auto nh = unwrap(toUnderlay<Socket::UnderlayEp>(ep2.getLocalEp()));
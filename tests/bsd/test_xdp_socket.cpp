@@ -0,0 +1,222 @@
+// Copyright (c) 2024-2025 Lars-Christian Schulz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "scion/bsd/udp_socket.hpp"
+#include "scion/bsd/xdp.hpp"
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+#include "utilities.hpp"
+
+#include <array>
+#include <chrono>
+#include <cstdlib>
+#include <string_view>
+#include <vector>
+
+
+// Sends datagrams between two XDP sockets on either end of a veth pair. As
+// creating the veth pair changes the network configuration of the host, the
+// test only runs if the environment variable SCION_TEST_XDP is set to 1. It is
+// skipped if the veth pair cannot be created or the XDP program cannot be
+// attached, e.g., because of missing privileges.
+class XdpSocketFixture : public testing::Test
+{
+public:
+    using Socket = scion::bsd::UDPSocket<scion::bsd::XDPSocket<scion::bsd::IPEndpoint, 256>>;
+
+protected:
+    static void SetUpTestSuite()
+    {
+        using namespace scion;
+        using namespace std::chrono_literals;
+
+        auto env = std::getenv("SCION_TEST_XDP");
+        enabled = env && std::string_view(env) == "1";
+        if (!enabled) return;
+
+        std::system("ip link del scxdp0 2>/dev/null");
+        vethCreated = std::system(
+            "ip link add scxdp0 address 02:00:00:00:00:01 type veth"
+            " peer name scxdp1 address 02:00:00:00:00:02 2>/dev/null"
+            " && ip addr add 10.254.0.1/24 dev scxdp0"
+            " && ip addr add 10.254.0.2/24 dev scxdp1"
+            " && ip addr add 10.254.0.3/24 dev scxdp1"
+            " && sysctl -qw net.ipv4.conf.scxdp1.accept_local=1 net.ipv4.conf.scxdp1.rp_filter=0"
+            " && ip neigh replace 10.254.0.2 lladdr 02:00:00:00:00:02 dev scxdp0 nud permanent"
+            " && ip neigh replace 10.254.0.3 lladdr 02:00:00:00:00:02 dev scxdp0 nud permanent"
+            " && ip neigh replace 10.254.0.1 lladdr 02:00:00:00:00:01 dev scxdp1 nud permanent"
+            " && ip link set scxdp0 up && ip link set scxdp1 up") == 0;
+        if (!vethCreated) return;
+
+        ep1 = unwrap(Socket::Endpoint::Parse("[1-ff00:0:1,10.254.0.1]:0"));
+        ep2 = unwrap(Socket::Endpoint::Parse("[1-ff00:0:1,10.254.0.2]:0"));
+        if (sock1.bind(ep1) || sock2.bind(ep2)) return;
+        ep1 = sock1.getLocalEp();
+        ep2 = sock2.getLocalEp();
+
+        sock1.setRecvTimeout(1s);
+        sock2.setRecvTimeout(1s);
+        sock1.connect(ep2);
+        sock2.connect(ep1);
+    };
+
+    static void TearDownTestSuite()
+    {
+        sock1.close();
+        sock2.close();
+        if (vethCreated) std::system("ip link del scxdp0");
+    }
+
+    void SetUp() override
+    {
+        if (!enabled)
+            GTEST_SKIP() << "set SCION_TEST_XDP=1 to create a veth pair and run XDP tests";
+        if (!sock1.isOpen() || !sock2.isOpen())
+            GTEST_SKIP() << "cannot create veth pair or bind AF_XDP socket";
+    }
+
+    inline static bool enabled = false;
+    inline static bool vethCreated = false;
+    inline static Socket::Endpoint ep1, ep2;
+    inline static Socket sock1, sock2;
+};
+
+TEST_F(XdpSocketFixture, SendRecv)
+{
+    using namespace scion;
+
+    HeaderCache headers;
+    std::vector<std::byte> buffer(1024);
+    static const std::array<std::byte, 9> payload = {
+        1_b, 2_b, 3_b, 4_b, 5_b, 6_b, 7_b, 8_b, 9_b
+    };
+
+    auto nh = unwrap(toUnderlay<Socket::UnderlayEp>(ep2.getLocalEp()));
+    for (int i = 0; i < 3; ++i) {
+        auto sent = sock1.send(headers, RawPath(), nh, payload);
+        ASSERT_FALSE(isError(sent)) << getError(sent);
+    }
+    for (int i = 0; i < 3; ++i) {
+        Socket::Endpoint from;
+        RawPath path;
+        Socket::UnderlayEp ulSource;
+        auto recvd = sock2.recvFromVia(buffer, from, path, ulSource);
+        ASSERT_FALSE(isError(recvd)) << getError(recvd);
+        EXPECT_THAT(get(recvd), testing::ElementsAreArray(payload));
+        EXPECT_EQ(from, ep1);
+        EXPECT_EQ(generic::toGenericEp(ulSource), ep1.getLocalEp());
+    }
+
+    // Reply in the opposite direction
+    nh = unwrap(toUnderlay<Socket::UnderlayEp>(ep1.getLocalEp()));
+    auto sent = sock2.send(headers, RawPath(), nh, payload);
+    ASSERT_FALSE(isError(sent)) << getError(sent);
+    auto recvd = sock1.recv(buffer);
+    ASSERT_FALSE(isError(recvd)) << getError(recvd);
+    EXPECT_THAT(get(recvd), testing::ElementsAreArray(payload));
+}
+
+TEST_F(XdpSocketFixture, SendRecvBatch)
+{
+    using namespace scion;
+
+    static const std::array<std::byte, 8> payload = {
+        1_b, 2_b, 3_b, 4_b, 5_b, 6_b, 7_b, 8_b
+    };
+    constexpr std::size_t COUNT = 16;
+    auto nh = unwrap(toUnderlay<Socket::UnderlayEp>(ep2.getLocalEp()));
+    std::vector<HeaderCache<>> headers(COUNT);
+    std::vector<std::tuple<HeaderCache<>&, std::span<const std::byte>, Socket::UnderlayEp>> batch;
+    for (auto& h : headers) {
+        ASSERT_FALSE(isError(sock1.send(h, RawPath(), nh, payload)));
+        batch.emplace_back(h, payload, nh);
+    }
+    auto sent = sock1.sendBatch(batch);
+    ASSERT_FALSE(isError(sent)) << getError(sent);
+    EXPECT_EQ(get(sent), COUNT);
+
+    std::vector<std::byte> buffer(4 * 1024);
+    std::vector<ReceivedPacket<Socket::UnderlayEp>> packets(8);
+    std::size_t received = 0;
+    while (received < 2 * COUNT) {
+        auto recvd = sock2.recvBatch(buffer, packets);
+        ASSERT_FALSE(isError(recvd)) << getError(recvd);
+        for (const auto& pkt : *recvd) {
+            EXPECT_THAT(pkt.payload, testing::ElementsAreArray(payload));
+            EXPECT_EQ(pkt.from, ep1);
+        }
+        received += recvd->size();
+    }
+    EXPECT_EQ(received, 2 * COUNT);
+}
+
+// Test receive timeout and nonblocking receive.
+TEST_F(XdpSocketFixture, NoData)
+{
+    using namespace scion;
+
+    std::vector<std::byte> buffer(1024);
+    auto recvd = sock2.recv(buffer);
+    ASSERT_TRUE(isError(recvd));
+    EXPECT_EQ(getError(recvd), std::errc::resource_unavailable_try_again);
+
+    ASSERT_FALSE(sock2.setNonblocking(true));
+    recvd = sock2.recv(buffer);
+    ASSERT_TRUE(isError(recvd));
+    EXPECT_EQ(getError(recvd), std::errc::resource_unavailable_try_again);
+    ASSERT_FALSE(sock2.setNonblocking(false));
+}
+
+// Datagrams to another address on the interface must be left to the kernel,
+// even if they have the same port as the XDP socket.
+TEST_F(XdpSocketFixture, PassOtherAddress)
+{
+    using namespace scion;
+    using namespace std::chrono_literals;
+    using KernelSocket = bsd::UDPSocket<bsd::BSDSocket<bsd::IPEndpoint>>;
+
+    static const std::array<std::byte, 4> payload = {1_b, 2_b, 3_b, 4_b};
+
+    auto other = Socket::Endpoint(ep2.getIsdAsn(),
+        unwrap(generic::IPAddress::Parse("10.254.0.3")), ep2.getPort());
+    KernelSocket kernel;
+    ASSERT_FALSE(kernel.bind(other));
+    kernel.setRecvTimeout(1s);
+
+    HeaderCache headers;
+    auto nh = unwrap(toUnderlay<Socket::UnderlayEp>(other.getLocalEp()));
+    auto sent = sock1.sendTo(headers, other, RawPath(), nh, payload);
+    ASSERT_FALSE(isError(sent)) << getError(sent);
+
+    std::vector<std::byte> buffer(1024);
+    KernelSocket::Endpoint from;
+    auto recvd = kernel.recvFrom(buffer, from);
+    ASSERT_FALSE(isError(recvd)) << getError(recvd);
+    EXPECT_THAT(get(recvd), testing::ElementsAreArray(payload));
+    EXPECT_EQ(from, ep1);
+
+    // Nothing reaches the XDP socket
+    ASSERT_FALSE(sock2.setNonblocking(true));
+    auto none = sock2.recv(buffer);
+    ASSERT_FALSE(sock2.setNonblocking(false));
+    ASSERT_TRUE(isError(none));
+    EXPECT_EQ(getError(none), std::errc::resource_unavailable_try_again);
+}
@@ -23,7 +23,10 @@
 #include "gtest/gtest.h"
 #include "utilities.hpp"
 
+#include <algorithm>
 #include <array>
+#include <cstdint>
+#include <random>
 #include <vector>
 
 
@@ -45,3 +48,75 @@ TEST(Checksum, InternetChecksum)
     EXPECT_EQ(internetChecksum(d, 0), 0xe1e6);
     EXPECT_EQ(internetChecksum(d, 1), 0xe1e5);
 }
+
+TEST(Checksum, Implementations)
+{
+    using namespace scion::hdr::details;
+
+    // Reference implementation
+    auto reference = [] (std::span<const std::byte> data) {
+        std::uint64_t sum = 0;
+        for (std::size_t i = 0; i + 1 < data.size(); i += 2)
+            sum += (std::uint64_t(data[i]) << 8) | std::uint64_t(data[i + 1]);
+        while (sum >> 16) sum = (sum & 0xffff) + (sum >> 16);
+        return std::uint16_t(sum);
+    };
+
+    std::vector<std::byte> random(10000);
+    std::mt19937 rng(0);
+    std::uniform_int_distribution<int> dist(0, 255);
+    for (auto& b : random) b = std::byte(dist(rng));
+    std::vector<std::byte> ones(2 * 1024 * 1024 + 64, 0xff_b);
+
+    auto prev = getChecksumImpl();
+    for (auto impl : {ChecksumImpl::Scalar, ChecksumImpl::SSE2,
+        ChecksumImpl::AVX2, ChecksumImpl::NEON}) {
+        if (!isChecksumImplSupported(impl)) continue;
+        ASSERT_TRUE(setChecksumImpl(impl));
+        EXPECT_EQ(getChecksumImpl(), impl);
+        for (std::size_t offset = 0; offset < 4; ++offset) {
+            for (std::size_t len : {0, 2, 30, 64, 66, 94, 128, 1500, 9000, 9998}) {
+                auto data = std::span<const std::byte>(random).subspan(offset, len);
+                auto expected = reference(data);
+                EXPECT_EQ(onesComplementChecksum(data), expected)
+                    << "impl " << (int)impl << " offset " << offset << " length " << len;
+                EXPECT_EQ(scion::details::byteswapBE(onesComplementSumNative(data)), expected)
+                    << "impl " << (int)impl << " offset " << offset << " length " << len;
+            }
+        }
+        // Large enough to require widening the vector accumulators
+        EXPECT_EQ(onesComplementSumNative(ones), 0xffff);
+    }
+    setChecksumImpl(prev);
+}
+
+TEST(Checksum, Copy)
+{
+    using namespace scion::hdr::details;
+
+    std::vector<std::byte> random(10000);
+    std::mt19937 rng(1);
+    std::uniform_int_distribution<int> dist(0, 255);
+    for (auto& b : random) b = std::byte(dist(rng));
+
+    auto prev = getChecksumImpl();
+    for (auto impl : {ChecksumImpl::Scalar, ChecksumImpl::SSE2,
+        ChecksumImpl::AVX2, ChecksumImpl::NEON}) {
+        if (!isChecksumImplSupported(impl)) continue;
+        ASSERT_TRUE(setChecksumImpl(impl));
+        for (std::size_t srcOff = 0; srcOff < 3; ++srcOff) {
+            for (std::size_t dstOff = 0; dstOff < 3; ++dstOff) {
+                for (std::size_t len : {0, 1, 31, 63, 64, 65, 127, 1500, 9000, 9997}) {
+                    auto src = std::span<const std::byte>(random).subspan(srcOff, len);
+                    std::vector<std::byte> buf(len + dstOff, 0xaa_b);
+                    auto dst = std::span(buf).subspan(dstOff);
+                    EXPECT_EQ(internetChecksumCopy(dst, src, 7), internetChecksum(src, 7))
+                        << "impl " << (int)impl << " length " << len;
+                    EXPECT_TRUE(std::ranges::equal(dst, src))
+                        << "impl " << (int)impl << " length " << len;
+                }
+            }
+        }
+    }
+    setChecksumImpl(prev);
+}
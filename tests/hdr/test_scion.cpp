@@ -19,6 +19,7 @@
 // SOFTWARE.
 
 #include "scion/bit_stream.hpp"
+#include "scion/hdr/emit.hpp"
 #include "scion/hdr/scion.hpp"
 #include "scion/hdr/udp.hpp"
 
@@ -206,6 +207,51 @@ TEST(ScionHdr, Emit)
     EXPECT_EQ(buffer, expected) << printBufferDiff(buffer, expected);
 }
 
+TEST(ScionHdr, EmitFixed)
+{
+    using namespace scion;
+    using namespace scion::hdr;
+    using namespace scion::generic;
+
+    for (auto [dst, src] : {
+        std::pair{"1-ff00:0:1,10.0.0.1", "2-ff00:0:2,10.0.0.2"},
+        std::pair{"1-ff00:0:1,fd00::1", "2-ff00:0:2,fd00::2"},
+        std::pair{"1-ff00:0:1,10.0.0.1", "2-ff00:0:2,::ffff:10.0.0.2"},
+        std::pair{"1-ff00:0:1,fd00::1", "2-ff00:0:2,10.0.0.2"},
+    }) {
+        SCION sci;
+        sci.qos = 0xa5;
+        sci.fl = 0xfedcb;
+        sci.nh = ScionProto::UDP;
+        sci.ptype = PathType::SCION;
+        sci.plen = 0x1234;
+        sci.dst = unwrap(Address<IPAddress>::Parse(dst));
+        sci.src = unwrap(Address<IPAddress>::Parse(src));
+        sci.hlen = (std::uint8_t)(sci.size() / 4);
+
+        std::vector<std::byte> expected(sci.size());
+        WriteStream ws(expected);
+        StreamError err;
+        ASSERT_TRUE(sci.serialize(ws, err)) << err;
+
+        std::vector<std::byte> actual(sci.size(), 0xff_b);
+        EXPECT_EQ(emitSCION(actual, sci), sci.size());
+        EXPECT_EQ(actual, expected) << printBufferDiff(actual, expected);
+    }
+
+    UDP udp;
+    udp.sport = 0x0102;
+    udp.dport = 0xfffe;
+    udp.len = 42;
+    udp.chksum = 0xabcd;
+    std::array<std::byte, 8> expected, actual;
+    WriteStream ws(expected);
+    StreamError err;
+    ASSERT_TRUE(udp.serialize(ws, err)) << err;
+    emitUDP(actual, udp);
+    EXPECT_EQ(actual, expected) << printBufferDiff(actual, expected);
+}
+
 TEST(ScionHdr, Print)
 {
     using namespace scion::hdr;
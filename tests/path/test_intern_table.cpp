@@ -0,0 +1,131 @@
+// Copyright (c) 2024-2025 Lars-Christian Schulz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "scion/path/intern_table.hpp"
+#include "scion/path/raw.hpp"
+
+#include "gtest/gtest.h"
+#include "utilities.hpp"
+
+#include <array>
+#include <thread>
+#include <vector>
+
+
+class PathInternTableFixture : public testing::Test
+{
+protected:
+    static void SetUpTestSuite()
+    {
+        using namespace scion;
+        src = unwrap(IsdAsn::Parse("1-ff00:0:1"));
+        tgt = unwrap(IsdAsn::Parse("2-ff00:0:2"));
+        paths = loadPackets("path/data/raw_path.bin");
+    };
+
+    inline static scion::IsdAsn src, tgt;
+    inline static std::vector<std::vector<std::byte>> paths;
+};
+
+TEST_F(PathInternTableFixture, Intern)
+{
+    using namespace scion;
+    using hdr::PathType;
+
+    PathInternTable table(4);
+    std::vector<InternedPathPtr> interned;
+    for (const auto& bytes : paths) {
+        RawPathView view(src, tgt, PathType::SCION, bytes);
+        EXPECT_EQ(table.find(view), nullptr);
+        auto p = table.intern(view);
+        ASSERT_TRUE(p);
+        EXPECT_EQ(view, *p);
+        EXPECT_EQ(p->digest(), view.digest());
+        interned.push_back(p);
+    }
+    EXPECT_EQ(table.size(), paths.size());
+
+    // Interning the same path again returns the same object
+    for (std::size_t i = 0; i < paths.size(); ++i) {
+        RawPathView view(src, tgt, PathType::SCION, paths[i]);
+        EXPECT_EQ(table.intern(view), interned[i]);
+        EXPECT_EQ(table.find(view), interned[i]);
+    }
+
+    // Same digest, but different hop field MAC or ASes
+    auto updated = paths[0];
+    updated.back() ^= 0xff_b;
+    RawPathView view(src, tgt, PathType::SCION, paths[0]);
+    RawPathView updatedView(src, tgt, PathType::SCION, updated);
+    RawPathView otherAS(src, src, PathType::SCION, paths[0]);
+    ASSERT_EQ(view.digest(), updatedView.digest());
+    auto p = table.intern(updatedView);
+    EXPECT_NE(p, interned[0]);
+    EXPECT_EQ(updatedView, *p);
+    EXPECT_NE(table.intern(otherAS), interned[0]);
+    EXPECT_EQ(table.size(), paths.size() + 2);
+
+    // Only paths referenced outside of the table are kept
+    interned.resize(1);
+    p.reset();
+    EXPECT_EQ(table.collect(), paths.size() + 1);
+    EXPECT_EQ(table.size(), 1);
+    EXPECT_EQ(table.find(view), interned[0]);
+
+    table.clear();
+    EXPECT_EQ(table.size(), 0);
+    EXPECT_EQ(view, *interned[0]);
+}
+
+TEST_F(PathInternTableFixture, Concurrent)
+{
+    using namespace scion;
+    using hdr::PathType;
+
+    static constexpr int THREADS = 4;
+    static constexpr int ITERATIONS = 1000;
+
+    PathInternTable table(2);
+    std::array<std::vector<InternedPathPtr>, THREADS> results;
+    {
+        std::vector<std::jthread> threads;
+        for (int t = 0; t < THREADS; ++t) {
+            threads.emplace_back([&, t] () {
+                for (int i = 0; i < ITERATIONS; ++i) {
+                    const auto& bytes = paths[(i + t) % paths.size()];
+                    RawPathView view(src, tgt, PathType::SCION, bytes);
+                    auto p = table.intern(view);
+                    if (i < (int)paths.size()) results[t].push_back(p);
+                    if (i % 100 == 0) table.collect();
+                }
+            });
+        }
+    }
+
+    // All threads must have received the same object for the same path
+    for (int t = 0; t < THREADS; ++t) {
+        for (std::size_t i = 0; i < paths.size(); ++i) {
+            auto& bytes = paths[(i + t) % paths.size()];
+            auto p = table.find(RawPathView(src, tgt, PathType::SCION, bytes));
+            EXPECT_EQ(results[t][i], p);
+        }
+    }
+    EXPECT_EQ(table.size(), paths.size());
+}
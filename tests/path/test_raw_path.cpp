@@ -160,3 +160,36 @@ TEST_F(RawPathFixture, Format)
     RawPath rp(src, tgt, hdr::PathType::SCION, paths.at(0));
     EXPECT_EQ(std::format("{}", rp), "1-ff00:0:1 4>3 2>1 5>6 7>8 9>10 11>12 2-ff00:0:2");
 }
+
+TEST_F(RawPathFixture, View)
+{
+    using namespace scion;
+
+    const auto& fwd = paths.at(0);
+    const auto& rev = paths.at(1);
+    RawPath rp(src, tgt, hdr::PathType::SCION, fwd);
+    RawPathView view(src, tgt, hdr::PathType::SCION, fwd);
+
+    EXPECT_EQ(view.encoded().data(), fwd.data());
+    EXPECT_EQ(view, RawPathView(rp));
+    EXPECT_EQ(view, rp);
+    EXPECT_EQ(RawPath(view), rp);
+    EXPECT_EQ(view.digest(), rp.digest());
+    EXPECT_TRUE(std::ranges::equal(view.hops(), rp.hops()));
+    EXPECT_EQ(std::format("{}", view), std::format("{}", rp));
+
+    std::vector<std::byte> buf(fwd.size() - 1);
+    EXPECT_EQ(view.reverseInto(buf), ErrorCode::BufferTooSmall);
+    EXPECT_EQ(view, rp);
+
+    buf.resize(RawPath::MAX_SIZE);
+    auto d1 = view.digest();
+    EXPECT_FALSE(view.reverseInto(buf));
+    EXPECT_EQ(view.encoded().data(), buf.data());
+    EXPECT_EQ(view.firstAS(), tgt);
+    EXPECT_EQ(view.lastAS(), src);
+    EXPECT_NE(view.digest(), d1);
+    EXPECT_TRUE(std::ranges::equal(view.encoded(), rev))
+        << printBufferDiff(view.encoded(), rev);
+    EXPECT_TRUE(std::ranges::equal(rp.encoded(), fwd));
+}
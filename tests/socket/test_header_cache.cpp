@@ -131,6 +131,38 @@ TEST_F(HeaderCacheFixture, UpdatePayload)
     EXPECT_TRUE(std::ranges::equal(hdr.get(), expected)) << printBufferDiff(hdr.get(), expected);
 }
 
+TEST_F(HeaderCacheFixture, UpdatePayloadCopy)
+{
+    using namespace scion;
+    using namespace scion::generic;
+
+    RawPath rp(src, tgt, hdr::PathType::SCION, pathBytes);
+    Endpoint<IPEndpoint> from(src, unwrap(IPEndpoint::Parse("10.0.0.1:3000")));
+    Endpoint<IPEndpoint> to(tgt, unwrap(IPEndpoint::Parse("[fd00::1]:8000")));
+
+    HeaderCache hdr;
+    hdr::UDP udp;
+    std::array<std::byte, 16> buf = {};
+    auto err = hdr.build(64, to, from, rp, ext::NoExtensions, udp, payload, buf);
+    ASSERT_FALSE(err);
+    auto expected = truncate(packets.at(0), -8);
+    EXPECT_TRUE(std::ranges::equal(hdr.get(), expected)) << printBufferDiff(hdr.get(), expected);
+    EXPECT_TRUE(std::ranges::equal(std::span(buf).first(payload.size()), payload));
+
+    static std::array<std::byte, 16> newPayload = {
+        0xff_b, 0xff_b, 0xff_b, 0xff_b, 0xff_b, 0xff_b, 0xff_b, 0xff_b,
+        0x07_b, 0x06_b, 0x05_b, 0x04_b, 0x03_b, 0x02_b, 0x01_b, 0x00_b,
+    };
+    err = hdr.updatePayload(udp, newPayload, std::span(buf).first(8));
+    EXPECT_EQ(err, ErrorCode::BufferTooSmall);
+    err = hdr.updatePayload(udp, newPayload, buf);
+    ASSERT_FALSE(err);
+
+    expected = truncate(packets.at(1), -16);
+    EXPECT_TRUE(std::ranges::equal(hdr.get(), expected)) << printBufferDiff(hdr.get(), expected);
+    EXPECT_TRUE(std::ranges::equal(buf, newPayload));
+}
+
 TEST_F(HeaderCacheFixture, BuildSCMP)
 {
     using namespace scion;
@@ -0,0 +1,164 @@
+// Copyright (c) 2024-2025 Lars-Christian Schulz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "scion/hdr/udp.hpp"
+#include "scion/path/raw.hpp"
+#include "scion/socket/header_cache.hpp"
+#include "scion/socket/header_cache_pool.hpp"
+#include "scion/socket/packager.hpp"
+
+#include "gtest/gtest.h"
+#include "utilities.hpp"
+
+#include <array>
+#include <ranges>
+#include <vector>
+
+
+class HeaderCachePoolFixture : public testing::Test
+{
+protected:
+    using Endpoint = scion::Endpoint<scion::generic::IPEndpoint>;
+
+    static void SetUpTestSuite()
+    {
+        using namespace scion;
+        local = unwrap(Endpoint::Parse("[1-ff00:0:1,10.0.0.1]:3000"));
+        pathBytes = loadPackets("socket/data/raw_path.bin").at(0);
+    };
+
+    // Build headers without the pool for comparison.
+    static std::vector<std::byte> expectedHeaders(scion::ScionPackager& packager,
+        const Endpoint& to, const scion::RawPath& path, std::span<const std::byte> payload)
+    {
+        using namespace scion;
+        HeaderCache headers;
+        auto ec = packager.pack(headers, &to, path, ext::NoExtensions, hdr::UDP{}, payload);
+        EXPECT_FALSE(ec);
+        return std::vector<std::byte>(headers.get().begin(), headers.get().end());
+    }
+
+    inline static Endpoint local;
+    inline static std::vector<std::byte> pathBytes;
+};
+
+TEST_F(HeaderCachePoolFixture, LRU)
+{
+    using namespace scion;
+
+    ScionPackager packager;
+    ASSERT_FALSE(packager.setLocalEp(local));
+    RawPath rp(local.getIsdAsn(), unwrap(IsdAsn::Parse("2-ff00:0:2")),
+        hdr::PathType::SCION, pathBytes);
+    std::array<Endpoint, 3> remotes = {
+        unwrap(Endpoint::Parse("[2-ff00:0:2,fd00::1]:8000")),
+        unwrap(Endpoint::Parse("[2-ff00:0:2,fd00::2]:8000")),
+        unwrap(Endpoint::Parse("[2-ff00:0:2,fd00::2]:8001")),
+    };
+    std::array<std::byte, 16> payload = {};
+
+    HeaderCachePool pool(2);
+    EXPECT_EQ(pool.capacity(), 2);
+    auto send = [&] (std::size_t remote, std::size_t len) {
+        for (std::size_t i = 0; i < len; ++i) payload[i] = std::byte(remote + i);
+        auto data = std::span<const std::byte>(payload).first(len);
+        auto headers = pool.pack(packager, remotes[remote], rp, hdr::UDP{}, data);
+        ASSERT_FALSE(isError(headers)) << getError(headers);
+        auto expected = expectedHeaders(packager, remotes[remote], rp, data);
+        EXPECT_TRUE(std::ranges::equal(get(headers), expected))
+            << printBufferDiff(get(headers), expected);
+    };
+
+    send(0, 8);
+    send(0, 16);
+    send(1, 4);
+    send(0, 2);
+    EXPECT_EQ(pool.getStats().hits, 2);
+    EXPECT_EQ(pool.getStats().misses, 2);
+    EXPECT_EQ(pool.size(), 2);
+
+    // Evicts remote 1
+    send(2, 10);
+    EXPECT_EQ(pool.getStats().evictions, 1);
+    EXPECT_TRUE(pool.contains(remotes[0], rp));
+    EXPECT_FALSE(pool.contains(remotes[1], rp));
+    EXPECT_TRUE(pool.contains(remotes[2], rp));
+
+    // Evicts remote 0
+    send(1, 16);
+    send(2, 16);
+    EXPECT_EQ(pool.getStats().hits, 3);
+    EXPECT_EQ(pool.getStats().misses, 4);
+    EXPECT_EQ(pool.getStats().evictions, 2);
+    EXPECT_FALSE(pool.contains(remotes[0], rp));
+
+    pool.erase(remotes[1], rp);
+    EXPECT_EQ(pool.size(), 1);
+    pool.clear();
+    EXPECT_EQ(pool.size(), 0);
+    pool.resetStats();
+    EXPECT_EQ(pool.getStats().misses, 0);
+}
+
+TEST_F(HeaderCachePoolFixture, UpdatedPath)
+{
+    using namespace scion;
+
+    ScionPackager packager;
+    ASSERT_FALSE(packager.setLocalEp(local));
+    auto remote = unwrap(Endpoint::Parse("[2-ff00:0:2,fd00::1]:8000"));
+    RawPath rp(local.getIsdAsn(), remote.getIsdAsn(), hdr::PathType::SCION, pathBytes);
+    std::array<std::byte, 8> payload = {};
+
+    // Same interfaces, but different hop field MAC
+    auto updatedBytes = pathBytes;
+    updatedBytes.back() ^= 0xff_b;
+    RawPath updated(local.getIsdAsn(), remote.getIsdAsn(), hdr::PathType::SCION, updatedBytes);
+    ASSERT_EQ(rp.digest(), updated.digest());
+
+    HeaderCachePool pool(4);
+    ASSERT_FALSE(isError(pool.pack(packager, remote, rp, hdr::UDP{}, payload)));
+    auto headers = pool.pack(packager, remote, updated, hdr::UDP{}, payload);
+    ASSERT_FALSE(isError(headers));
+    EXPECT_EQ(pool.getStats().hits, 0);
+    EXPECT_EQ(pool.getStats().misses, 2);
+    EXPECT_EQ(pool.size(), 1);
+
+    auto expected = expectedHeaders(packager, remote, updated, payload);
+    EXPECT_TRUE(std::ranges::equal(get(headers), expected))
+        << printBufferDiff(get(headers), expected);
+}
+
+TEST_F(HeaderCachePoolFixture, Error)
+{
+    using namespace scion;
+
+    ScionPackager packager;
+    auto remote = unwrap(Endpoint::Parse("[2-ff00:0:2,fd00::1]:8000"));
+    RawPath rp(local.getIsdAsn(), remote.getIsdAsn(), hdr::PathType::SCION, pathBytes);
+    std::array<std::byte, 8> payload = {};
+
+    // Local address not set
+    HeaderCachePool pool(4);
+    auto headers = pool.pack(packager, remote, rp, hdr::UDP{}, payload);
+    ASSERT_TRUE(isError(headers));
+    EXPECT_EQ(getError(headers), ErrorCode::NoLocalHostAddr);
+    EXPECT_EQ(pool.size(), 0);
+}
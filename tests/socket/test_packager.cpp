@@ -29,6 +29,7 @@
 #include "utilities.hpp"
 
 #include <array>
+#include <format>
 #include <ranges>
 #include <vector>
 
@@ -208,6 +209,119 @@ TEST_F(PacketSocketFixture, PrepareSendUDPUpdate)
     EXPECT_TRUE(std::ranges::equal(hdr.get(), expected)) << printBufferDiff(hdr.get(), expected);
 }
 
+TEST_F(PacketSocketFixture, PackInPlace)
+{
+    using namespace scion;
+    using namespace scion::generic;
+
+    ScionPackager packager;
+    Endpoint<IPEndpoint> local(src, 3000);
+    Endpoint<IPEndpoint> remote(dst, 8000);
+    packager.setLocalEp(local);
+    packager.setTrafficClass(64);
+
+    HeaderCache hdr;
+    RawPath rp(src.getIsdAsn(), dst.getIsdAsn(), hdr::PathType::SCION, pathBytes);
+    std::vector<std::byte> buf(256);
+    constexpr std::size_t headroom = 200;
+    std::ranges::copy(payload, buf.begin() + headroom);
+    auto packet = packager.packInPlace(hdr, &remote, rp, ext::NoExtensions, hdr::UDP{},
+        std::span(buf).first(headroom + payload.size()), headroom);
+    ASSERT_FALSE(isError(packet)) << getError(packet);
+    EXPECT_EQ(get(packet).data() + get(packet).size(), buf.data() + headroom + payload.size());
+    EXPECT_TRUE(std::ranges::equal(get(packet), packets.at(0)))
+        << printBufferDiff(get(packet), packets.at(0));
+
+    // Update payload
+    static std::array<std::byte, 16> newPayload = {
+        0xff_b, 0xff_b, 0xff_b, 0xff_b, 0xff_b, 0xff_b, 0xff_b, 0xff_b,
+        0x07_b, 0x06_b, 0x05_b, 0x04_b, 0x03_b, 0x02_b, 0x01_b, 0x00_b,
+    };
+    std::ranges::copy(newPayload, buf.begin() + headroom);
+    packet = packager.packInPlace(hdr, hdr::UDP{3000, 8000},
+        std::span(buf).first(headroom + newPayload.size()), headroom);
+    ASSERT_FALSE(isError(packet)) << getError(packet);
+    EXPECT_TRUE(std::ranges::equal(get(packet), packets.at(1)))
+        << printBufferDiff(get(packet), packets.at(1));
+
+    // Insufficient headroom
+    packet = packager.packInPlace(hdr, hdr::UDP{3000, 8000}, buf, 16);
+    ASSERT_TRUE(isError(packet));
+    EXPECT_EQ(getError(packet), ErrorCode::BufferTooSmall);
+    packet = packager.packInPlace(hdr, hdr::UDP{3000, 8000}, buf, buf.size() + 1);
+    ASSERT_TRUE(isError(packet));
+    EXPECT_EQ(getError(packet), ErrorCode::InvalidArgument);
+}
+
+TEST_F(PacketSocketFixture, PackReply)
+{
+    using namespace scion;
+    using namespace scion::generic;
+
+    ScionPackager server, client;
+    Endpoint<IPEndpoint> clientEp(src, 3000);
+    Endpoint<IPEndpoint> serverEp(dst, 8000);
+    server.setLocalEp(serverEp);
+    server.setTrafficClass(64);
+    client.setLocalEp(clientEp);
+    client.setTrafficClass(64);
+    RawPath reversed(src.getIsdAsn(), dst.getIsdAsn(), hdr::PathType::SCION, pathBytes);
+    ASSERT_FALSE(reversed.reverseInPlace());
+
+    // Echo in place
+    auto buf = packets.at(0);
+    auto reply = server.packReply(buf, payload.size());
+    ASSERT_FALSE(isError(reply)) << getError(reply);
+    EXPECT_EQ(get(reply).data(), buf.data());
+
+    // Same as a reply built from scratch except for the flow label
+    HeaderCache headers;
+    ASSERT_EQ(server.pack(headers, &clientEp, reversed, ext::NoExtensions, hdr::UDP{}, payload),
+        ErrorCode::Ok);
+    auto expected = headers.get();
+    ASSERT_EQ(get(reply).size(), expected.size() + payload.size());
+    EXPECT_TRUE(std::ranges::equal(get(reply).subspan(4, expected.size() - 4), expected.subspan(4)))
+        << printBufferDiff(get(reply).first(expected.size()), expected);
+
+    ScionPackager::Endpoint from;
+    RawPath path;
+    auto recv = client.unpack<hdr::UDP>(get(reply), dst.getHost(),
+        ext::NoExtensions, ext::NoExtensions, &from, &path);
+    ASSERT_FALSE(isError(recv)) << getError(recv);
+    EXPECT_EQ(from, serverEp);
+    EXPECT_EQ(path, RawPath(dst.getIsdAsn(), src.getIsdAsn(), hdr::PathType::SCION, reversed.encoded()));
+    EXPECT_TRUE(std::ranges::equal(get(recv), payload)) << printBufferDiff(get(recv), payload);
+
+    // Copy with a different payload
+    std::array<std::byte, 20> payload2 = {};
+    for (std::size_t i = 0; i < payload2.size(); ++i) payload2[i] = std::byte(i);
+    std::vector<std::byte> out(packets.at(0).size() + payload2.size());
+    reply = server.packReply(packets.at(0), payload2, out);
+    ASSERT_FALSE(isError(reply)) << getError(reply);
+    recv = client.unpack<hdr::UDP>(get(reply), dst.getHost(),
+        ext::NoExtensions, ext::NoExtensions, &from, nullptr);
+    ASSERT_FALSE(isError(recv)) << getError(recv);
+    EXPECT_EQ(from, serverEp);
+    EXPECT_TRUE(std::ranges::equal(get(recv), payload2)) << printBufferDiff(get(recv), payload2);
+
+    // Errors
+    reply = server.packReply(packets.at(0), payload2, std::span(out).first(packets.at(0).size()));
+    ASSERT_TRUE(isError(reply));
+    EXPECT_EQ(getError(reply), ErrorCode::BufferTooSmall);
+    buf = packets.at(0);
+    reply = server.packReply(std::span(buf).first(40), 0);
+    ASSERT_TRUE(isError(reply));
+    EXPECT_EQ(getError(reply), ErrorCode::InvalidPacket);
+    buf = packets.at(2);
+    reply = server.packReply(buf, 0);
+    ASSERT_TRUE(isError(reply));
+    EXPECT_EQ(getError(reply), ErrorCode::NotImplemented);
+    buf = packets.at(4);
+    reply = server.packReply(buf, 0);
+    ASSERT_TRUE(isError(reply));
+    EXPECT_EQ(getError(reply), ErrorCode::NotImplemented);
+}
+
 TEST_F(PacketSocketFixture, ReceiveUDP)
 {
     using namespace scion;
@@ -273,6 +387,51 @@ TEST_F(PacketSocketFixture, ReceiveUDPConnected)
     EXPECT_EQ(getError(recv), ErrorCode::SrcAddrMismatch);
 }
 
+// Packets not addressed to the socket must be rejected based on the address
+// header alone.
+TEST_F(PacketSocketFixture, ReceiveEarlyReject)
+{
+    using namespace scion;
+    using namespace scion::generic;
+
+    ScionPackager packager;
+    Endpoint<IPEndpoint> local(dst, 8000);
+    Endpoint<IPEndpoint> remote(src, 3000);
+    auto ulSource = remote.getHost();
+
+    // Only the common and address header remain
+    auto truncated = std::span<const std::byte>(packets.at(0)).first(48);
+
+    packager.setLocalEp(local);
+    auto recv = packager.unpack<hdr::UDP>(
+        truncated, ulSource, ext::NoExtensions, ext::NoExtensions, nullptr, nullptr);
+    ASSERT_TRUE(isError(recv));
+    EXPECT_EQ(getError(recv), ErrorCode::InvalidPacket);
+
+    packager.setLocalEp(remote);
+    recv = packager.unpack<hdr::UDP>(
+        truncated, ulSource, ext::NoExtensions, ext::NoExtensions, nullptr, nullptr);
+    ASSERT_TRUE(isError(recv));
+    EXPECT_EQ(getError(recv), ErrorCode::DstAddrMismatch);
+
+    packager.setLocalEp(local);
+    packager.setRemoteEp(local);
+    recv = packager.unpack<hdr::UDP>(
+        truncated, ulSource, ext::NoExtensions, ext::NoExtensions, nullptr, nullptr);
+    ASSERT_TRUE(isError(recv));
+    EXPECT_EQ(getError(recv), ErrorCode::SrcAddrMismatch);
+
+    // SCMP messages are not decoded or passed to the handler
+    bool called = false;
+    recv = packager.unpack<hdr::UDP>(
+        packets.at(2), ulSource, ext::NoExtensions, ext::NoExtensions, nullptr, nullptr,
+        [&](const Address<IPAddress>&, const RawPath&, const hdr::ScmpMessage&,
+            std::span<const std::byte>) { called = true; });
+    ASSERT_TRUE(isError(recv));
+    EXPECT_EQ(getError(recv), ErrorCode::SrcAddrMismatch);
+    EXPECT_FALSE(called);
+}
+
 // Test receiveing a packet from a host in the same AS
 TEST_F(PacketSocketFixture, ReceiveUDPLocal)
 {
@@ -305,6 +464,44 @@ TEST_F(PacketSocketFixture, ReceiveUDPLocal)
     EXPECT_TRUE(std::ranges::equal(get(recv), payload)) << printBufferDiff(get(recv), payload);
 }
 
+// Packets received on wildcard sockets are only accepted if the underlay
+// destination address is known.
+TEST_F(PacketSocketFixture, ReceiveUDPWildcard)
+{
+    using namespace scion;
+    using namespace scion::generic;
+
+    ScionPackager packager;
+    ASSERT_FALSE(packager.setLocalEp(Endpoint<IPEndpoint>(dst, 8000)));
+    packager.setWildcardLocal(true);
+
+    auto ulSource = src.getHost();
+    auto recv = packager.unpack<hdr::UDP>(
+        packets.at(0), ulSource, ext::NoExtensions, ext::NoExtensions, nullptr, nullptr);
+    ASSERT_TRUE(isError(recv));
+    EXPECT_EQ(getError(recv), ErrorCode::DstAddrMismatch);
+
+    auto ulDest = unwrap(IPAddress::Parse("fd00::2"));
+    recv = packager.unpack<hdr::UDP>(packets.at(0), ulSource, &ulDest,
+        ext::NoExtensions, ext::NoExtensions, nullptr, nullptr);
+    ASSERT_TRUE(isError(recv));
+    EXPECT_EQ(getError(recv), ErrorCode::DstAddrMismatch);
+
+    ulDest = dst.getHost();
+    recv = packager.unpack<hdr::UDP>(packets.at(0), ulSource, &ulDest,
+        ext::NoExtensions, ext::NoExtensions, nullptr, nullptr);
+    ASSERT_FALSE(isError(recv)) << getError(recv);
+
+    std::array<std::span<const std::byte>, 1> bufs = {packets.at(0)};
+    std::array<IPAddress, 1> ulSources = {ulSource};
+    std::array<std::span<const std::byte>, 1> payloads;
+    std::array<std::error_code, 1> errors;
+    auto valid = packager.unpackBatch<hdr::UDP>(bufs, ulSources, {},
+        {.payloads = payloads, .errors = errors});
+    ASSERT_TRUE(isError(valid));
+    EXPECT_EQ(getError(valid), ErrorCode::InvalidArgument);
+}
+
 #ifndef SCION_DISABLE_CHECKSUM
 TEST_F(PacketSocketFixture, ReceiveUDPChksumError)
 {
@@ -326,6 +523,268 @@ TEST_F(PacketSocketFixture, ReceiveUDPChksumError)
 }
 #endif
 
+TEST_F(PacketSocketFixture, ReceiveUDPCopy)
+{
+    using namespace scion;
+    using namespace scion::generic;
+
+    ScionPackager packager;
+    Endpoint<IPEndpoint> local(dst, 8000);
+    Endpoint<IPEndpoint> remote(src, 3000);
+    packager.setLocalEp(local);
+
+    auto ulSource = remote.getHost();
+    ScionPackager::Endpoint from;
+    std::array<std::byte, 4> small;
+    auto recv = packager.unpackInto<hdr::UDP>(packets.at(0), ulSource, nullptr,
+        ext::NoExtensions, ext::NoExtensions, &from, nullptr, small);
+    ASSERT_TRUE(isError(recv));
+    EXPECT_EQ(getError(recv), ErrorCode::BufferTooSmall);
+
+    std::array<std::byte, 64> buf;
+    recv = packager.unpackInto<hdr::UDP>(packets.at(0), ulSource, nullptr,
+        ext::NoExtensions, ext::NoExtensions, &from, nullptr, buf);
+    ASSERT_FALSE(isError(recv)) << getError(recv);
+    EXPECT_EQ(from, remote);
+    EXPECT_EQ(get(recv).data(), buf.data());
+    EXPECT_TRUE(std::ranges::equal(get(recv), payload)) << printBufferDiff(get(recv), payload);
+
+#ifndef SCION_DISABLE_CHECKSUM
+    recv = packager.unpackInto<hdr::UDP>(packets.at(5), ulSource, nullptr,
+        ext::NoExtensions, ext::NoExtensions, nullptr, nullptr, buf);
+    ASSERT_TRUE(isError(recv));
+    EXPECT_EQ(getError(recv), ErrorCode::ChecksumError);
+#endif
+}
+
+TEST_F(PacketSocketFixture, ChecksumPolicy)
+{
+    using namespace scion;
+    using namespace scion::generic;
+
+    ScionPackager packager;
+    Endpoint<IPEndpoint> local(dst, 8000);
+    Endpoint<IPEndpoint> remote(src, 3000);
+    packager.setLocalEp(local);
+    auto ulSource = remote.getHost();
+    const auto& good = packets.at(0);
+    const auto& bad = packets.at(5);
+    auto unpack = [&] (std::span<const std::byte> buf) {
+        return packager.unpack<hdr::UDP>(
+            buf, ulSource, ext::NoExtensions, ext::NoExtensions, nullptr, nullptr);
+    };
+
+    EXPECT_EQ(packager.setChecksumPolicy(ChecksumPolicy::Sample, 0), ErrorCode::InvalidArgument);
+
+    // Skip
+    ASSERT_FALSE(packager.setChecksumPolicy(ChecksumPolicy::Skip));
+    EXPECT_EQ(packager.getChecksumPolicy(), ChecksumPolicy::Skip);
+    EXPECT_FALSE(isError(unpack(bad)));
+    EXPECT_FALSE(packager.getDeferredChecksum().isPending());
+
+    // Verify
+    ASSERT_FALSE(packager.setChecksumPolicy(ChecksumPolicy::Verify));
+    auto recv = unpack(bad);
+    ASSERT_TRUE(isError(recv));
+    EXPECT_EQ(getError(recv), ErrorCode::ChecksumError);
+
+    // Sample every third packet
+    ASSERT_FALSE(packager.setChecksumPolicy(ChecksumPolicy::Sample, 3));
+    EXPECT_FALSE(isError(unpack(bad)));
+    EXPECT_FALSE(isError(unpack(bad)));
+    recv = unpack(bad);
+    ASSERT_TRUE(isError(recv));
+    EXPECT_EQ(getError(recv), ErrorCode::ChecksumError);
+    EXPECT_FALSE(isError(unpack(bad)));
+
+    // Defer
+    ASSERT_FALSE(packager.setChecksumPolicy(ChecksumPolicy::Defer));
+    recv = unpack(bad);
+    ASSERT_FALSE(isError(recv));
+    EXPECT_TRUE(packager.getDeferredChecksum().isPending());
+    EXPECT_FALSE(packager.getDeferredChecksum().verify(get(recv)));
+    recv = unpack(good);
+    ASSERT_FALSE(isError(recv));
+    EXPECT_TRUE(packager.getDeferredChecksum().isPending());
+    EXPECT_TRUE(packager.getDeferredChecksum().verify(get(recv)));
+
+    // Deferred and copied
+    std::array<std::byte, 64> buf;
+    auto copied = packager.unpackInto<hdr::UDP>(bad, ulSource, nullptr,
+        ext::NoExtensions, ext::NoExtensions, nullptr, nullptr, buf);
+    ASSERT_FALSE(isError(copied));
+    EXPECT_FALSE(packager.getDeferredChecksum().verify(get(copied)));
+}
+
+TEST_F(PacketSocketFixture, UnpackBatch)
+{
+    using namespace scion;
+    using namespace scion::generic;
+
+    ScionPackager packager;
+    Endpoint<IPEndpoint> local(dst, 8000);
+    packager.setLocalEp(local);
+    auto ulSource = src.getHost();
+
+    auto wrongDst = packets.at(0);
+    wrongDst[12] ^= 0x01_b;
+    auto truncated = std::span<const std::byte>(packets.at(0)).first(48);
+
+    // Larger than the number of packets processed per stage
+    constexpr std::size_t N = 21;
+    std::vector<std::span<const std::byte>> bufs;
+    for (std::size_t i = 0; i < N; ++i) {
+        switch (i % 5) {
+        case 0: bufs.push_back(packets.at(0)); break;
+        case 1: bufs.push_back(packets.at(5)); break;
+        case 2: bufs.push_back(packets.at(2)); break;
+        case 3: bufs.push_back(wrongDst); break;
+        case 4: bufs.push_back(truncated); break;
+        }
+    }
+    std::vector<IPAddress> ulSources(N, ulSource);
+
+    std::array<std::span<const std::byte>, N> payloads;
+    std::array<std::error_code, N> errors;
+    std::array<ScionPackager::Endpoint, N> from;
+    std::vector<RawPathView> paths(N);
+    int scmpCount = 0;
+    auto scmp = [&] (const Address<IPAddress>&, const RawPath&,
+        const hdr::ScmpMessage&, std::span<const std::byte>) { ++scmpCount; };
+
+    auto valid = packager.unpackBatch<hdr::UDP>(bufs, ulSources, {},
+        {.payloads = payloads, .errors = errors, .from = from, .paths = paths}, scmp);
+    ASSERT_FALSE(isError(valid)) << getError(valid);
+    EXPECT_EQ(get(valid), 5);
+    EXPECT_EQ(scmpCount, 4);
+
+    // Results match unpacking the packets one by one
+    for (std::size_t i = 0; i < N; ++i) {
+        ScionPackager::Endpoint expFrom;
+        RawPath expPath;
+        auto exp = packager.unpack<hdr::UDP>(bufs[i], ulSource,
+            ext::NoExtensions, ext::NoExtensions, &expFrom, &expPath);
+        if (isError(exp)) {
+            EXPECT_EQ(errors[i], getError(exp)) << i;
+            EXPECT_TRUE(payloads[i].empty());
+        } else {
+            EXPECT_EQ(errors[i], ErrorCode::Ok) << i;
+            EXPECT_EQ(payloads[i].data(), get(exp).data());
+            EXPECT_EQ(payloads[i].size(), get(exp).size());
+            EXPECT_EQ(from[i], expFrom);
+            EXPECT_EQ(paths[i], expPath);
+        }
+    }
+
+    // Optional outputs are omitted and output storage is checked
+    valid = packager.unpackBatch<hdr::UDP>(bufs, ulSources, {},
+        {.payloads = payloads, .errors = errors});
+    ASSERT_FALSE(isError(valid)) << getError(valid);
+    EXPECT_EQ(get(valid), 5);
+    valid = packager.unpackBatch<hdr::UDP>(bufs, ulSources, {},
+        {.payloads = payloads, .errors = std::span(errors).first(N - 1)});
+    ASSERT_TRUE(isError(valid));
+    EXPECT_EQ(getError(valid), ErrorCode::InvalidArgument);
+}
+
+// Compare unpackBatch() to unpack() for all checksum policies on sockets with
+// specific and wildcard local addresses.
+TEST_F(PacketSocketFixture, UnpackBatchEquivalence)
+{
+    using namespace scion;
+    using namespace scion::generic;
+
+    auto ulSource = src.getHost();
+    auto otherHost = unwrap(IPAddress::Parse("fd00::2"));
+    auto badChecksum = packets.at(0);
+    badChecksum.back() ^= 0xff_b;
+    auto wrongDst = packets.at(0);
+    wrongDst[12] ^= 0x01_b;
+
+    constexpr std::size_t N = 40;
+    std::vector<std::span<const std::byte>> bufs;
+    std::vector<IPAddress> ulSources(N, ulSource);
+    std::vector<IPAddress> ulDests;
+    for (std::size_t i = 0; i < N; ++i) {
+        switch (i % 6) {
+        case 0: bufs.push_back(packets.at(0)); break;
+        case 1: bufs.push_back(badChecksum); break;
+        case 2: bufs.push_back(packets.at(2)); break;
+        case 3: bufs.push_back(packets.at(5)); break;
+        case 4: bufs.push_back(wrongDst); break;
+        case 5: bufs.push_back(std::span(packets.at(0)).first(48)); break;
+        }
+        // Some packets were delivered to a different local address
+        ulDests.push_back(i % 7 == 3 ? otherHost : dst.getHost());
+    }
+
+    struct Policy { ChecksumPolicy policy; std::uint32_t interval; };
+    static const std::array<Policy, 4> policies = {
+        Policy{ChecksumPolicy::Verify, 1},
+        Policy{ChecksumPolicy::Skip, 1},
+        Policy{ChecksumPolicy::Sample, 3},
+        Policy{ChecksumPolicy::Defer, 1},
+    };
+    for (bool wildcard : {false, true}) {
+        for (auto [policy, interval] : policies) {
+            SCOPED_TRACE(std::format("wildcard = {}, policy = {}", wildcard, (int)policy));
+            ScionPackager batch, single;
+            for (auto packager : {&batch, &single}) {
+                ASSERT_FALSE(packager->setLocalEp(Endpoint<IPEndpoint>(dst, 8000)));
+                packager->setWildcardLocal(wildcard);
+                ASSERT_FALSE(packager->setChecksumPolicy(policy, interval));
+            }
+            auto dests = wildcard ? std::span<const IPAddress>(ulDests) : std::span<const IPAddress>();
+
+            std::array<std::span<const std::byte>, N> payloads;
+            std::array<std::error_code, N> errors;
+            std::array<ScionPackager::Endpoint, N> from;
+            std::vector<RawPathView> paths(N);
+            std::array<DeferredChecksum, N> checksums;
+            std::size_t batchScmp = 0, singleScmp = 0;
+            auto scmpHandler = [] (std::size_t& count) {
+                return [&count] (const Address<IPAddress>&, const RawPathView&,
+                    const hdr::ScmpMessage&, std::span<const std::byte>) {
+                    ++count;
+                };
+            };
+
+            auto valid = batch.unpackBatch<hdr::UDP>(bufs, ulSources, dests,
+                {.payloads = payloads, .errors = errors, .from = from, .paths = paths,
+                 .checksums = checksums}, scmpHandler(batchScmp));
+            ASSERT_FALSE(isError(valid)) << getError(valid);
+
+            std::size_t expValid = 0;
+            for (std::size_t i = 0; i < N; ++i) {
+                ScionPackager::Endpoint expFrom;
+                RawPathView expPath;
+                auto exp = single.unpack<hdr::UDP>(bufs[i], ulSources[i],
+                    wildcard ? &ulDests[i] : nullptr, ext::NoExtensions, ext::NoExtensions,
+                    &expFrom, expPath, scmpHandler(singleScmp));
+                if (isError(exp)) {
+                    EXPECT_EQ(errors[i], getError(exp)) << i;
+                    EXPECT_TRUE(payloads[i].empty()) << i;
+                } else {
+                    ++expValid;
+                    EXPECT_EQ(errors[i], ErrorCode::Ok) << i;
+                    EXPECT_EQ(payloads[i].data(), get(exp).data()) << i;
+                    EXPECT_EQ(payloads[i].size(), get(exp).size()) << i;
+                    EXPECT_EQ(from[i], expFrom) << i;
+                    EXPECT_EQ(paths[i], expPath) << i;
+                    auto expChecksum = single.getDeferredChecksum();
+                    EXPECT_EQ(checksums[i].isPending(), expChecksum.isPending()) << i;
+                    EXPECT_EQ(checksums[i].verify(payloads[i]), expChecksum.verify(get(exp))) << i;
+                }
+            }
+            EXPECT_GT(expValid, 0);
+            EXPECT_LT(expValid, N);
+            EXPECT_EQ(get(valid), expValid);
+            EXPECT_GT(singleScmp, 0);
+            EXPECT_EQ(batchScmp, singleScmp);
+        }
+    }
+}
+
 TEST_F(PacketSocketFixture, ReceiveSCMP)
 {
     using namespace scion;
@@ -27,6 +27,7 @@
 #include "gtest/gtest.h"
 #include "utilities.hpp"
 
+#include <random>
 #include <ranges>
 
 
@@ -171,3 +172,88 @@ TEST_F(ParsedPacketFixture, ParseIdInt)
     // Payload
     EXPECT_TRUE(std::ranges::equal(pkt.payload, payload)) << printBufferDiff(pkt.payload, payload);
 }
+
+TEST_F(ParsedPacketFixture, ParseSpan)
+{
+    using namespace scion;
+    using namespace scion::hdr;
+
+    for (std::size_t i = 0; i < packets.size(); ++i) {
+        ParsedPacket<UDP> expected, pkt;
+        ReadStream rs(packets[i]);
+        StreamError err;
+        ASSERT_TRUE(expected.parse(rs, err)) << err;
+        ASSERT_TRUE(pkt.parse(std::span<const std::byte>(packets[i]), err)) << err;
+        EXPECT_EQ(pkt.sci, expected.sci);
+        EXPECT_EQ(pkt.l4.index(), expected.l4.index());
+        EXPECT_EQ(pkt.path.data(), expected.path.data());
+        EXPECT_EQ(pkt.payload.data(), expected.payload.data());
+        EXPECT_EQ(pkt.payload.size(), expected.payload.size());
+        EXPECT_EQ(pkt.checksum(), expected.checksum());
+    }
+}
+
+// Compare the fixed-offset UDP parser against the general stream parser on
+// mutated and randomly generated packets.
+TEST_F(ParsedPacketFixture, ParseSpanEquivalence)
+{
+    using namespace scion;
+    using namespace scion::hdr;
+
+    auto sameSpan = [](std::span<const std::byte> a, std::span<const std::byte> b) {
+        return a.data() == b.data() && a.size() == b.size();
+    };
+    auto check = [&](std::span<const std::byte> buf) {
+        ParsedPacket<UDP> expected, pkt;
+        ReadStream rs(buf);
+        StreamError err1, err2;
+        bool res = expected.parse(rs, err1);
+        ASSERT_EQ(pkt.parse(buf, err2), res);
+        if (!res) return;
+        EXPECT_EQ(pkt.sci, expected.sci);
+        EXPECT_TRUE(sameSpan(pkt.path, expected.path));
+        EXPECT_TRUE(sameSpan(pkt.hbhOpts, expected.hbhOpts));
+        EXPECT_TRUE(sameSpan(pkt.e2eOpts, expected.e2eOpts));
+        EXPECT_TRUE(sameSpan(pkt.payload, expected.payload));
+        ASSERT_EQ(pkt.l4.index(), expected.l4.index());
+        if (auto udp = std::get_if<UDP>(&pkt.l4)) {
+            auto& exp = std::get<UDP>(expected.l4);
+            EXPECT_EQ(udp->sport, exp.sport);
+            EXPECT_EQ(udp->dport, exp.dport);
+            EXPECT_EQ(udp->len, exp.len);
+            EXPECT_EQ(udp->chksum, exp.chksum);
+        }
+    };
+
+    std::mt19937 rng(0);
+    auto randByte = [&] { return std::byte(rng() & 0xff); };
+
+    // Random bit flips and truncations of valid packets
+    for (int i = 0; i < 2000; ++i) {
+        auto buf = packets.at(rng() % packets.size());
+        auto flips = rng() % 4;
+        for (unsigned j = 0; j < flips; ++j) {
+            // bias mutations towards the common header and address header
+            auto pos = rng() % std::min<std::size_t>(buf.size(), (j & 1) ? buf.size() : 64);
+            buf[pos] ^= std::byte(1u << (rng() % 8));
+        }
+        if (rng() % 4 == 0) buf.resize(rng() % (buf.size() + 1));
+        check(buf);
+        if (HasFatalFailure()) return;
+    }
+
+    // Randomly generated headers with valid and invalid field combinations
+    constexpr std::uint8_t addrTypes[] = {0x00, 0x03, 0x30, 0x33, 0x01, 0x10};
+    for (int i = 0; i < 2000; ++i) {
+        std::vector<std::byte> buf(rng() % 160);
+        std::ranges::generate(buf, randByte);
+        if (buf.size() >= 10) {
+            if (rng() % 8) buf[0] &= 0x0f_b;
+            if (rng() % 8) buf[4] = std::byte(rng() % 4 ? 17 : 202);
+            buf[5] = std::byte(rng() % 8 ? 9 + rng() % 24 : rng() % 10);
+            buf[9] = std::byte(addrTypes[rng() % std::size(addrTypes)]);
+        }
+        check(buf);
+        if (HasFatalFailure()) return;
+    }
+}
@@ -0,0 +1,202 @@
+// Copyright (c) 2024-2025 Lars-Christian Schulz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "scion/hdr/udp.hpp"
+#include "scion/path/raw.hpp"
+#include "scion/socket/packager.hpp"
+#include "scion/socket/session_table.hpp"
+
+#include "gtest/gtest.h"
+#include "utilities.hpp"
+
+#include <array>
+#include <chrono>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+
+class SessionTableFixture : public testing::Test
+{
+protected:
+    using Endpoint = scion::Endpoint<scion::generic::IPEndpoint>;
+    using Table = scion::SessionTable<>;
+
+    static void SetUpTestSuite()
+    {
+        using namespace scion;
+        local = unwrap(Endpoint::Parse("[1-ff00:0:1,10.0.0.1]:3000"));
+        pathBytes = loadPackets("socket/data/raw_path.bin").at(0);
+        remoteIA = unwrap(IsdAsn::Parse("2-ff00:0:2"));
+        nextHop = unwrap(generic::IPEndpoint::Parse("10.0.0.2:30041"));
+        for (auto host : {"fd00::1", "fd00::2", "fd00::3"}) {
+            remotes.push_back(Endpoint(remoteIA, unwrap(generic::IPAddress::Parse(host)), 8000));
+        }
+    };
+
+    void SetUp() override
+    {
+        ASSERT_FALSE(packager.setLocalEp(local));
+    }
+
+    // Request path as received from the remote clients.
+    scion::RawPathView requestPath() const
+    {
+        return scion::RawPathView(remoteIA, local.getIsdAsn(), scion::hdr::PathType::SCION, pathBytes);
+    }
+
+    void reply(Table& table, std::size_t remote, Table::Clock::time_point t)
+    {
+        using namespace scion;
+        auto headers = table.packReply(
+            packager, remotes.at(remote), requestPath(), nextHop, hdr::UDP{}, payload, t);
+        ASSERT_FALSE(isError(headers)) << getError(headers);
+    }
+
+    inline static Endpoint local;
+    inline static std::vector<std::byte> pathBytes;
+    inline static scion::IsdAsn remoteIA;
+    inline static scion::generic::IPEndpoint nextHop;
+    inline static std::vector<Endpoint> remotes;
+
+    scion::ScionPackager packager;
+    std::array<std::byte, 8> payload = {};
+    Table::Clock::time_point t0 = {};
+};
+
+// Replies are sent on the reversed request path to the latest next hop.
+TEST_F(SessionTableFixture, Reverse)
+{
+    using namespace scion;
+
+    Table table(1 << 20, 10s);
+    reply(table, 0, t0);
+    auto nextHop2 = unwrap(generic::IPEndpoint::Parse("10.0.0.3:30041"));
+    auto headers = table.packReply(
+        packager, remotes[0], requestPath(), nextHop2, hdr::UDP{}, payload, t0 + 1s);
+    ASSERT_FALSE(isError(headers)) << getError(headers);
+    EXPECT_EQ(table.getStats().hits, 1);
+
+    auto session = table.find(remotes[0], requestPath());
+    ASSERT_NE(session, nullptr);
+    RawPath reversed = requestPath();
+    ASSERT_FALSE(reversed.reverseInPlace());
+    EXPECT_EQ(session->path(), reversed);
+    EXPECT_EQ(session->nextHop(), nextHop2);
+    EXPECT_EQ(session->lastActive(), t0 + 1s);
+}
+
+TEST_F(SessionTableFixture, IdleExpiry)
+{
+    using namespace scion;
+
+    Table table(1 << 20, 10s);
+    reply(table, 0, t0);
+    reply(table, 1, t0 + 5s);
+    // Refreshes the idle time of the first session
+    reply(table, 0, t0 + 9s);
+    table.expire(t0 + 14s);
+    EXPECT_EQ(table.size(), 2);
+    table.expire(t0 + 15s);
+    EXPECT_EQ(table.size(), 1);
+    EXPECT_EQ(table.getStats().expired, 1);
+    EXPECT_EQ(table.find(remotes[1], requestPath()), nullptr);
+
+    // Requests expire idle sessions before they are handled
+    auto usage = table.memoryUsage();
+    reply(table, 2, t0 + 20s);
+    EXPECT_EQ(table.size(), 1);
+    EXPECT_EQ(table.getStats().expired, 2);
+    EXPECT_EQ(table.find(remotes[0], requestPath()), nullptr);
+    EXPECT_EQ(table.memoryUsage(), usage);
+
+    table.resetStats();
+    EXPECT_EQ(table.getStats().expired, 0);
+}
+
+TEST_F(SessionTableFixture, MemoryLimit)
+{
+    using namespace scion;
+
+    // At least one session is always kept
+    Table small(1, 10s);
+    reply(small, 0, t0);
+    reply(small, 1, t0);
+    EXPECT_EQ(small.size(), 1);
+    EXPECT_EQ(small.getStats().evictions, 1);
+    auto sessionSize = small.memoryUsage();
+    EXPECT_GT(sessionSize, 0);
+
+    Table table(2 * sessionSize, 10s);
+    reply(table, 0, t0);
+    reply(table, 1, t0);
+    EXPECT_EQ(table.size(), 2);
+    EXPECT_EQ(table.memoryUsage(), 2 * sessionSize);
+    reply(table, 0, t0);
+    reply(table, 2, t0);
+    EXPECT_EQ(table.size(), 2);
+    EXPECT_EQ(table.memoryUsage(), 2 * sessionSize);
+    EXPECT_EQ(table.getStats().evictions, 1);
+    EXPECT_NE(table.find(remotes[0], requestPath()), nullptr);
+    EXPECT_EQ(table.find(remotes[1], requestPath()), nullptr);
+    EXPECT_NE(table.find(remotes[2], requestPath()), nullptr);
+
+    table.erase(remotes[0], requestPath());
+    EXPECT_EQ(table.memoryUsage(), sessionSize);
+    table.clear();
+    EXPECT_EQ(table.memoryUsage(), 0);
+
+    // Failed replies do not leave sessions behind
+    ScionPackager unbound;
+    auto headers = table.packReply(
+        unbound, remotes[0], requestPath(), nextHop, hdr::UDP{}, payload, t0);
+    ASSERT_TRUE(isError(headers));
+    EXPECT_EQ(getError(headers), ErrorCode::NoLocalHostAddr);
+    EXPECT_EQ(table.size(), 0);
+    EXPECT_EQ(table.memoryUsage(), 0);
+}
+
+// A request path with refreshed hop fields replaces the session's reply path.
+TEST_F(SessionTableFixture, PathRefresh)
+{
+    using namespace scion;
+
+    auto updatedBytes = pathBytes;
+    updatedBytes.back() ^= 0xff_b;
+    RawPathView updated(remoteIA, local.getIsdAsn(), hdr::PathType::SCION, updatedBytes);
+    ASSERT_EQ(updated.digest(), requestPath().digest());
+
+    Table table(1 << 20, 10s);
+    reply(table, 0, t0);
+    auto usage = table.memoryUsage();
+    auto headers = table.packReply(
+        packager, remotes[0], updated, nextHop, hdr::UDP{}, payload, t0);
+    ASSERT_FALSE(isError(headers)) << getError(headers);
+    EXPECT_EQ(table.getStats().hits, 0);
+    EXPECT_EQ(table.getStats().misses, 2);
+    EXPECT_EQ(table.size(), 1);
+    EXPECT_EQ(table.memoryUsage(), usage);
+
+    auto session = table.find(remotes[0], updated);
+    ASSERT_NE(session, nullptr);
+    RawPath reversed = updated;
+    ASSERT_FALSE(reversed.reverseInPlace());
+    EXPECT_EQ(session->path(), reversed);
+}
@@ -374,6 +374,76 @@ TYPED_TEST(TypedStreamTest, SerializeUint32Overflow)
     ASSERT_FALSE(err.ok());
 }
 
+TEST(Stream, SerializeUint64)
+{
+    using namespace scion;
+    const std::uint64_t pattern = 0x0123'4567'89ab'cdef;
+
+    std::array<std::byte, 10> data;
+    std::fill(data.begin(), data.end(), 0xff_b);
+
+    StreamError err;
+    for (size_t offset = 0; offset < 8; ++offset) {
+        WriteStream write(data);
+        ASSERT_TRUE(write.advanceBits(offset, err));
+        ASSERT_TRUE(write.serializeUint64(pattern, err))
+            << "offset = " << offset << '\n'
+            << "Error: " << err;
+        ASSERT_TRUE(err.ok());
+        ASSERT_EQ(write.getPos(), std::make_pair((size_t)8, offset));
+        EXPECT_EQ(data.back(), 0xff_b);
+
+        ReadStream read(data);
+        std::uint64_t value = 0;
+        ASSERT_TRUE(read.seek(0, offset));
+        ASSERT_TRUE(read.serializeUint64(value, err))
+            << "offset = " << offset << '\n'
+            << "Error: " << err;
+        ASSERT_TRUE(err.ok());
+        ASSERT_EQ(value, pattern)
+            << "offset = " << offset << '\n';
+        ASSERT_EQ(read.getPos(), std::make_pair((size_t)8, offset));
+    }
+
+    // error: out of data
+    WriteStream write(data);
+    ASSERT_TRUE(write.seek(2, 1));
+    EXPECT_FALSE(write.serializeUint64(pattern, err));
+    EXPECT_EQ(write.getPos(), std::make_pair((size_t)2, (size_t)1));
+}
+
+TEST(Stream, UnalignedByteOrder)
+{
+    using namespace scion;
+
+    // Fields at bit offsets are stored in network byte order like aligned
+    // fields and do not touch the bytes following them.
+    std::array<std::byte, 12> data;
+    std::fill(data.begin(), data.end(), 0xff_b);
+    WriteStream write(data);
+    ASSERT_TRUE(write.serializeBits(0u, 4, NullStreamError));
+    ASSERT_TRUE(write.serializeUint16(0xabcd, NullStreamError));
+    ASSERT_TRUE(write.serializeUint32(0x1234'5678, NullStreamError));
+    EXPECT_THAT(data, testing::ElementsAre(
+        0x0a_b, 0xbc_b, 0xd1_b, 0x23_b, 0x45_b, 0x67_b, 0x80_b,
+        0xff_b, 0xff_b, 0xff_b, 0xff_b, 0xff_b));
+
+    ReadStream read(data);
+    std::uint16_t value16 = 0;
+    std::uint32_t value32 = 0;
+    ASSERT_TRUE(read.advanceBits(4, NullStreamError));
+    ASSERT_TRUE(read.serializeUint16(value16, NullStreamError));
+    ASSERT_TRUE(read.serializeUint32(value32, NullStreamError));
+    EXPECT_EQ(value16, 0xabcd);
+    EXPECT_EQ(value32, 0x1234'5678);
+
+    // Aligned read into a wider type
+    ASSERT_TRUE(read.seek(1, 0));
+    std::uint32_t wide = 0;
+    ASSERT_TRUE(read.serializeUint16(wide, NullStreamError));
+    EXPECT_EQ(wide, 0xbcd1);
+}
+
 TEST(Stream, ReadBytes)
 {
     using namespace scion;